@@ -0,0 +1,505 @@
+#include "scene.hxx"
+#include "phusis/internal/drawsort.hxx"
+#include "phusis/internal/lodselect.hxx"
+#include "phusis/internal/meshletcull.hxx"
+#include "phusis/internal/constantblock.hxx"
+#include "phusis/internal/vkuploadring.hxx"
+#include "phusis/scenechannel.hxx"
+#include "phusis/transformhierarchy.hxx"
+#include "phusis/entitystore.hxx"
+#include "phusis/metrics.hxx"
+#include "pre/batch.hxx"
+#include "pre/pack.hxx"
+#include "sys/logger.hxx"
+#include "sys/spinlock.hxx"
+#include "sys/allocation.hxx"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using Phusis::Bench::PlaceholderMeshes;
+using Phusis::Bench::SyntheticScene;
+
+/// @brief Sort keys and radix sort for every object, as in VkStateMachine::PrepareDraws; args: objects, meshes
+static void BM_SortDraws(benchmark::State& state)
+{
+	uint32_t objects = state.range(0);
+	SyntheticScene scene({ objects, static_cast<uint32_t>(state.range(1)), 0.f }, PlaceholderMeshes(state.range(1)));
+
+	std::vector<Phusis::Internal::VkDrawItem> items(objects), scratch;
+	sys::arena arena;
+	VkPipeline pipeline = nullptr;
+
+	for (auto _: state)
+	{
+		for (uint32_t i = 0; i < objects; ++i)
+		{
+			const auto& object = scene.Objects[i];
+			glm::vec4 position = scene.View * scene.Transforms[i].Rotation[3];
+			items[i] = { Phusis::Internal::MakeSortKey(pipeline, object.Material, object.Mesh, -position.z), i, 0 };
+		}
+
+		Phusis::Internal::SortDraws(items, scratch, std::thread::hardware_concurrency(), arena);
+		arena.reset();
+		benchmark::DoNotOptimize(items.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * objects);
+}
+
+BENCHMARK(BM_SortDraws)->ArgNames({ "objects", "meshes" })->ArgsProduct({ { 1000, 10000, 100000 }, { 16, 1024 } });
+
+/// @brief Dynamic-fraction animation of the synthetic scene; args: objects, dynamic percent
+static void BM_SceneAnimate(benchmark::State& state)
+{
+	uint32_t objects = state.range(0);
+	SyntheticScene scene({ objects, 16, state.range(1) / 100.f }, PlaceholderMeshes(16));
+
+	float t = 0;
+	for (auto _: state)
+	{
+		scene.Animate(t += 1.f / 60.f);
+		benchmark::DoNotOptimize(scene.Transforms.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * scene.Dynamic.size());
+}
+
+BENCHMARK(BM_SceneAnimate)->ArgNames({ "objects", "dynamic" })->ArgsProduct({ { 100000 }, { 10, 100 } });
+
+/// @brief World matrices of the synthetic scene arranged as a forest of 8-way trees, after the dynamic
+/// fraction changed, as in VkStateMachine::Update; args: objects, dynamic percent
+static void BM_TransformHierarchy(benchmark::State& state)
+{
+	uint32_t objects = state.range(0);
+	SyntheticScene scene({ objects, 16, state.range(1) / 100.f }, PlaceholderMeshes(16));
+
+	sys::workers workers(std::thread::hardware_concurrency());
+	Phusis::TransformHierarchy hierarchy;
+	hierarchy.Resize(objects);
+	for (uint32_t i = 64; i < objects; ++i)
+		hierarchy.SetParent(i, i / 8);
+	hierarchy.Update(scene.Transforms, workers);
+
+	uint64_t updated = 0;
+	float t = 0;
+	for (auto _: state)
+	{
+		state.PauseTiming();
+		scene.Animate(t += 1.f / 60.f);
+		for (uint32_t i: scene.Dynamic)
+			hierarchy.Invalidate(i);
+		state.ResumeTiming();
+
+		hierarchy.Update(scene.Transforms, workers);
+		updated += hierarchy.Updated();
+		benchmark::DoNotOptimize(hierarchy.Worlds());
+	}
+
+	state.counters["updated"] = static_cast<double>(updated) / state.iterations();
+	state.SetItemsProcessed(state.iterations() * objects);
+}
+
+BENCHMARK(BM_TransformHierarchy)->ArgNames({ "objects", "dynamic" })->ArgsProduct({ { 100000 }, { 0, 1, 10, 100 } })->UseRealTime();
+
+/// @brief Projected scale and level selection for every object, as in VkStateMachine::PrepareDraws; args: objects
+static void BM_SelectLod(benchmark::State& state)
+{
+	uint32_t objects = state.range(0);
+	SyntheticScene scene({ objects, 16, 0.f }, PlaceholderMeshes(16));
+
+	std::vector<float> scales(objects);
+	std::vector<uint8_t> lods(objects, 0);
+	float focal = std::abs(scene.Projection[1][1]) * 1080 * .5f;
+
+	uint64_t triangles = 0;
+	for (auto _: state)
+	{
+		Phusis::Internal::LodScales(&scene.Transforms[0].Rotation, sizeof(Phusis::EngineObjectTransform), objects, scene.View, focal, scales.data());
+		for (uint32_t i = 0; i < objects; ++i)
+		{
+			const auto& mesh = scene.Objects[i].Mesh;
+			lods[i] = Phusis::Internal::SelectLod(mesh, scales[i], lods[i], {});
+			triangles += mesh.Indices[lods[i]].Count / 3;
+		}
+		benchmark::DoNotOptimize(lods.data());
+	}
+
+	state.counters["triangles"] = static_cast<double>(triangles) / state.iterations();
+	state.SetItemsProcessed(state.iterations() * objects);
+}
+
+BENCHMARK(BM_SelectLod)->Arg(10000)->Arg(100000);
+
+/// @brief Frustum and cone tests over a sphere of meshlets half outside the view, as one worker does
+/// per object in VkStateMachine::RecordObject; args: meshlets
+static void BM_CullMeshlets(benchmark::State& state)
+{
+	uint32_t n = state.range(0);
+	SyntheticScene scene({ 1, 1, 0.f }, PlaceholderMeshes(1));
+
+	// outward-facing patches of a unit sphere, each cone a little wider than the patch
+	std::mt19937 rng(1);
+	std::normal_distribution<float> normal;
+	std::vector<Phusis::Meshlet> meshlets(n);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		glm::vec3 p = glm::normalize(glm::vec3(normal(rng), normal(rng), normal(rng)));
+		meshlets[i] = { i * 372, 372, { p.x, p.y, p.z }, 2.f / std::sqrt(static_cast<float>(n)), { p.x, p.y, p.z }, .5f };
+	}
+
+	glm::mat4 model(40.f);
+	model[3] = glm::vec4(60.f, 0.f, 0.f, 1.f);
+
+	std::vector<Phusis::Internal::MeshletRun> runs(n);
+	uint32_t survived = 0;
+	for (auto _: state)
+	{
+		auto frustum = Phusis::Internal::MakeMeshletFrustum(scene.Projection, scene.View * model);
+		uint32_t count = Phusis::Internal::CullMeshlets(meshlets.data(), n, frustum, runs.data());
+
+		survived = 0;
+		for (uint32_t i = 0; i < count; ++i)
+			survived += runs[i].Count;
+		benchmark::DoNotOptimize(runs.data());
+	}
+
+	state.counters["culled"] = 1. - static_cast<double>(survived) / n;
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_CullMeshlets)->Arg(256)->Arg(4096);
+
+template<typename M>
+static std::vector<M> Matrices(size_t n)
+{
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+	std::vector<M> result(n);
+	for (auto& m: result)
+		for (uint32_t c = 0; c < 4; ++c)
+			for (uint32_t r = 0; r < 4; ++r)
+				m[c][r] = unit(rng);
+	return result;
+}
+
+/// @brief view-projection * model for n objects with glm
+static void BM_TransformGlm(benchmark::State& state)
+{
+	auto src = Matrices<glm::mat4>(state.range(0));
+	std::vector<glm::mat4> dst(src.size());
+	glm::mat4 lhs = src[0];
+
+	for (auto _: state)
+	{
+		for (size_t i = 0; i < src.size(); ++i)
+			dst[i] = lhs * src[i];
+		benchmark::DoNotOptimize(dst.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+/// @brief view-projection * model for n objects with pre::transform
+static void BM_TransformPre(benchmark::State& state)
+{
+	auto src = Matrices<pre::mat4f>(state.range(0));
+	std::vector<pre::mat4f> dst(src.size());
+	pre::mat4f lhs = src[0];
+
+	for (auto _: state)
+	{
+		pre::transform(lhs, pre::span<const pre::mat4f>(src), pre::span<pre::mat4f>(dst));
+		benchmark::DoNotOptimize(dst.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+BENCHMARK(BM_TransformGlm)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_TransformPre)->Arg(1 << 10)->Arg(1 << 16);
+
+/// @brief Compressed vertex streams: unorm16 positions, octahedral normals, half uvs
+static void BM_PackVertices(benchmark::State& state)
+{
+	size_t n = state.range(0);
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+	std::vector<pre::vec3f> positions(n), normals(n);
+	std::vector<pre::vec2f> uvs(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		positions[i] = pre::vec3f(unit(rng), unit(rng), unit(rng)) * 10.f;
+		normals[i] = pre::normalize(pre::vec3f(unit(rng), unit(rng), unit(rng)));
+		uvs[i] = pre::vec2f(unit(rng), unit(rng));
+	}
+
+	std::vector<uint16_t> packedPositions(4 * n), packedUvs(2 * n);
+	std::vector<int16_t> packedNormals(2 * n);
+
+	for (auto _: state)
+	{
+		pre::vec3f min, max;
+		pre::bounds(pre::span<const pre::vec3f>(positions), min, max);
+		pre::pack_unorm16(pre::span<const pre::vec3f>(positions), min, max, pre::span<uint16_t>(packedPositions));
+		pre::pack_octahedral(pre::span<const pre::vec3f>(normals), pre::span<int16_t>(packedNormals));
+		pre::pack_half(pre::span<const pre::vec2f>(uvs), pre::span<uint16_t>(packedUvs));
+		benchmark::DoNotOptimize(packedPositions.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_PackVertices)->Arg(1 << 16);
+
+/// @brief Write one frame of bindless records into a 64-byte aligned host buffer the size of an upload ring
+/// region; args: objects, non-temporal stores. On write-combined device memory the gap is larger.
+static void BM_UploadRecords(benchmark::State& state)
+{
+	using Phusis::Internal::BindlessObject;
+
+	uint32_t n = state.range(0);
+	bool stream = state.range(1);
+	std::unique_ptr<BindlessObject[], decltype(&std::free)> region(
+			static_cast<BindlessObject*>(std::aligned_alloc(64, (n * sizeof(BindlessObject) + 63) / 64 * 64)), &std::free);
+	glm::mat4 model(1.f);
+	glm::vec4 color(1.f);
+
+	for (auto _: state)
+	{
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			BindlessObject record{ model, color, i, {} };
+			if (stream)
+				Phusis::Internal::VkUploadRing::Stream(&region[i], &record, sizeof(BindlessObject));
+			else
+				region[i] = record;
+		}
+		Phusis::Internal::VkUploadRing::StreamFence();
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * n * sizeof(BindlessObject));
+}
+
+BENCHMARK(BM_UploadRecords)->ArgNames({ "objects", "stream" })->ArgsProduct({ { 100000 }, { 0, 1 } });
+
+struct Velocity
+{
+	static constexpr uint32_t Id = Phusis::EngineComponentIds;
+	glm::vec3 Linear;
+};
+
+/// @brief A system integrating velocity into every enabled transform, chunks split over the workers;
+/// args: entities, enabled percent
+static void BM_EntityEach(benchmark::State& state)
+{
+	uint32_t n = state.range(0);
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	std::uniform_int_distribution<uint32_t> percent(0, 99);
+
+	Phusis::EntityStore store;
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		Phusis::Entity entity = store.Create(Phusis::ObjectTransform{ glm::mat4(1.f) }, Velocity{ { unit(rng), unit(rng), unit(rng) } });
+		store.SetEnabled(entity, percent(rng) < state.range(1));
+	}
+
+	sys::workers workers(std::thread::hardware_concurrency());
+	for (auto _: state)
+	{
+		store.Each<Phusis::ObjectTransform, Velocity>(workers, [](Phusis::EntityChunk& chunk, Phusis::ObjectTransform* transforms, Velocity* velocities)
+		{
+			chunk.EachEnabled([transforms, velocities](uint32_t row)
+			{
+				transforms[row].World[3] += glm::vec4(velocities[row].Linear * (1.f / 60.f), 0.f);
+			});
+		});
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_EntityEach)->ArgNames({ "entities", "enabled" })->ArgsProduct({ { 100000 }, { 10, 100 } })->UseRealTime();
+
+/// @brief Publish and drain one frame of scene deltas; args: updates per frame
+static void BM_SceneChannel(benchmark::State& state)
+{
+	uint32_t n = state.range(0);
+	Phusis::SceneChannel channel;
+	std::vector<Phusis::EngineObjectTransform> transforms(n);
+
+	for (auto _: state)
+	{
+		uint32_t sent = 0;
+		while (sent < n)
+		{
+			uint32_t granted;
+			Phusis::SceneUpdate* slots = channel.Acquire(n - sent, granted);
+			for (uint32_t i = 0; i < granted; ++i)
+			{
+				slots[i].Index = sent + i;
+				slots[i].Fields = Phusis::SceneUpdateRotation;
+				slots[i].Rotation = glm::mat4(1.f);
+			}
+			channel.Publish(granted);
+			sent += granted;
+		}
+		channel.Consume(transforms);
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_SceneChannel)->Arg(100000);
+
+/// @brief The CPU half of a frame without a device: deltas through the scene channel, hierarchy update, sort
+/// keys and radix sort on fixed thread counts. Built with PHUSIS_COUNT_ALLOCATIONS it fails when a measured
+/// frame touches the heap, so the zero-allocation check runs anywhere; args: objects, dynamic percent
+static void BM_SteadyStateAllocations(benchmark::State& state)
+{
+	uint32_t objects = state.range(0);
+	SyntheticScene scene({ objects, 256, state.range(1) / 100.f }, PlaceholderMeshes(256));
+
+	constexpr uint32_t threads = 4;
+	sys::workers workers(threads);
+	sys::arena arena;
+	Phusis::SceneChannel channel;
+	Phusis::TransformHierarchy hierarchy;
+	hierarchy.Resize(objects);
+	for (uint32_t i = 64; i < objects; ++i)
+		hierarchy.SetParent(i, i / 8);
+
+	std::vector<Phusis::EngineObjectTransform> transforms = scene.Transforms;
+	std::vector<Phusis::Internal::VkDrawItem> items(objects), scratch;
+	VkPipeline pipeline = nullptr;
+	float t = 0;
+
+	auto frame = [&]()
+	{
+		scene.Animate(t += 1.f / 60.f);
+		for (uint32_t sent = 0; sent < scene.Dynamic.size();)
+		{
+			uint32_t granted;
+			Phusis::SceneUpdate* slots = channel.Acquire(scene.Dynamic.size() - sent, granted);
+			for (uint32_t i = 0; i < granted; ++i)
+			{
+				uint32_t index = scene.Dynamic[sent + i];
+				slots[i].Index = index;
+				slots[i].Fields = Phusis::SceneUpdateRotation;
+				slots[i].Rotation = scene.Transforms[index].Rotation;
+			}
+			channel.Publish(granted);
+			sent += granted;
+			channel.Consume(transforms, &hierarchy);
+		}
+		hierarchy.Update(transforms, workers);
+
+		const glm::mat4* worlds = hierarchy.Worlds();
+		for (uint32_t i = 0; i < objects; ++i)
+		{
+			const auto& object = scene.Objects[i];
+			glm::vec4 position = scene.View * worlds[i][3];
+			items[i] = { Phusis::Internal::MakeSortKey(pipeline, object.Material, object.Mesh, -position.z), i, 0 };
+		}
+		Phusis::Internal::SortDraws(items, scratch, threads, arena);
+		arena.reset();
+	};
+
+	// settle scratch, arena blocks and hierarchy storage before measuring
+	for (uint32_t i = 0; i < 4; ++i)
+		frame();
+
+	uint64_t allocations = sys::allocations();
+	for (auto _: state)
+	{
+		frame();
+		benchmark::DoNotOptimize(items.data());
+	}
+	allocations = sys::allocations() - allocations;
+
+	state.counters["allocations"] = static_cast<double>(allocations);
+#ifdef PHUSIS_COUNT_ALLOCATIONS
+	if (allocations)
+	{
+		std::string error = std::to_string(allocations) + " heap allocations in steady-state frames";
+		state.SkipWithError(error.c_str());
+	}
+#endif
+	state.SetItemsProcessed(state.iterations() * objects);
+}
+
+BENCHMARK(BM_SteadyStateAllocations)->ArgNames({ "objects", "dynamic" })->ArgsProduct({ { 10000 }, { 10 } })->UseRealTime();
+
+// swallows everything the logger flushes to std::cout
+class NullBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override
+	{
+		return c;
+	}
+
+	std::streamsize xsputn(const char*, std::streamsize n) override
+	{
+		return n;
+	}
+};
+
+/// @brief Formatted log lines per second; output is discarded
+static void BM_Logger(benchmark::State& state)
+{
+	static NullBuffer sink;
+	static std::streambuf* previous = nullptr;
+
+	// the loop start and end are barriers across threads, so only thread 0 swaps the buffer
+	if (state.thread_index() == 0)
+		previous = std::cout.rdbuf(&sink);
+
+	uint32_t i = 0;
+	for (auto _: state)
+		sys::log.head(sys::INFO) << "frame " << i++ << " took " << 16.6f << "ms" << sys::EOM;
+
+	if (state.thread_index() == 0)
+		std::cout.rdbuf(previous);
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Logger)->Threads(1)->Threads(4)->UseRealTime();
+
+/// @brief Short critical sections under contention
+static void BM_Spinlock(benchmark::State& state)
+{
+	static sys::spinlock lock;
+	static uint64_t shared = 0;
+
+	for (auto _: state)
+	{
+		lock.lock();
+		benchmark::DoNotOptimize(++shared);
+		lock.unlock();
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Spinlock)->ThreadRange(1, 16)->UseRealTime();
+
+/// @brief One frame-time sample per iteration, as the render thread records every frame, while
+/// other threads record into the same metric
+static void BM_MetricRecord(benchmark::State& state)
+{
+	static Phusis::MetricsRegistry registry;
+	static Phusis::Metric& metric = registry.Register("bench_frame_seconds", "Benchmark frame time", 1e-9);
+	uint64_t value = 16000000 + state.thread_index() * 1000;
+
+	for (auto _: state)
+		metric.Record(value++);
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MetricRecord)->Threads(1)->Threads(4)->UseRealTime();
@@ -0,0 +1,325 @@
+#include "headless.hxx"
+#include "scene.hxx"
+#include <benchmark/benchmark.h>
+
+/*
+ * headless frame benchmarks; for regression tracking run
+ * phusis-bench --benchmark_filter=Frame --benchmark_out=frame.json --benchmark_out_format=json
+ * built with PHUSIS_COUNT_ALLOCATIONS, BM_Frame and BM_FrameEntities fail when a measured frame touches the heap;
+ * BM_SteadyStateAllocations in cpu.cxx checks the same without a device
+ */
+
+using Phusis::Bench::HeadlessDevice;
+using Phusis::Bench::SyntheticScene;
+using Phusis::Internal::RecordingMode;
+using Phusis::Internal::VkBoundData;
+using Phusis::Internal::VkFrameTimings;
+using Phusis::Internal::VkStateMachine;
+using Phusis::VertexEncoding;
+
+static void Report(benchmark::State& state, const VkFrameTimings& sum, const VkStateMachine& machine)
+{
+	double frames = static_cast<double>(state.iterations());
+	state.counters["wait_us"] = sum.Wait / frames;
+	state.counters["prepare_us"] = sum.Prepare / frames;
+	state.counters["record_us"] = sum.Record / frames;
+	state.counters["submit_us"] = sum.Submit / frames;
+	state.counters["gpu_us"] = sum.Gpu / frames;
+	state.counters["draws"] = machine.Statistics().Draws;
+	state.counters["triangles"] = machine.Statistics().Triangles;
+	state.counters["binds"] = machine.Statistics().PipelineBinds + machine.Statistics().VertexBinds + machine.Statistics().IndexBinds;
+}
+
+static void Accumulate(VkFrameTimings& sum, const VkFrameTimings& frame)
+{
+	sum.Wait += frame.Wait;
+	sum.Prepare += frame.Prepare;
+	sum.Record += frame.Record;
+	sum.Submit += frame.Submit;
+	sum.Gpu += frame.Gpu;
+}
+
+/// @brief Fail the run if the steady-state frames allocated; always passes unless allocations are counted
+static void CheckAllocations(benchmark::State& state, uint64_t allocations)
+{
+#ifdef PHUSIS_COUNT_ALLOCATIONS
+	if (allocations)
+	{
+		std::string error = std::to_string(allocations) + " heap allocations in steady-state frames";
+		state.SkipWithError(error.c_str());
+	}
+#else
+	(void) state;
+	(void) allocations;
+#endif
+}
+
+/// @brief args: objects, meshes, dynamic percent, recording mode, threads
+static void BM_Frame(benchmark::State& state)
+{
+	HeadlessDevice& device = HeadlessDevice::Shared();
+	if (!device.Valid())
+	{
+		state.SkipWithError("no vulkan device");
+		return;
+	}
+
+	uint32_t objects = state.range(0);
+	uint32_t meshes = state.range(1);
+	float dynamic = state.range(2) / 100.f;
+	auto mode = static_cast<RecordingMode>(state.range(3));
+	uint32_t threads = state.range(4) ? state.range(4) : std::thread::hardware_concurrency();
+
+	SyntheticScene scene({ objects, meshes, dynamic }, device.CreateMeshes(meshes));
+	VkBoundData bound{
+			HeadlessDevice::Width, HeadlessDevice::Height,
+			scene.View, scene.Projection,
+			scene.Objects, scene.Transforms, nullptr, nullptr, nullptr };
+	auto frame = device.Frame();
+
+	{
+		VkStateMachine machine(device.Inheritance(), threads, mode);
+		machine.Bind(&bound, &frame);
+		machine.Start();
+
+		// settle pools and arenas before measuring
+		for (uint32_t i = 0; i < 2 * Phusis::Internal::FramesInFlight; ++i)
+			machine.Update();
+
+		VkFrameTimings sum{};
+		uint64_t allocations = 0;
+		float t = 0;
+		for (auto _: state)
+		{
+			scene.Animate(t += 1.f / 60.f);
+			if (!machine.Update())
+			{
+				state.SkipWithError("frame update failed");
+				break;
+			}
+			Accumulate(sum, machine.Timings());
+			allocations += machine.Statistics().Allocations;
+		}
+
+		Report(state, sum, machine);
+		CheckAllocations(state, allocations);
+		state.SetItemsProcessed(state.iterations() * objects);
+		state.SetLabel(device.Name);
+	}
+
+	device.ReleaseMeshes();
+}
+
+BENCHMARK(BM_Frame)
+		->ArgNames({ "objects", "meshes", "dynamic", "mode", "threads" })
+		->ArgsProduct({ { 1000, 10000, 100000 }, { 16, 1024 }, { 10 }, { int(RecordingMode::Batched) }, { 0 } })
+		->ArgsProduct({ { 10000 }, { 256 }, { 0, 100 }, { int(RecordingMode::Batched) }, { 0 } })
+		->ArgsProduct({ { 10000 }, { 256 }, { 10 }, { int(RecordingMode::PerObject) }, { 0 } })
+		->ArgsProduct({ { 10000 }, { 256 }, { 10 }, { int(RecordingMode::Batched) }, { 1, 2, 4, 8 } })
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+
+/// @brief BM_Frame with the scene held as entities in an EntityStore instead of the object vectors;
+/// args: objects, meshes, dynamic percent
+static void BM_FrameEntities(benchmark::State& state)
+{
+	HeadlessDevice& device = HeadlessDevice::Shared();
+	if (!device.Valid())
+	{
+		state.SkipWithError("no vulkan device");
+		return;
+	}
+
+	uint32_t objects = state.range(0);
+	uint32_t meshes = state.range(1);
+	float dynamic = state.range(2) / 100.f;
+
+	SyntheticScene scene({ objects, meshes, dynamic }, device.CreateMeshes(meshes));
+
+	Phusis::EntityStore store;
+	std::vector<Phusis::Entity> entities(objects);
+	for (uint32_t i = 0; i < objects; ++i)
+	{
+		const auto& object = scene.Objects[i];
+		const auto& transform = scene.Transforms[i];
+		entities[i] = store.Create(
+				Phusis::ObjectTransform{ transform.Rotation },
+				Phusis::ObjectColor{ transform.Color },
+				Phusis::ObjectRenderable{ &object.Mesh, object.Pipeline, object.Material },
+				Phusis::ObjectLod{ 0 });
+	}
+
+	std::vector<Phusis::EngineObjectData> none;
+	std::vector<Phusis::EngineObjectTransform> noTransforms;
+	VkBoundData bound{
+			HeadlessDevice::Width, HeadlessDevice::Height,
+			scene.View, scene.Projection,
+			none, noTransforms, nullptr, nullptr, &store };
+	auto frame = device.Frame();
+
+	{
+		VkStateMachine machine(device.Inheritance());
+		machine.Bind(&bound, &frame);
+		machine.Start();
+
+		for (uint32_t i = 0; i < 2 * Phusis::Internal::FramesInFlight; ++i)
+			machine.Update();
+
+		VkFrameTimings sum{};
+		uint64_t allocations = 0;
+		float t = 0;
+		for (auto _: state)
+		{
+			scene.Animate(t += 1.f / 60.f);
+			for (uint32_t i: scene.Dynamic)
+				store.Get<Phusis::ObjectTransform>(entities[i])->World = scene.Transforms[i].Rotation;
+
+			if (!machine.Update())
+			{
+				state.SkipWithError("frame update failed");
+				break;
+			}
+			Accumulate(sum, machine.Timings());
+			allocations += machine.Statistics().Allocations;
+		}
+
+		Report(state, sum, machine);
+		CheckAllocations(state, allocations);
+		state.SetItemsProcessed(state.iterations() * objects);
+		state.SetLabel(device.Name);
+	}
+
+	device.ReleaseMeshes();
+}
+
+BENCHMARK(BM_FrameEntities)
+		->ArgNames({ "objects", "meshes", "dynamic" })
+		->ArgsProduct({ { 10000, 100000 }, { 256 }, { 10 } })
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+
+/// @brief Object count alternates every frame, so every worker's slice and pool reservation changes each
+/// update; args: objects
+static void BM_FrameResize(benchmark::State& state)
+{
+	HeadlessDevice& device = HeadlessDevice::Shared();
+	if (!device.Valid())
+	{
+		state.SkipWithError("no vulkan device");
+		return;
+	}
+
+	uint32_t objects = state.range(0);
+
+	auto meshes = device.CreateMeshes(64);
+	SyntheticScene small({ objects, 64, 0.f }, meshes);
+	SyntheticScene large({ objects + objects / 4, 64, 0.f }, meshes);
+
+	VkBoundData bounds[] = {
+			{ HeadlessDevice::Width, HeadlessDevice::Height, small.View, small.Projection, small.Objects, small.Transforms, nullptr, nullptr, nullptr },
+			{ HeadlessDevice::Width, HeadlessDevice::Height, large.View, large.Projection, large.Objects, large.Transforms, nullptr, nullptr, nullptr },
+	};
+	auto frame = device.Frame();
+
+	{
+		VkStateMachine machine(device.Inheritance(), std::thread::hardware_concurrency(), RecordingMode::PerObject);
+		machine.Bind(&bounds[0], &frame);
+		machine.Start();
+
+		VkFrameTimings sum{};
+		uint32_t flip = 0;
+		for (auto _: state)
+		{
+			machine.Bind(&bounds[++flip & 1], &frame);
+			if (!machine.Update())
+			{
+				state.SkipWithError("frame update failed");
+				break;
+			}
+			Accumulate(sum, machine.Timings());
+		}
+
+		Report(state, sum, machine);
+		state.SetLabel(device.Name);
+	}
+
+	device.ReleaseMeshes();
+}
+
+BENCHMARK(BM_FrameResize)
+		->ArgNames({ "objects" })
+		->Arg(1000)->Arg(10000)
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+
+/// @brief One static scene drawn from full-precision or from compressed vertex streams, every vertex of
+/// every object fetched; args: objects, vertices per mesh, encoding
+static void BM_FrameVertexStreams(benchmark::State& state)
+{
+	HeadlessDevice& device = HeadlessDevice::Shared();
+	if (!device.Valid())
+	{
+		state.SkipWithError("no vulkan device");
+		return;
+	}
+
+	constexpr uint32_t meshes = 16;
+	uint32_t objects = state.range(0);
+	uint32_t vertices = state.range(1);
+	auto encoding = static_cast<VertexEncoding>(state.range(2));
+
+	auto pool = device.CreateStreamMeshes(meshes, vertices, encoding);
+	VkPipeline pipeline = pool.empty() ? nullptr : device.CreateStreamPipeline(pool[0]);
+	if (!pipeline)
+	{
+		device.ReleaseMeshes();
+		state.SkipWithError("no vertex stream pipeline");
+		return;
+	}
+
+	// nothing animates, so the encodings differ in the fetch alone
+	SyntheticScene scene({ objects, meshes, 0.f, 1, pipeline }, pool);
+	VkBoundData bound{
+			HeadlessDevice::Width, HeadlessDevice::Height,
+			scene.View, scene.Projection,
+			scene.Objects, scene.Transforms, nullptr, nullptr, nullptr };
+	auto frame = device.Frame();
+
+	{
+		VkStateMachine machine(device.Inheritance());
+		machine.Bind(&bound, &frame);
+		machine.Start();
+
+		for (uint32_t i = 0; i < 2 * Phusis::Internal::FramesInFlight; ++i)
+			machine.Update();
+
+		VkFrameTimings sum{};
+		for (auto _: state)
+		{
+			if (!machine.Update())
+			{
+				state.SkipWithError("frame update failed");
+				break;
+			}
+			Accumulate(sum, machine.Timings());
+		}
+
+		uint32_t stride = 0;
+		for (const auto& stream: pool[0].Vertices)
+			stride += stream.Stride;
+
+		Report(state, sum, machine);
+		state.counters["vertex_bytes"] = double(meshes) * vertices * stride;
+		state.counters["fetched_bytes"] = double(objects) * vertices * stride;
+		state.SetItemsProcessed(state.iterations() * objects * vertices);
+		state.SetLabel(device.Name);
+	}
+
+	device.ReleaseMeshes();
+}
+
+BENCHMARK(BM_FrameVertexStreams)
+		->ArgNames({ "objects", "vertices", "encoding" })
+		->ArgsProduct({ { 1000 }, { 3072 }, { int(VertexEncoding::Full), int(VertexEncoding::Compressed) } })
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
@@ -0,0 +1,670 @@
+#include "headless.hxx"
+#include "sys/logger.hxx"
+#include "phusis/internal/constantblock.hxx"
+#include <cstring>
+
+/*
+ * OpCapability Shader
+ * OpMemoryModel Logical GLSL450
+ * OpEntryPoint Vertex %main "main" %pos
+ * OpDecorate %pos BuiltIn Position
+ * ...
+ * %main: OpStore %pos (0, 0, 0, 1); OpReturn
+ */
+static constexpr uint32_t _vertexShader[] = {
+		0x07230203, 0x00010000, 0, 12, 0,
+		(2 << 16) | 17, 1,
+		(3 << 16) | 14, 0, 1,
+		(6 << 16) | 15, 0, 1, 0x6e69616d, 0, 2,
+		(4 << 16) | 71, 2, 11, 0,
+		(2 << 16) | 19, 3,
+		(3 << 16) | 33, 4, 3,
+		(3 << 16) | 22, 5, 32,
+		(4 << 16) | 23, 6, 5, 4,
+		(4 << 16) | 32, 7, 3, 6,
+		(4 << 16) | 59, 7, 2, 3,
+		(4 << 16) | 43, 5, 8, 0,
+		(4 << 16) | 43, 5, 9, 0x3f800000,
+		(7 << 16) | 44, 6, 10, 8, 8, 8, 9,
+		(5 << 16) | 54, 3, 1, 0, 4,
+		(2 << 16) | 248, 11,
+		(3 << 16) | 62, 2, 10,
+		(1 << 16) | 253,
+		(1 << 16) | 56,
+};
+
+/*
+ * layout(push_constant) uniform Block { mat4 MVP; };
+ * layout(location = 0..2) in vec4 position, normal, uv;
+ * gl_Position = MVP * (position + normal + uv);
+ * every stream feeds the output, so none of the fetches can be dropped
+ */
+static constexpr uint32_t _streamShader[] = {
+		0x07230203, 0x00010000, 0, 28, 0,
+		(2 << 16) | 17, 1,
+		(3 << 16) | 14, 0, 1,
+		(9 << 16) | 15, 0, 1, 0x6e69616d, 0, 2, 16, 17, 18,
+		(4 << 16) | 71, 2, 11, 0,
+		(4 << 16) | 71, 16, 30, 0,
+		(4 << 16) | 71, 17, 30, 1,
+		(4 << 16) | 71, 18, 30, 2,
+		(3 << 16) | 71, 9, 2,
+		(4 << 16) | 72, 9, 0, 5,
+		(5 << 16) | 72, 9, 0, 35, 0,
+		(5 << 16) | 72, 9, 0, 7, 16,
+		(2 << 16) | 19, 3,
+		(3 << 16) | 33, 4, 3,
+		(3 << 16) | 22, 5, 32,
+		(4 << 16) | 23, 6, 5, 4,
+		(4 << 16) | 32, 7, 3, 6,
+		(4 << 16) | 59, 7, 2, 3,
+		(4 << 16) | 24, 8, 6, 4,
+		(3 << 16) | 30, 9, 8,
+		(4 << 16) | 32, 10, 9, 9,
+		(4 << 16) | 59, 10, 11, 9,
+		(4 << 16) | 21, 12, 32, 1,
+		(4 << 16) | 43, 12, 13, 0,
+		(4 << 16) | 32, 14, 9, 8,
+		(4 << 16) | 32, 15, 1, 6,
+		(4 << 16) | 59, 15, 16, 1,
+		(4 << 16) | 59, 15, 17, 1,
+		(4 << 16) | 59, 15, 18, 1,
+		(5 << 16) | 54, 3, 1, 0, 4,
+		(2 << 16) | 248, 19,
+		(5 << 16) | 65, 14, 27, 11, 13,
+		(4 << 16) | 61, 8, 20, 27,
+		(4 << 16) | 61, 6, 21, 16,
+		(4 << 16) | 61, 6, 22, 17,
+		(4 << 16) | 61, 6, 23, 18,
+		(5 << 16) | 129, 6, 24, 21, 22,
+		(5 << 16) | 129, 6, 25, 24, 23,
+		(5 << 16) | 145, 6, 26, 20, 25,
+		(3 << 16) | 62, 2, 26,
+		(1 << 16) | 253,
+		(1 << 16) | 56,
+};
+
+Phusis::Bench::HeadlessDevice::HeadlessDevice() noexcept
+{
+	if (!InitializeInstance() || !InitializeDevice() || !InitializeTarget() || !InitializePipeline())
+	{
+		sys::log.head(sys::WARN) << "headless device unavailable; frame benchmarks will be skipped" << sys::EOM;
+	}
+}
+
+Phusis::Bench::HeadlessDevice::~HeadlessDevice() noexcept
+{
+	if (Device)
+	{
+		vkDeviceWaitIdle(Device);
+		ReleaseMeshes();
+
+		vkDestroyPipeline(Device, Pipeline, nullptr);
+		vkDestroyPipelineLayout(Device, PipelineLayout, nullptr);
+		vkDestroyFramebuffer(Device, Framebuffer, nullptr);
+		vkDestroyRenderPass(Device, RenderPass, nullptr);
+		vkDestroyImageView(Device, View, nullptr);
+		vkDestroyImage(Device, Image, nullptr);
+		vkFreeMemory(Device, ImageMemory, nullptr);
+		vkDestroyCommandPool(Device, Pool, nullptr);
+		vkDestroyDevice(Device, nullptr);
+	}
+	if (Instance)
+		vkDestroyInstance(Instance, nullptr);
+}
+
+Phusis::Bench::HeadlessDevice& Phusis::Bench::HeadlessDevice::Shared() noexcept
+{
+	static HeadlessDevice device;
+	return device;
+}
+
+bool Phusis::Bench::HeadlessDevice::InitializeInstance() noexcept
+{
+	VkApplicationInfo app{};
+	app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	app.pApplicationName = "phusis-bench";
+	app.apiVersion = VK_API_VERSION_1_1;
+
+	VkInstanceCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	info.pApplicationInfo = &app;
+
+	if (vkCreateInstance(&info, nullptr, &Instance) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create vulkan instance" << sys::EOM;
+		Instance = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool Phusis::Bench::HeadlessDevice::InitializeDevice() noexcept
+{
+	uint32_t count = 0;
+	vkEnumeratePhysicalDevices(Instance, &count, nullptr);
+	std::vector<VkPhysicalDevice> devices(count);
+	vkEnumeratePhysicalDevices(Instance, &count, devices.data());
+
+	// a cpu implementation keeps numbers comparable between machines
+	for (VkPhysicalDevice device : devices)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device, &properties);
+		if (!PhysicalDevice || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+		{
+			PhysicalDevice = device;
+			Name = properties.deviceName;
+		}
+	}
+
+	if (!PhysicalDevice)
+	{
+		sys::log.head(sys::FAIL) << "no vulkan physical device" << sys::EOM;
+		return false;
+	}
+
+	vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> families(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &count, families.data());
+
+	QueueIdx = UINT32_MAX;
+	for (uint32_t i = 0; i < count && QueueIdx == UINT32_MAX; ++i)
+		if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+			QueueIdx = i;
+
+	if (QueueIdx == UINT32_MAX)
+	{
+		sys::log.head(sys::FAIL) << "no graphics queue on " << Name << sys::EOM;
+		return false;
+	}
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(PhysicalDevice, &properties);
+	TimestampBits = families[QueueIdx].timestampValidBits;
+	TimestampPeriod = TimestampBits ? properties.limits.timestampPeriod : 0.f;
+
+	float priority = 1.f;
+	VkDeviceQueueCreateInfo queue{};
+	queue.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queue.queueFamilyIndex = QueueIdx;
+	queue.queueCount = 1;
+	queue.pQueuePriorities = &priority;
+
+	VkDeviceCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	info.queueCreateInfoCount = 1;
+	info.pQueueCreateInfos = &queue;
+
+	if (vkCreateDevice(PhysicalDevice, &info, nullptr, &Device) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create device on " << Name << sys::EOM;
+		Device = nullptr;
+		return false;
+	}
+
+	vkGetDeviceQueue(Device, QueueIdx, 0, &Queue);
+
+	VkCommandPoolCreateInfo pool{};
+	pool.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	pool.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	pool.queueFamilyIndex = QueueIdx;
+
+	if (vkCreateCommandPool(Device, &pool, nullptr, &Pool) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create primary command pool" << sys::EOM;
+		Pool = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t Phusis::Bench::HeadlessDevice::MemoryType(uint32_t bits, VkMemoryPropertyFlags flags) const noexcept
+{
+	VkPhysicalDeviceMemoryProperties properties;
+	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &properties);
+
+	for (uint32_t i = 0; i < properties.memoryTypeCount; ++i)
+		if ((bits & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags)
+			return i;
+
+	return UINT32_MAX;
+}
+
+bool Phusis::Bench::HeadlessDevice::InitializeTarget() noexcept
+{
+	VkImageCreateInfo image{};
+	image.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	image.imageType = VK_IMAGE_TYPE_2D;
+	image.format = ColorFormat;
+	image.extent = { Width, Height, 1 };
+	image.mipLevels = 1;
+	image.arrayLayers = 1;
+	image.samples = VK_SAMPLE_COUNT_1_BIT;
+	image.tiling = VK_IMAGE_TILING_OPTIMAL;
+	image.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	image.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	if (vkCreateImage(Device, &image, nullptr, &Image) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create offscreen image" << sys::EOM;
+		Image = nullptr;
+		return false;
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(Device, Image, &requirements);
+
+	VkMemoryAllocateInfo allocate{};
+	allocate.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate.allocationSize = requirements.size;
+	allocate.memoryTypeIndex = MemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (allocate.memoryTypeIndex == UINT32_MAX)
+		allocate.memoryTypeIndex = MemoryType(requirements.memoryTypeBits, 0);
+
+	if (vkAllocateMemory(Device, &allocate, nullptr, &ImageMemory) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not allocate offscreen image memory" << sys::EOM;
+		ImageMemory = nullptr;
+		return false;
+	}
+	vkBindImageMemory(Device, Image, ImageMemory, 0);
+
+	VkImageViewCreateInfo view{};
+	view.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	view.image = Image;
+	view.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	view.format = ColorFormat;
+	view.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	view.subresourceRange.levelCount = 1;
+	view.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(Device, &view, nullptr, &View) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create offscreen image view" << sys::EOM;
+		View = nullptr;
+		return false;
+	}
+
+	VkAttachmentDescription color{};
+	color.format = ColorFormat;
+	color.samples = VK_SAMPLE_COUNT_1_BIT;
+	color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	color.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	color.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference reference{};
+	reference.attachment = 0;
+	reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &reference;
+
+	VkRenderPassCreateInfo pass{};
+	pass.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	pass.attachmentCount = 1;
+	pass.pAttachments = &color;
+	pass.subpassCount = 1;
+	pass.pSubpasses = &subpass;
+
+	if (vkCreateRenderPass(Device, &pass, nullptr, &RenderPass) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create offscreen render pass" << sys::EOM;
+		RenderPass = nullptr;
+		return false;
+	}
+
+	VkFramebufferCreateInfo framebuffer{};
+	framebuffer.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebuffer.renderPass = RenderPass;
+	framebuffer.attachmentCount = 1;
+	framebuffer.pAttachments = &View;
+	framebuffer.width = Width;
+	framebuffer.height = Height;
+	framebuffer.layers = 1;
+
+	if (vkCreateFramebuffer(Device, &framebuffer, nullptr, &Framebuffer) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create offscreen framebuffer" << sys::EOM;
+		Framebuffer = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool Phusis::Bench::HeadlessDevice::InitializePipeline() noexcept
+{
+	VkPushConstantRange range{};
+	range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	range.offset = 0;
+	range.size = sizeof(Internal::ConstantBlock);
+
+	VkPipelineLayoutCreateInfo layout{};
+	layout.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layout.pushConstantRangeCount = 1;
+	layout.pPushConstantRanges = &range;
+
+	if (vkCreatePipelineLayout(Device, &layout, nullptr, &PipelineLayout) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create benchmark pipeline layout" << sys::EOM;
+		PipelineLayout = nullptr;
+		return false;
+	}
+
+	// no vertex input; the bound streams are never read
+	VkPipelineVertexInputStateCreateInfo input{};
+	input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+	return CreatePipeline(_vertexShader, sizeof(_vertexShader), input, Pipeline);
+}
+
+bool Phusis::Bench::HeadlessDevice::CreatePipeline(const uint32_t* code, size_t size, const VkPipelineVertexInputStateCreateInfo& input, VkPipeline& pipeline) noexcept
+{
+	VkShaderModuleCreateInfo module{};
+	module.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	module.codeSize = size;
+	module.pCode = code;
+
+	VkShaderModule shader;
+	if (vkCreateShaderModule(Device, &module, nullptr, &shader) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create benchmark shader module" << sys::EOM;
+		return false;
+	}
+
+	VkPipelineShaderStageCreateInfo stage{};
+	stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stage.module = shader;
+	stage.pName = "main";
+
+	VkPipelineInputAssemblyStateCreateInfo assembly{};
+	assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	VkPipelineViewportStateCreateInfo viewport{};
+	viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewport.viewportCount = 1;
+	viewport.scissorCount = 1;
+
+	VkPipelineRasterizationStateCreateInfo raster{};
+	raster.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	raster.rasterizerDiscardEnable = VK_TRUE;
+	raster.polygonMode = VK_POLYGON_MODE_FILL;
+	raster.cullMode = VK_CULL_MODE_NONE;
+	raster.lineWidth = 1.f;
+
+	VkDynamicState states[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamic{};
+	dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamic.dynamicStateCount = 2;
+	dynamic.pDynamicStates = states;
+
+	VkGraphicsPipelineCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	info.stageCount = 1;
+	info.pStages = &stage;
+	info.pVertexInputState = &input;
+	info.pInputAssemblyState = &assembly;
+	info.pViewportState = &viewport;
+	info.pRasterizationState = &raster;
+	info.pDynamicState = &dynamic;
+	info.layout = PipelineLayout;
+	info.renderPass = RenderPass;
+	info.subpass = 0;
+
+	VkResult result = vkCreateGraphicsPipelines(Device, nullptr, 1, &info, nullptr, &pipeline);
+	vkDestroyShaderModule(Device, shader, nullptr);
+
+	if (result != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create benchmark pipeline" << sys::EOM;
+		pipeline = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool Phusis::Bench::HeadlessDevice::Valid() const noexcept
+{
+	return Pipeline != nullptr;
+}
+
+std::vector<Phusis::Mesh> Phusis::Bench::HeadlessDevice::CreateMeshes(uint32_t n) noexcept
+{
+	std::vector<Mesh> meshes;
+	if (!Valid() || !n)
+		return meshes;
+
+	// one small vertex and index buffer per mesh, all in a single allocation
+	constexpr VkDeviceSize size = 64;
+
+	VkBufferCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	info.size = size;
+	info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	size_t first = _buffers.size();
+	for (uint32_t i = 0; i < 2 * n; ++i)
+	{
+		VkBuffer buffer;
+		if (vkCreateBuffer(Device, &info, nullptr, &buffer) != VK_SUCCESS)
+		{
+			sys::log.head(sys::FAIL) << "could not create benchmark mesh buffer" << sys::EOM;
+			return {};
+		}
+		_buffers.push_back(buffer);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(Device, _buffers[first], &requirements);
+	VkDeviceSize stride = (requirements.size + requirements.alignment - 1) / requirements.alignment * requirements.alignment;
+
+	VkMemoryAllocateInfo allocate{};
+	allocate.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate.allocationSize = stride * 2 * n;
+	allocate.memoryTypeIndex = MemoryType(
+			requirements.memoryTypeBits,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	VkDeviceMemory memory;
+	if (allocate.memoryTypeIndex == UINT32_MAX || vkAllocateMemory(Device, &allocate, nullptr, &memory) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not allocate benchmark mesh memory" << sys::EOM;
+		return {};
+	}
+	_memory.push_back(memory);
+
+	// zero indices: every triangle is degenerate at vertex 0
+	void* mapped;
+	if (vkMapMemory(Device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS)
+	{
+		std::memset(mapped, 0, allocate.allocationSize);
+		vkUnmapMemory(Device, memory);
+	}
+
+	meshes.reserve(n);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		VkBuffer vertices = _buffers[first + 2 * i];
+		VkBuffer indices = _buffers[first + 2 * i + 1];
+		vkBindBufferMemory(Device, vertices, memory, stride * 2 * i);
+		vkBindBufferMemory(Device, indices, memory, stride * (2 * i + 1));
+
+		// levels share the buffer: 15, 6 and 3 indices of the zeroed 64 bytes
+		meshes.emplace_back(
+				std::vector<Buffer>{ Buffer(vertices, 3, VK_FORMAT_R32G32B32_SFLOAT, 12) },
+				std::vector<Buffer>{ Buffer(indices, 15), Buffer(indices, 6), Buffer(indices, 3) },
+				glm::mat4(1.f),
+				std::vector<float>{ 0.f, .01f, .04f });
+	}
+
+	return meshes;
+}
+
+std::vector<Phusis::Mesh> Phusis::Bench::HeadlessDevice::CreateStreamMeshes(uint32_t n, uint32_t vertices, VertexEncoding encoding) noexcept
+{
+	std::vector<Mesh> meshes;
+	if (!Valid() || !n || !vertices)
+		return meshes;
+
+	constexpr std::array<VertexAttribute, 3> attributes = { VertexAttribute::Position, VertexAttribute::Normal, VertexAttribute::TexCoord };
+	constexpr uint32_t buffers = attributes.size() + 1;
+
+	// the streams, then the index buffer
+	std::array<VkDeviceSize, buffers> sizes{};
+	for (uint32_t a = 0; a < attributes.size(); ++a)
+		sizes[a] = VkDeviceSize(vertices) * StreamFormat(attributes[a], encoding).Stride;
+	sizes[attributes.size()] = VkDeviceSize(vertices) * sizeof(uint32_t);
+
+	VkBufferCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	// every buffer of every mesh in a single allocation
+	size_t first = _buffers.size();
+	std::vector<VkDeviceSize> offsets(buffers * n);
+	VkDeviceSize total = 0;
+	uint32_t types = UINT32_MAX;
+	for (uint32_t i = 0; i < buffers * n; ++i)
+	{
+		info.size = sizes[i % buffers];
+
+		VkBuffer buffer;
+		if (vkCreateBuffer(Device, &info, nullptr, &buffer) != VK_SUCCESS)
+		{
+			sys::log.head(sys::FAIL) << "could not create benchmark stream buffer" << sys::EOM;
+			return {};
+		}
+		_buffers.push_back(buffer);
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(Device, buffer, &requirements);
+		offsets[i] = (total + requirements.alignment - 1) / requirements.alignment * requirements.alignment;
+		total = offsets[i] + requirements.size;
+		types &= requirements.memoryTypeBits;
+	}
+
+	VkMemoryAllocateInfo allocate{};
+	allocate.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate.allocationSize = total;
+	allocate.memoryTypeIndex = MemoryType(types, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	VkDeviceMemory memory;
+	if (allocate.memoryTypeIndex == UINT32_MAX || vkAllocateMemory(Device, &allocate, nullptr, &memory) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not allocate benchmark stream memory" << sys::EOM;
+		return {};
+	}
+	_memory.push_back(memory);
+
+	// the stream contents do not change the fetch; the indices walk every vertex once
+	void* mapped;
+	if (vkMapMemory(Device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not map benchmark stream memory" << sys::EOM;
+		return {};
+	}
+	std::memset(mapped, 0, total);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		auto* indices = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(mapped) + offsets[buffers * i + attributes.size()]);
+		for (uint32_t k = 0; k < vertices; ++k)
+			indices[k] = k;
+	}
+	vkUnmapMemory(Device, memory);
+
+	// positions are packed over the unit cube
+	glm::mat4 dequantization = encoding == VertexEncoding::Compressed ? DequantizationMatrix(pre::vec3f(-1.f), pre::vec3f(1.f)) : glm::mat4(1.f);
+
+	meshes.reserve(n);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		for (uint32_t b = 0; b < buffers; ++b)
+			vkBindBufferMemory(Device, _buffers[first + buffers * i + b], memory, offsets[buffers * i + b]);
+
+		std::vector<Buffer> streams;
+		for (uint32_t a = 0; a < attributes.size(); ++a)
+		{
+			VertexStreamFormat format = StreamFormat(attributes[a], encoding);
+			streams.emplace_back(_buffers[first + buffers * i + a], vertices, format.Format, format.Stride);
+		}
+
+		meshes.emplace_back(
+				std::move(streams),
+				std::vector<Buffer>{ Buffer(_buffers[first + buffers * i + attributes.size()], vertices) },
+				dequantization);
+	}
+
+	return meshes;
+}
+
+VkPipeline Phusis::Bench::HeadlessDevice::CreateStreamPipeline(const Mesh& mesh) noexcept
+{
+	if (!Valid())
+		return nullptr;
+
+	VertexInputDescription input(mesh);
+
+	VkPipeline pipeline;
+	if (!CreatePipeline(_streamShader, sizeof(_streamShader), input.Info(), pipeline))
+		return nullptr;
+
+	_pipelines.push_back(pipeline);
+	return pipeline;
+}
+
+void Phusis::Bench::HeadlessDevice::ReleaseMeshes() noexcept
+{
+	for (VkPipeline pipeline : _pipelines)
+		vkDestroyPipeline(Device, pipeline, nullptr);
+	for (VkBuffer buffer : _buffers)
+		vkDestroyBuffer(Device, buffer, nullptr);
+	for (VkDeviceMemory memory : _memory)
+		vkFreeMemory(Device, memory, nullptr);
+
+	_buffers.clear();
+	_memory.clear();
+	_pipelines.clear();
+}
+
+Phusis::Internal::VkRendererInheritance Phusis::Bench::HeadlessDevice::Inheritance() const noexcept
+{
+	Internal::VkRendererInheritance inheritance{};
+	inheritance.Device = Device;
+	inheritance.Queue = Queue;
+	inheritance.QueueIdx = QueueIdx;
+	inheritance.Pool = Pool;
+	inheritance.RenderPass = RenderPass;
+	inheritance.Pipeline = Pipeline;
+	inheritance.PipelineLayout = PipelineLayout;
+	inheritance.ClearColor = { { 0.f, 0.f, 0.f, 1.f } };
+	inheritance.DynamicRendering = false;
+	inheritance.ColorFormat = ColorFormat;
+	inheritance.DepthFormat = VK_FORMAT_UNDEFINED;
+	inheritance.TimestampPeriod = TimestampPeriod;
+	inheritance.TimestampBits = TimestampBits;
+	return inheritance;
+}
+
+Phusis::Internal::VkFrameData Phusis::Bench::HeadlessDevice::Frame() const noexcept
+{
+	Internal::VkFrameData frame{};
+	frame.Framebuffer = Framebuffer;
+	frame.Image = Image;
+	frame.View = View;
+	frame.DepthImage = nullptr;
+	frame.DepthView = nullptr;
+	return frame;
+}
@@ -0,0 +1,89 @@
+#ifndef PHUSIS_BENCH_HEADLESS_HXX
+#define PHUSIS_BENCH_HEADLESS_HXX
+
+#include "fw.hxx"
+#include "phusis/internal/vkstatemachine.hxx"
+#include "phusis/vertexformat.hxx"
+
+namespace Phusis::Bench
+{
+	/// @brief Offscreen device for frame benchmarks; prefers a CPU implementation (lavapipe)
+	/// so results are comparable across machines without a GPU.
+	/// The pipeline is vertex-only with rasterization discarded: recording and submission
+	/// costs are real, fragment work is not measured.
+	class HeadlessDevice
+	{
+	private:
+		std::vector<VkBuffer> _buffers{};
+		std::vector<VkDeviceMemory> _memory{};
+		std::vector<VkPipeline> _pipelines{};
+
+	public:
+		static constexpr uint32_t Width = 256;
+		static constexpr uint32_t Height = 256;
+		static constexpr VkFormat ColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+		std::string Name{};
+
+		VkInstance Instance = nullptr;
+		VkPhysicalDevice PhysicalDevice = nullptr;
+		VkDevice Device = nullptr;
+		VkQueue Queue = nullptr;
+		uint32_t QueueIdx = 0;
+		// GPU time per frame for VkFrameTimings::Gpu; 0 without timestamps
+		float TimestampPeriod = 0.f;
+		uint32_t TimestampBits = 0;
+
+		VkCommandPool Pool = nullptr;
+		VkRenderPass RenderPass = nullptr;
+		VkPipelineLayout PipelineLayout = nullptr;
+		VkPipeline Pipeline = nullptr;
+
+		VkImage Image = nullptr;
+		VkDeviceMemory ImageMemory = nullptr;
+		VkImageView View = nullptr;
+		VkFramebuffer Framebuffer = nullptr;
+
+	private:
+		bool InitializeInstance() noexcept;
+		bool InitializeDevice() noexcept;
+		bool InitializeTarget() noexcept;
+		bool InitializePipeline() noexcept;
+
+		/// @brief Vertex-only pipeline on RenderPass and PipelineLayout, rasterization discarded
+		bool CreatePipeline(const uint32_t* code, size_t size, const VkPipelineVertexInputStateCreateInfo& input, VkPipeline& pipeline) noexcept;
+
+		uint32_t MemoryType(uint32_t bits, VkMemoryPropertyFlags flags) const noexcept;
+
+	public:
+		HeadlessDevice() noexcept;
+		~HeadlessDevice() noexcept;
+
+		HeadlessDevice(const HeadlessDevice&) = delete;
+		HeadlessDevice& operator=(const HeadlessDevice&) = delete;
+
+		/// @brief Process-wide device, created on first use
+		static HeadlessDevice& Shared() noexcept;
+
+	public:
+		[[nodiscard]] bool Valid() const noexcept;
+
+		/// @brief n single-triangle meshes backed by real buffers; released with ReleaseMeshes
+		std::vector<Mesh> CreateMeshes(uint32_t n) noexcept;
+
+		/// @brief n meshes of position, normal and uv streams in the encoding, each vertex drawn once
+		/// @param vertices per mesh, a multiple of 3
+		std::vector<Mesh> CreateStreamMeshes(uint32_t n, uint32_t vertices, VertexEncoding encoding) noexcept;
+
+		/// @brief Pipeline whose vertex shader reads every stream of the mesh; nullptr on failure
+		VkPipeline CreateStreamPipeline(const Mesh& mesh) noexcept;
+
+		/// @brief Meshes and stream pipelines made so far
+		void ReleaseMeshes() noexcept;
+
+		[[nodiscard]] Internal::VkRendererInheritance Inheritance() const noexcept;
+		[[nodiscard]] Internal::VkFrameData Frame() const noexcept;
+	};
+}
+
+#endif //PHUSIS_BENCH_HEADLESS_HXX
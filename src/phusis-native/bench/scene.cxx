@@ -0,0 +1,82 @@
+#include "scene.hxx"
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+template<typename T>
+static T placeholder(uint64_t value) noexcept
+{
+	// non-dispatchable handles are pointers on 64-bit targets and uint64_t elsewhere
+	if constexpr (std::is_pointer_v<T>)
+		return reinterpret_cast<T>(static_cast<uintptr_t>(value));
+	else
+		return static_cast<T>(value);
+}
+
+std::vector<Phusis::Mesh> Phusis::Bench::PlaceholderMeshes(uint32_t n)
+{
+	std::vector<Mesh> meshes;
+	meshes.reserve(n);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		VkBuffer vertices = placeholder<VkBuffer>(0x1000 + 4 * i);
+		VkBuffer lod0 = placeholder<VkBuffer>(0x1001 + 4 * i);
+		VkBuffer lod1 = placeholder<VkBuffer>(0x1002 + 4 * i);
+		VkBuffer lod2 = placeholder<VkBuffer>(0x1003 + 4 * i);
+
+		// a 4x reduction per level, the usual simplifier target
+		meshes.emplace_back(
+				std::vector<Buffer>{ Buffer(vertices, 3, VK_FORMAT_R32G32B32_SFLOAT, 12) },
+				std::vector<Buffer>{ Buffer(lod0, 3072), Buffer(lod1, 768), Buffer(lod2, 192) },
+				glm::mat4(1.f),
+				std::vector<float>{ 0.f, .01f, .04f });
+	}
+	return meshes;
+}
+
+Phusis::Bench::SyntheticScene::SyntheticScene(const SceneParams& params, const std::vector<Mesh>& meshes)
+{
+	std::mt19937 rng(params.Seed);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	std::uniform_int_distribution<uint32_t> mesh(0, std::max<uint32_t>(std::min<uint32_t>(params.Meshes, meshes.size()), 1) - 1);
+	std::uniform_int_distribution<uint32_t> material(0, 63);
+
+	_positions.reserve(params.Objects);
+	_axes.reserve(params.Objects);
+	Objects.reserve(params.Objects);
+	Transforms.reserve(params.Objects);
+
+	for (uint32_t i = 0; i < params.Objects; ++i)
+	{
+		glm::vec3 position(unit(rng) * 50.f, unit(rng) * 50.f, unit(rng) * 50.f);
+		glm::vec3 axis = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.f, 2.f, 0.f));
+
+		_positions.push_back(position);
+		_axes.push_back(axis);
+
+		Objects.emplace_back(meshes[mesh(rng)], params.Pipeline, material(rng));
+
+		EngineObjectTransform transform{};
+		transform.Rotation = glm::rotate(glm::translate(glm::mat4(1.f), position), unit(rng) * 3.14159f, axis);
+		transform.Color = glm::vec4(unit(rng) * .5f + .5f, unit(rng) * .5f + .5f, unit(rng) * .5f + .5f, 1.f);
+		transform.Enabled = 1;
+		Transforms.push_back(transform);
+	}
+
+	std::vector<uint32_t> order(params.Objects);
+	for (uint32_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::shuffle(order.begin(), order.end(), rng);
+
+	uint32_t dynamic = static_cast<uint32_t>(std::clamp(params.Dynamic, 0.f, 1.f) * params.Objects);
+	Dynamic.assign(order.begin(), order.begin() + dynamic);
+	std::sort(Dynamic.begin(), Dynamic.end());
+
+	View = glm::lookAt(glm::vec3(0.f, 0.f, 120.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+	Projection = glm::perspective(glm::radians(60.f), 1.f, .1f, 500.f);
+}
+
+void Phusis::Bench::SyntheticScene::Animate(float t) noexcept
+{
+	for (uint32_t i : Dynamic)
+		Transforms[i].Rotation = glm::rotate(glm::translate(glm::mat4(1.f), _positions[i]), t + i * .01f, _axes[i]);
+}
@@ -0,0 +1,50 @@
+#ifndef PHUSIS_BENCH_SCENE_HXX
+#define PHUSIS_BENCH_SCENE_HXX
+
+#include "fw.hxx"
+#include "phusis/engineobject.hxx"
+
+namespace Phusis::Bench
+{
+	struct SceneParams
+	{
+		uint32_t Objects;
+		uint32_t Meshes;
+		// fraction of objects whose transform changes every frame
+		float Dynamic;
+		uint32_t Seed = 1;
+		// every object is drawn with it; nullptr keeps the default pipeline
+		VkPipeline Pipeline = nullptr;
+	};
+
+	/// @brief Objects scattered over a cube in front of the camera; deterministic per seed
+	class SyntheticScene
+	{
+	private:
+		std::vector<glm::vec3> _positions;
+		std::vector<glm::vec3> _axes;
+
+	public:
+		std::vector<EngineObjectData> Objects;
+		std::vector<EngineObjectTransform> Transforms;
+
+		// indices animated by Animate
+		std::vector<uint32_t> Dynamic;
+
+		glm::mat4 View;
+		glm::mat4 Projection;
+
+	public:
+		/// @param meshes pool the objects draw from; params.Meshes of them are used
+		SyntheticScene(const SceneParams& params, const std::vector<Mesh>& meshes);
+
+	public:
+		/// @brief Spin every dynamic object in place to time t (seconds)
+		void Animate(float t) noexcept;
+	};
+
+	/// @brief Meshes with distinct placeholder buffer handles, for benchmarks that never reach a device
+	std::vector<Mesh> PlaceholderMeshes(uint32_t n);
+}
+
+#endif //PHUSIS_BENCH_SCENE_HXX
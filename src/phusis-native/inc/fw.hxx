@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cmath>
 
 #include <iostream>
 
@@ -24,6 +25,8 @@
 #include <thread>
 #include <queue>
 #include <future>
+#include <mutex>
+#include <condition_variable>
 
 #include <unistd.h>
 #include <threads.h>
@@ -3,9 +3,36 @@
 
 #include "fw.hxx"
 #include "engineobject.hxx"
+#include "scenechannel.hxx"
+#include "transformhierarchy.hxx"
+#include "entitystore.hxx"
+#include "metrics.hxx"
+#include "meshblob.hxx"
+#include "sys/pacer.hxx"
+#include "sys/spsc.hxx"
+#include "sys/workers.hxx"
+#include "internal/vkdeletionqueue.hxx"
+#include "internal/vkuploadring.hxx"
+#include "internal/framecapture.hxx"
+#include <functional>
+#include <memory>
 
 namespace Phusis
 {
+	namespace Internal
+	{
+		class VkStateMachine;
+		struct VkBoundData;
+	}
+
+	// frame rate while the window is unfocused, until LimitBackgroundRate says otherwise
+	constexpr double DefaultBackgroundRate = 15.;
+
+	/// @brief Work the render thread runs before every frame, while nothing else touches the scene
+	/// @details Entities may change structurally, and EntityStore::Each may fan out over workers, the
+	/// renderer's own, idle between frames.
+	using System = std::function<void(EntityStore& entities, sys::workers& workers)>;
+
 	enum class ApplicationMode
 	{
 		Performant,
@@ -14,15 +41,26 @@ namespace Phusis
 
 	using Window = GLFWwindow*;
 
-	class ThreadData
+	class DLLEXPORT Application
 	{
-	public:
-		VkCommandPool CommandPool;
-		VkCommandBuffer CommandBuffer;
-	};
+	private:
+		enum class WindowEventType : uint32_t
+		{
+			Resize,
+			Focus,
+			Iconify,
+			// key, button or cursor; only its time is kept
+			Input,
+			Close
+		};
+
+		struct WindowEvent
+		{
+			WindowEventType Type;
+			int32_t X, Y;
+			std::chrono::steady_clock::time_point Time;
+		};
 
-	class Application
-	{
 	private:
 		std::vector<std::string> _requiredLayers;
 		std::vector<std::string> _requiredExtensions;
@@ -43,23 +81,110 @@ namespace Phusis
 		VkPipelineLayout PipelineLayout = nullptr;
 		VkPipeline Pipeline = nullptr;
 
+		bool DynamicRendering = false;
+		PFN_vkCmdBeginRenderingKHR CmdBeginRendering = nullptr;
+		PFN_vkCmdEndRenderingKHR CmdEndRendering = nullptr;
+		PFN_vkCmdPipelineBarrier2KHR CmdPipelineBarrier2 = nullptr;
+
+		// VK_EXT_mesh_shader with buffer device addresses; MeshPipeline is left to the caller, built on
+		// MeshPipelineLayout, and takes over levels whose meshlets are on the device
+		bool MeshShading = false;
+		PFN_vkCmdDrawMeshTasksEXT CmdDrawMeshTasks = nullptr;
+		VkPipelineLayout MeshPipelineLayout = nullptr;
+		VkPipeline MeshPipeline = nullptr;
+
+		// VK_EXT_descriptor_indexing; BindlessPipeline is left to the caller, built on BindlessPipelineLayout,
+		// and takes over objects on the default pipeline, see Internal::BindlessObject
+		bool Bindless = false;
+		VkDescriptorSetLayout BindlessSetLayout = nullptr;
+		VkPipelineLayout BindlessPipelineLayout = nullptr;
+		VkPipeline BindlessPipeline = nullptr;
+
+		// multiDrawIndirect: commands one vkCmdDrawIndexedIndirect may take; 0 when the device lacks it
+		uint32_t DrawIndirectCount = 0;
+
+		// the camera Run starts with; SetCamera moves it while running
 		glm::mat4 Projection, View;
 
 	private:
 		VkPresentModeKHR _presentMode = VK_PRESENT_MODE_FIFO_KHR;
 
 		uint32_t _queueFamilyIdx = 0;
+		float _timestampPeriod = 0.f;
+		uint32_t _timestampBits = 0;
 
 		std::vector<VkImage> _swapchainBuffers{};
 		std::vector<VkImageView> _swapchainViews{};
-		std::vector<ThreadData> _threads{ std::thread::hardware_concurrency()};
 
 		std::vector<VkFramebuffer> _framebuffers{};
 
+		// one depth attachment at the swapchain extent; frames in flight order their use of it with barriers
+		VkImage _depthImage = nullptr;
+		VkDeviceMemory _depthMemory = nullptr;
+		VkImageView _depthView = nullptr;
+
+		// handles still referenced by frames in flight
+		Internal::VkDeletionQueue _deletions{};
+
+		// the window thread produces, the render thread consumes
+		sys::spsc<WindowEvent> _events{ 10 };
+		std::atomic<bool> _running{ false };
+
+		// render thread only, once Run has started it
+		bool _resized = false;
+		int32_t _framebufferWidth = 0;
+		int32_t _framebufferHeight = 0;
+
 		std::vector<EngineObjectData> _objects{};
+		std::vector<EngineObjectTransform> _transforms{};
+		SceneChannel _channel{};
+		TransformHierarchy _hierarchy{};
+		EntityStore _entities{};
+
+		// LoadMeshes: each blob stays mapped for its meshlets and has its data in one buffer of its own
+		std::vector<std::unique_ptr<MeshBlob>> _blobs{};
+		std::vector<VkBuffer> _meshBuffers{};
+		std::vector<VkDeviceMemory> _meshMemory{};
+		std::vector<Mesh> _meshes{};
+
+		// per-frame data written while recording, one region per frame in flight
+		Internal::VkUploadRing _upload{};
+
+		// one set per frame in flight, each over its own region of the upload ring
+		VkDescriptorPool _bindlessPool = nullptr;
+		std::vector<VkDescriptorSet> _bindlessSets{};
+		uint32_t _textureCapacity = 0;
+		uint32_t _textureCount = 0;
+
+		MetricsRegistry _metrics{};
+
+		// capture requests come from any thread; the render thread opens them before its next frame
+		std::mutex _captureLock;
+		std::filesystem::path _capturePath{};
+		uint32_t _captureFrames = 0;
+		std::atomic<bool> _captureRequested{ false };
+		Internal::FrameRecorder _recorder{};
+
+		// added from any thread, adopted by the render thread before its next frame
+		std::mutex _systemLock;
+		std::vector<System> _addedSystems{};
+		std::atomic<bool> _systemsAdded{ false };
+		// render thread only
+		std::vector<System> _systems{};
+
+		// written by SetCamera from any thread, copied by the render thread before its next frame
+		std::mutex _cameraLock;
+		glm::mat4 _cameraView{ 1.f };
+		glm::mat4 _cameraProjection{ 1.f };
+		std::atomic<bool> _cameraChanged{ false };
+
+		sys::pacer _pacer{};
+		std::atomic<double> _frameRate{ 0. };
+		std::atomic<double> _backgroundRate{ DefaultBackgroundRate };
 
 	private:
 		VkSurfaceFormatKHR _surfaceFormat{};
+		VkFormat _depthFormat = VK_FORMAT_UNDEFINED;
 		VkSurfaceCapabilitiesKHR _surfaceCapabilities{};
 		VkSwapchainCreateInfoKHR _swapchainInfo{};
 		VkRenderPassCreateInfo _defaultRenderPassInfo{};
@@ -98,6 +223,8 @@ namespace Phusis
 
 		bool VkInitializeSwapchain() noexcept;
 
+		[[nodiscard]] uint32_t ImageCount() const noexcept;
+
 		bool VkInitializeImageViews() noexcept;
 
 		bool VkInitializeCommandPool() noexcept;
@@ -106,11 +233,28 @@ namespace Phusis
 
 		bool VkInitializeRenderPass() noexcept;
 
+		bool VkInitializeDepth() noexcept;
+
 		bool VkInitializeFramebuffers() noexcept;
 
 		bool VkInitializePipelineLayout() noexcept;
 
-		bool UpdateCommandBuffers(VkFramebuffer buffer) noexcept;
+		bool VkInitializeUploadRing() noexcept;
+
+		bool VkInitializeBindless() noexcept;
+		void VkReleaseBindless() noexcept;
+
+		bool VkRecreateSwapchain() noexcept;
+
+		/// @brief Window thread: queue an event for the render thread
+		void Post(WindowEventType type, int32_t x = 0, int32_t y = 0) noexcept;
+
+		/// @brief Render thread: frames until a close event or a fatal error
+		int32_t RenderLoop(Internal::VkStateMachine& machine, Internal::VkBoundData& bound) noexcept;
+
+		/// @brief Whether the calling thread may touch the scene: Run is not rendering, or this is its render
+		/// thread; warns naming what when not
+		bool Owns(const char* what) const noexcept;
 
 	private:
 		int32_t InitializeDeviceDependents() noexcept;
@@ -120,7 +264,90 @@ namespace Phusis
 	public:
 		int32_t InitializeComponents() noexcept;
 
+		/// @brief Render on a thread of its own while the calling thread, which must be the one that
+		/// initialized the window, sleeps on window events and forwards them; returns once the window closes
 		int32_t Run() noexcept;
+
+		/// @brief Whether Run is rendering. Thread-safe.
+		[[nodiscard]] bool Running() const noexcept;
+
+		/// @brief Camera for the next frame Run records, until the next call; before Run, View and
+		/// Projection may be set directly. Thread-safe.
+		void SetCamera(const glm::mat4& view, const glm::mat4& projection) noexcept;
+
+		/// @brief Run system before every frame Run renders, after those added earlier. Thread-safe.
+		void AddSystem(System system) noexcept;
+
+		/// @brief Cap the rate Run presents at while focused; 0 removes the cap. Thread-safe.
+		void LimitFrameRate(double hz) noexcept;
+
+		/// @brief Rate while the window is unfocused; 0 renders at the focused rate. Minimized windows
+		/// never render. Thread-safe.
+		void LimitBackgroundRate(double hz) noexcept;
+
+	public:
+		[[nodiscard]] uint32_t ObjectCount() const noexcept;
+
+		/// @brief Format of the depth attachment; pipelines for dynamic rendering must declare it
+		[[nodiscard]] VkFormat DepthFormat() const noexcept;
+
+		/*
+		 * the render thread owns the scene while Run renders: Transforms(), Hierarchy(), Entities(),
+		 * LoadMeshes(), CreateObject(), DestroyObject() and RegisterTexture() are for use before Run or on the
+		 * render thread, i.e. from a System; any other thread streams changes through Channel() instead
+		 */
+
+		/// @brief Map a cooked blob and copy its data to the device, after InitializeComponents; its meshes
+		/// follow those loaded before
+		/// @return index of the blob's first mesh, UINT32_MAX on failure or when rejected like Transforms()
+		uint32_t LoadMeshes(const std::filesystem::path& path) noexcept;
+
+		[[nodiscard]] uint32_t MeshCount() const noexcept;
+
+		/// @brief Mesh idx of those loaded; valid until the application is destroyed
+		[[nodiscard]] const Mesh& LoadedMesh(uint32_t idx) const noexcept;
+
+		/// @brief Append an object drawn with mesh, at the identity, white and enabled; invalidates Transforms()
+		/// @return its index, UINT32_MAX when rejected like Transforms()
+		uint32_t CreateObject(const Mesh& mesh, VkPipeline pipeline = nullptr, uint32_t material = 0) noexcept;
+
+		/// @brief Remove object idx in time linear in the object count; the objects after it move down one
+		/// index and its children become roots. Updates still in the channel keep the indices they were sent with.
+		/// @return false if idx is out of range or the call was rejected like Transforms()
+		bool DestroyObject(uint32_t idx) noexcept;
+
+		/// @brief Contiguous, one per object; invalidated when objects are added or removed
+		[[nodiscard]] EngineObjectTransform* Transforms() noexcept;
+
+		/// @brief Safe while Run renders, from one producing thread
+		[[nodiscard]] SceneChannel& Channel() noexcept;
+
+		/// @brief Parent links between objects; writers of Transforms() in place must Invalidate what they change
+		[[nodiscard]] TransformHierarchy& Hierarchy() noexcept;
+
+		/// @brief Entities drawn with the objects; see ObjectRenderable
+		[[nodiscard]] EntityStore& Entities() noexcept;
+
+		/// @brief Frame statistics recorded by Run, plus whatever the caller registers
+		/// @details Run writes the file set with ExportTo from the window thread, checking at least every
+		/// quarter second, so an interval below that is stretched to it.
+		[[nodiscard]] MetricsRegistry& Metrics() noexcept;
+
+		/// @brief Record what the next frames' updates consume to path, for phusis-replay; an empty path
+		/// stops a running capture. Thread-safe.
+		/// @param frames 0 records until stopped or Run returns
+		void Capture(const std::filesystem::path& path, uint32_t frames) noexcept;
+
+		/// @brief Append a texture to the bindless array
+		/// @details Written into every frame's set while frames are in flight; the image must stay in
+		/// SHADER_READ_ONLY_OPTIMAL and alive until the application exits. Rejected from threads other
+		/// than the render thread while Run renders.
+		/// @return its index for BindlessObject::Material, UINT32_MAX when bindless is off, the array is full
+		/// or the call was rejected
+		uint32_t RegisterTexture(VkImageView view, VkSampler sampler) noexcept;
+
+		/// @brief Destroy a buffer and its memory once no frame in flight can reference them. Thread-safe.
+		void Release(VkBuffer buffer, VkDeviceMemory memory) noexcept;
 	};
 }
 
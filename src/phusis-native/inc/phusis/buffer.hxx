@@ -10,8 +10,20 @@ namespace Phusis
 		const VkBuffer Array;
 		const uint32_t Count;
 
-		explicit Buffer(VkBuffer arr, uint32_t cnt) noexcept
-				: Array(arr), Count(cnt)
+		// element layout for vertex streams; UNDEFINED for index buffers
+		const VkFormat Format;
+		const uint32_t Stride;
+
+		// byte offset of the first element; lets many meshes share one device buffer
+		const VkDeviceSize Offset;
+
+		explicit Buffer(
+				VkBuffer arr,
+				uint32_t cnt,
+				VkFormat fmt = VK_FORMAT_UNDEFINED,
+				uint32_t stride = 0,
+				VkDeviceSize offset = 0) noexcept
+				: Array(arr), Count(cnt), Format(fmt), Stride(stride), Offset(offset)
 		{
 		}
 	};
@@ -4,27 +4,75 @@
 #include "mesh.hxx"
 #include "fw.hxx"
 #include <utility>
+#include <type_traits>
 
 namespace Phusis
 {
-	struct EngineObjectData
+	/// @brief Per-object state written by managed code in place; kept blittable
+	struct EngineObjectTransform
 	{
-		bool enabled = true;
+		glm::mat4 Rotation;
+		glm::vec4 Color;
+		uint32_t Enabled;
+		uint32_t Reserved[3];
+	};
+
+	static_assert(std::is_standard_layout_v<EngineObjectTransform> && std::is_trivially_copyable_v<EngineObjectTransform>);
+	static_assert(sizeof(EngineObjectTransform) == 96);
+	static_assert(offsetof(EngineObjectTransform, Color) == 64 && offsetof(EngineObjectTransform, Enabled) == 80);
 
-		const glm::mat4 Rotation;
-		const glm::vec4 Color;
+	/// @brief Per-object resources; paired by index with an EngineObjectTransform
+	struct EngineObjectData
+	{
 		const Mesh Mesh;
 
+		// nullptr selects the renderer's default pipeline
+		const VkPipeline Pipeline;
+		const uint32_t Material;
+
 		explicit EngineObjectData(
-				glm::mat4 rot,
-				glm::vec4 color,
-				struct Mesh mesh) noexcept
-				: Rotation(rot),
-				  Color(color),
-				  Mesh(std::move(mesh))
+				struct Mesh mesh,
+				VkPipeline pipeline = nullptr,
+				uint32_t material = 0) noexcept
+				: Mesh(std::move(mesh)),
+				  Pipeline(pipeline),
+				  Material(material)
 		{
 		}
 	};
+
+	/*
+	 * engine objects kept in an EntityStore instead of the object vectors; every enabled entity with
+	 * ObjectTransform, ObjectColor, ObjectRenderable and ObjectLod is drawn, read from its chunk in place
+	 */
+	struct ObjectTransform
+	{
+		static constexpr uint32_t Id = 0;
+		glm::mat4 World;
+	};
+
+	struct ObjectColor
+	{
+		static constexpr uint32_t Id = 1;
+		glm::vec4 Color;
+	};
+
+	struct ObjectRenderable
+	{
+		static constexpr uint32_t Id = 2;
+		// owned by the application; nullptr is never drawn
+		const struct Mesh* Mesh;
+		// nullptr selects the renderer's default pipeline
+		VkPipeline Pipeline;
+		uint32_t Material;
+	};
+
+	/// @brief Written by the renderer: level drawn last frame, kept for hysteresis
+	struct ObjectLod
+	{
+		static constexpr uint32_t Id = 3;
+		uint32_t Level;
+	};
 }
 
 #endif //PHUSIS_ENGINEOBJECT_HXX
@@ -0,0 +1,300 @@
+#ifndef PHUSIS_ENTITYSTORE_HXX
+#define PHUSIS_ENTITYSTORE_HXX
+
+#include "fw.hxx"
+#include "sys/workers.hxx"
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace Phusis
+{
+	/*
+	 * archetype chunk, EntityChunkBytes long; rows are packed from 0 to Count() - 1
+	 * | enable mask : 1 bit per row | Entity per row | column per component, in id order |
+	 * columns start on EntityColumnAlignment, so a column of matrices is loaded as-is
+	 */
+	constexpr uint32_t EntityChunkBytes = 16384;
+	constexpr uint32_t EntityColumnAlignment = 64;
+
+	// every row holds at least its Entity, so a chunk never has more rows than this
+	constexpr uint32_t EntityRowBits = 11;
+	constexpr uint32_t EntityMaxComponents = 64;
+
+	// bit i set for component id i
+	using ComponentMask = uint64_t;
+
+	/// @brief Handle to an entity; stale once the entity is destroyed. Generation 0 is never alive.
+	struct Entity
+	{
+		uint32_t Index;
+		uint32_t Generation;
+	};
+
+	/*
+	 * a component is a trivially copyable struct with a unique `static constexpr uint32_t Id` below
+	 * EntityMaxComponents; ids are explicit so they agree across modules built with hidden visibility
+	 * and in recorded data. ids below EngineComponentIds belong to the engine.
+	 */
+	constexpr uint32_t EngineComponentIds = 16;
+
+	template<typename T>
+	constexpr ComponentMask ComponentBit() noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "components are moved between chunks with memcpy");
+		static_assert(T::Id < EntityMaxComponents, "component id out of range");
+		return ComponentMask(1) << T::Id;
+	}
+
+	template<typename... Ts>
+	constexpr ComponentMask ComponentMaskOf() noexcept
+	{
+		return (ComponentMask(0) | ... | ComponentBit<Ts>());
+	}
+
+	struct EntityColumn
+	{
+		uint32_t Id;
+		uint32_t Offset;
+		uint32_t Size;
+	};
+
+	/// @brief Chunk layout shared by every entity with exactly the same components
+	struct EntityArchetype
+	{
+		ComponentMask Mask;
+		uint32_t Capacity;
+
+		uint32_t EntityOffset;
+		std::vector<EntityColumn> Columns;
+		// column offset by component id, 0 when absent; offset 0 always holds the enable mask
+		std::array<uint16_t, EntityMaxComponents> Offsets;
+
+		// all full but the last
+		std::vector<std::unique_ptr<class EntityChunk>> Chunks;
+	};
+
+	class DLLEXPORT EntityChunk
+	{
+		friend class EntityStore;
+
+	private:
+		EntityArchetype* _archetype;
+		uint8_t* _data;
+		uint32_t _count = 0;
+		uint32_t _enabled = 0;
+
+	public:
+		explicit EntityChunk(EntityArchetype* archetype);
+		EntityChunk(const EntityChunk&) = delete;
+		~EntityChunk() noexcept;
+
+		EntityChunk& operator=(const EntityChunk&) = delete;
+
+	public:
+		[[nodiscard]] uint32_t Count() const noexcept;
+
+		/// @brief Rows with their enable bit set; a chunk with none can be skipped whole
+		[[nodiscard]] uint32_t EnabledCount() const noexcept;
+		[[nodiscard]] bool Enabled(uint32_t row) const noexcept;
+
+		/// @brief One bit per row, ceil(Count() / 64) words
+		[[nodiscard]] const uint64_t* EnabledMask() const noexcept;
+
+		[[nodiscard]] const Entity* Entities() const noexcept;
+		[[nodiscard]] const EntityArchetype& Archetype() const noexcept;
+
+		/// @brief Column of T, nullptr when the archetype lacks it
+		template<typename T>
+		[[nodiscard]] T* Column() const noexcept
+		{
+			ComponentBit<T>();
+			uint16_t offset = _archetype->Offsets[T::Id];
+			return offset ? reinterpret_cast<T*>(_data + offset) : nullptr;
+		}
+
+		/// @brief Call fn(row) for every enabled row in order
+		template<typename F>
+		void EachEnabled(F&& fn) const
+		{
+			const uint64_t* mask = EnabledMask();
+			for (uint32_t w = 0; w * 64 < _count; ++w)
+				for (uint64_t bits = mask[w]; bits; bits &= bits - 1)
+					fn(w * 64 + __builtin_ctzll(bits));
+		}
+	};
+
+	/// @brief Entities grouped by archetype into fixed-size chunks of per-component columns
+	/// @details Adding or removing a component moves the entity's row to another archetype; destroying it
+	/// moves the archetype's last row into the hole, so chunks stay dense. Column pointers and rows are
+	/// only stable until the next structural change. Not thread-safe; Each runs fn on the workers but the
+	/// store itself must not change meanwhile. An Application's store belongs to its render thread while
+	/// Run renders, which reads its chunks while preparing draws; change it then from a System, which is
+	/// also handed the workers to run Each on.
+	class DLLEXPORT EntityStore
+	{
+	private:
+		struct Record
+		{
+			uint32_t Generation;
+			EntityArchetype* Archetype;
+			EntityChunk* Chunk;
+			uint32_t Row;
+		};
+
+		std::array<uint32_t, EntityMaxComponents> _sizes{};
+		std::array<uint32_t, EntityMaxComponents> _alignments{};
+
+		std::vector<std::unique_ptr<EntityArchetype>> _archetypes;
+		std::map<ComponentMask, EntityArchetype*> _lookup;
+
+		// by Entity::Index
+		std::vector<Record> _records;
+		std::vector<uint32_t> _free;
+		uint32_t _count = 0;
+
+		// matching chunks of the running Each
+		std::vector<EntityChunk*> _query;
+
+	private:
+		bool Register(uint32_t id, uint32_t size, uint32_t alignment) noexcept;
+
+		EntityArchetype* Archetype(ComponentMask mask);
+
+		/// @brief Append a row to the archetype's last chunk, opening a new one when full
+		void Allocate(EntityArchetype* archetype, Record& record);
+
+		/// @brief Fill the record's row with the archetype's last row and shrink the archetype by one
+		void Vacate(const Record& record) noexcept;
+
+		/// @brief Move a live entity to the archetype of mask, keeping the components both have
+		bool Migrate(Entity entity, ComponentMask mask);
+
+		Record* Find(Entity entity) noexcept;
+		const Record* Find(Entity entity) const noexcept;
+
+		void* Column(const Record& record, uint32_t id) const noexcept;
+
+		template<typename T>
+		bool Register() noexcept
+		{
+			return Register(T::Id, sizeof(T), alignof(T));
+		}
+
+		template<typename F>
+		void Match(ComponentMask mask, F&& fn) const
+		{
+			for (const auto& archetype: _archetypes)
+				if ((archetype->Mask & mask) == mask)
+					for (const auto& chunk: archetype->Chunks)
+						if (chunk->_count)
+							fn(*chunk);
+		}
+
+	public:
+		EntityStore() noexcept = default;
+		EntityStore(const EntityStore&) = delete;
+		~EntityStore() noexcept;
+
+		EntityStore& operator=(const EntityStore&) = delete;
+
+	public:
+		/// @brief New enabled entity holding exactly the given components
+		/// @return Entity{} if a component conflicts with an earlier registration of its id or does not fit a chunk
+		template<typename... Ts>
+		Entity Create(const Ts&... components)
+		{
+			if (!(Register<Ts>() && ...))
+				return Entity{};
+
+			Entity entity = Create(ComponentMaskOf<Ts...>());
+			if (!entity.Generation)
+				return entity;
+
+			const Record& record = _records[entity.Index];
+			(std::memcpy(Column(record, Ts::Id), &components, sizeof(Ts)), ...);
+			return entity;
+		}
+
+		/// @brief New enabled entity with zeroed components of mask; every id in it must be registered
+		Entity Create(ComponentMask mask);
+
+		void Destroy(Entity entity);
+
+		[[nodiscard]] bool Alive(Entity entity) const noexcept;
+
+		/// @brief Component of a live entity, nullptr if it is dead or lacks T
+		template<typename T>
+		[[nodiscard]] T* Get(Entity entity) const noexcept
+		{
+			ComponentBit<T>();
+			const Record* record = Find(entity);
+			return record ? static_cast<T*>(Column(*record, T::Id)) : nullptr;
+		}
+
+		/// @brief Set a component, moving the entity to the archetype with T first if it lacks it
+		template<typename T>
+		bool Add(Entity entity, const T& component)
+		{
+			if (!Register<T>() || !Find(entity))
+				return false;
+
+			const Record& record = _records[entity.Index];
+			if (!(record.Archetype->Mask & ComponentBit<T>()) && !Migrate(entity, record.Archetype->Mask | ComponentBit<T>()))
+				return false;
+
+			std::memcpy(Column(_records[entity.Index], T::Id), &component, sizeof(T));
+			return true;
+		}
+
+		template<typename T>
+		bool Remove(Entity entity)
+		{
+			const Record* record = Find(entity);
+			if (!record || !(record->Archetype->Mask & ComponentBit<T>()))
+				return false;
+
+			return Migrate(entity, record->Archetype->Mask & ~ComponentBit<T>());
+		}
+
+		/// @brief Flip the entity's bit in its chunk's enable mask; disabled rows are skipped by queries
+		void SetEnabled(Entity entity, bool enabled) noexcept;
+		[[nodiscard]] bool Enabled(Entity entity) const noexcept;
+
+		[[nodiscard]] uint32_t Count() const noexcept;
+
+		/// @brief Chunks holding at least one entity with every component of mask
+		template<typename F>
+		void Chunks(ComponentMask mask, F&& fn) const
+		{
+			Match(mask, std::forward<F>(fn));
+		}
+
+		/// @brief Call fn(chunk, columns...) for every chunk with Ts... that has an enabled row,
+		/// contiguous runs of chunks per worker
+		template<typename... Ts, typename F>
+		void Each(sys::workers& workers, F&& fn)
+		{
+			_query.clear();
+			Match(ComponentMaskOf<Ts...>(), [this](EntityChunk& chunk)
+			{
+				if (chunk._enabled)
+					_query.push_back(&chunk);
+			});
+
+			workers.run([this, &workers, &fn](uint32_t i)
+			{
+				uint32_t local = _query.size() / workers.size();
+				uint32_t remain = _query.size() % workers.size();
+				uint32_t offset = local * i + std::min(i, remain);
+				if (i < remain)
+					local++;
+
+				for (uint32_t j = offset; j < offset + local; ++j)
+					fn(*_query[j], _query[j]->template Column<Ts>()...);
+			});
+		}
+	};
+}
+
+#endif //PHUSIS_ENTITYSTORE_HXX
@@ -2,6 +2,8 @@
 #define PHUSIS_CONSTANTBLOCK_HXX
 
 #include "fw.hxx"
+#include "pre/glm.hxx"
+#include "phusis/meshlet.hxx"
 
 namespace Phusis::Internal
 {
@@ -10,11 +12,96 @@ namespace Phusis::Internal
 		const glm::mat4 MVP;
 		const glm::vec4 Color;
 
-		explicit ConstantBlock(glm::mat4 mvp, glm::vec4 color) noexcept
-				: MVP(mvp), Color(color)
+		explicit ConstantBlock(const pre::mat4f& mvp, glm::vec4 color) noexcept
+				: MVP(pre::to_glm(mvp)), Color(color)
 		{
 		}
 	};
+
+	// push-constant block as the vertex shader sees it: mat4 at 0, vec4 at 64 (std430)
+	static_assert(offsetof(ConstantBlock, MVP) == 0);
+	static_assert(offsetof(ConstantBlock, Color) == 64);
+	static_assert(sizeof(ConstantBlock) == 80);
+
+	// meshlets handled by one task workgroup
+	constexpr uint32_t MeshletTaskGroup = 32;
+
+	/// @brief Push constants of the task / mesh shader path; exactly the 128 bytes every device guarantees.
+	/// Positions are dequantized in the mesh shader since meshlet bounds live in object space;
+	/// the eye for cone tests is inverse(MVP) * (0, 0, 1, 0) after the perspective divide.
+	struct MeshletConstantBlock
+	{
+		// object to clip, without Mesh::Dequantization
+		const glm::mat4 MVP;
+		const glm::vec4 Color;
+
+		// MeshletLevel::Address and the byte offsets from it
+		const VkDeviceAddress Address;
+		const uint32_t Records;
+		const uint32_t Indices;
+		const uint32_t Positions;
+		const uint32_t Count;
+
+		// Mesh::Dequantization as per-axis scale and offset
+		const float Scale[3];
+		const float Offset[3];
+
+		explicit MeshletConstantBlock(const pre::mat4f& mvp, glm::vec4 color, const MeshletLevel& level, const glm::mat4& dequantization) noexcept
+				: MVP(pre::to_glm(mvp)),
+				  Color(color),
+				  Address(level.Address),
+				  Records(level.Records),
+				  Indices(level.Indices),
+				  Positions(level.Positions),
+				  Count(level.Count),
+				  Scale{ dequantization[0][0], dequantization[1][1], dequantization[2][2] },
+				  Offset{ dequantization[3][0], dequantization[3][1], dequantization[3][2] }
+		{
+		}
+	};
+
+	static_assert(offsetof(MeshletConstantBlock, Address) == 80);
+	static_assert(offsetof(MeshletConstantBlock, Scale) == 104);
+	static_assert(sizeof(MeshletConstantBlock) == 128);
+
+	/*
+	 * bindless path (VK_EXT_descriptor_indexing): one global set per frame in flight
+	 * | binding 0 : BindlessObject[] storage buffer | binding 1 : sampler2D[] partially bound, variable count |
+	 * binding 0 covers the flight's upload ring region; the vertex shader reads its object at gl_InstanceIndex,
+	 * so a draw passes nothing but firstInstance and consecutive objects of one mesh become a single instanced draw
+	 */
+	constexpr uint32_t BindlessObjectBinding = 0;
+	constexpr uint32_t BindlessTextureBinding = 1;
+
+	// upper bound; the device's update-after-bind limits may lower it
+	constexpr uint32_t BindlessTextureCapacity = 1u << 14;
+
+	/// @brief One object in the bindless object buffer (std430)
+	struct BindlessObject
+	{
+		// object to world, with Mesh::Dequantization applied
+		glm::mat4 Model;
+		glm::vec4 Color;
+		// texture index into binding 1
+		uint32_t Material;
+		uint32_t Reserved[3];
+	};
+
+	static_assert(offsetof(BindlessObject, Color) == 64 && offsetof(BindlessObject, Material) == 80);
+	static_assert(sizeof(BindlessObject) == 96);
+
+	/// @brief Push constants of the bindless path, pushed once per command buffer
+	struct BindlessConstantBlock
+	{
+		const glm::mat4 ViewProjection;
+
+		explicit BindlessConstantBlock(const pre::mat4f& viewProjection) noexcept
+				: ViewProjection(pre::to_glm(viewProjection))
+		{
+		}
+	};
+
+	static_assert(sizeof(BindlessConstantBlock) == 64);
 }
 
 #endif //PHUSIS_CONSTANTBLOCK_HXX
@@ -0,0 +1,39 @@
+#ifndef PHUSIS_DRAWSORT_HXX
+#define PHUSIS_DRAWSORT_HXX
+
+#include "fw.hxx"
+#include "phusis/engineobject.hxx"
+#include "sys/arena.hxx"
+
+namespace Phusis::Internal
+{
+	/*
+	 * sort key layout (msb -> lsb)
+	 * | pipeline : 10 | material : 14 | mesh : 16 | depth : 24 |
+	 * state that is most expensive to change sits highest; opaque depth is front-to-back
+	 */
+	struct VkDrawItem
+	{
+		uint64_t Key;
+		uint32_t Index;
+		// index level of the object's mesh to draw
+		uint32_t Lod;
+	};
+
+	constexpr uint64_t DisabledDrawKey = UINT64_MAX;
+
+	uint64_t MakeSortKey(VkPipeline pipeline, uint32_t material, const Mesh& mesh, float depth) noexcept;
+
+	/// @brief Stable LSD radix sort by Key; byte passes that are constant over all keys are skipped
+	/// @param items items to sort, sorted in place
+	/// @param scratch scratch storage, resized to items
+	/// @param partitions number of parallel partitions used for histogram and scatter
+	/// @param arena frame arena for the per-partition histograms
+	void SortDraws(
+			std::vector<VkDrawItem>& items,
+			std::vector<VkDrawItem>& scratch,
+			uint32_t partitions,
+			sys::arena& arena) noexcept;
+}
+
+#endif //PHUSIS_DRAWSORT_HXX
@@ -0,0 +1,163 @@
+#ifndef PHUSIS_FRAMECAPTURE_HXX
+#define PHUSIS_FRAMECAPTURE_HXX
+
+#include "fw.hxx"
+#include "phusis/engineobject.hxx"
+#include <fstream>
+#include <type_traits>
+
+namespace Phusis::Internal
+{
+	struct VkBoundData;
+	struct VkFrameTimings;
+
+	/*
+	 * frame capture, written by FrameRecorder; little-endian, read front to back
+	 * | FrameCaptureHeader | frame | frame | ... |
+	 * frame: | FrameCaptureFrame | FrameCaptureObject x ObjectCount | uint32 parent x ObjectCount | FrameCaptureDelta x Deltas |
+	 * the object table and parents are only present when their flag is set, i.e. on the first frame and
+	 * whenever they changed; deltas hold the transforms that differ from the frame before
+	 */
+	constexpr uint32_t FrameCaptureMagic = 0x50434850; // "PHCP"
+	constexpr uint32_t FrameCaptureVersion = 1;
+
+	constexpr uint32_t FrameCaptureObjects = 1u << 0;
+	constexpr uint32_t FrameCaptureParents = 1u << 1;
+
+	struct FrameCaptureHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		// 0 when the capture was never closed; frames then run to the end of the file
+		uint32_t Frames;
+		uint32_t Reserved;
+	};
+
+	struct FrameCaptureFrame
+	{
+		uint32_t Width;
+		uint32_t Height;
+		// column-major
+		float View[16];
+		float Projection[16];
+
+		uint32_t ObjectCount;
+		uint32_t Flags;
+		uint32_t Deltas;
+		uint32_t Reserved;
+
+		// the captured frame's own timings in microseconds, to compare a replay against
+		float Prepare;
+		float Record;
+		float Submit;
+		float Gpu;
+	};
+
+	struct FrameCaptureObject
+	{
+		// distinct meshes and pipelines numbered in order of first appearance; pipeline 0 is the default
+		uint32_t Mesh;
+		uint32_t Pipeline;
+		uint32_t Material;
+		uint32_t Reserved;
+	};
+
+	struct FrameCaptureDelta
+	{
+		uint32_t Index;
+		uint32_t Reserved[3];
+		EngineObjectTransform Transform;
+	};
+
+	// sections follow each other unpadded, so nothing in them may need more than 4-byte alignment
+	static_assert(std::is_trivially_copyable_v<FrameCaptureFrame> && sizeof(FrameCaptureFrame) == 168);
+	static_assert(std::is_trivially_copyable_v<FrameCaptureDelta> && sizeof(FrameCaptureDelta) == 112 && alignof(FrameCaptureDelta) == 4);
+
+	/// @brief Writes what each update consumed: size, camera, objects, parent links and changed transforms
+	/// @details Meshes and pipelines are kept as identities only, so a replay draws its own stand-ins.
+	/// Entities are not captured. Each frame is diffed against the previous one in full, which is cheap
+	/// next to the update but not free; capture a window around the problem rather than a whole session.
+	class DLLEXPORT FrameRecorder
+	{
+	private:
+		std::ofstream _out;
+		std::filesystem::path _path;
+		uint32_t _frames = 0;
+		uint32_t _limit = 0;
+
+		// the object vector last written as a table; its elements are immutable, so only its size and
+		// storage can change
+		const void* _objects = nullptr;
+		size_t _objectCount = 0;
+
+		std::map<std::pair<VkBuffer, VkDeviceSize>, uint32_t> _meshes;
+		std::map<VkPipeline, uint32_t> _pipelines;
+
+		// state as of the last written frame
+		std::vector<EngineObjectTransform> _transforms;
+		std::vector<uint32_t> _parents;
+
+		// scratch, kept across frames
+		std::vector<FrameCaptureObject> _table;
+		std::vector<uint32_t> _links;
+		std::vector<FrameCaptureDelta> _deltas;
+
+	private:
+		bool Write(const void* data, size_t size) noexcept;
+
+	public:
+		FrameRecorder() noexcept = default;
+		FrameRecorder(const FrameRecorder&) = delete;
+		~FrameRecorder() noexcept;
+
+		FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+	public:
+		/// @brief Start a capture, ending any running one
+		/// @param frames closes the capture after this many frames; 0 records until Close
+		bool Open(const std::filesystem::path& path, uint32_t frames) noexcept;
+		void Close() noexcept;
+
+		[[nodiscard]] bool Active() const noexcept;
+
+		/// @brief Append the frame bound for the update that just ran, with that update's timings
+		void Record(const VkBoundData& bound, const VkFrameTimings& timings);
+	};
+
+	/// @brief A capture loaded whole, applied frame by frame onto a scene of stand-in meshes
+	class DLLEXPORT FrameReplay
+	{
+	private:
+		std::vector<uint8_t> _data;
+		// of each FrameCaptureFrame in _data
+		std::vector<size_t> _frames;
+
+		uint32_t _meshes = 0;
+		uint32_t _pipelines = 0;
+		bool _hierarchical = false;
+
+	public:
+		/// @brief Read and validate a capture; false on I/O errors, bad magic, version or bounds
+		bool Open(const std::filesystem::path& path) noexcept;
+
+		[[nodiscard]] uint32_t Count() const noexcept;
+		[[nodiscard]] const FrameCaptureFrame& Frame(uint32_t idx) const noexcept;
+
+		/// @brief Distinct meshes and non-default pipelines the objects refer to
+		[[nodiscard]] uint32_t MeshCount() const noexcept;
+		[[nodiscard]] uint32_t PipelineCount() const noexcept;
+
+		/// @brief Whether the capture has parent links, i.e. the replay needs bound.Hierarchy
+		[[nodiscard]] bool Hierarchical() const noexcept;
+
+		/// @brief Bring bound to frame idx; deltas build on the frame before, so frames are applied in order
+		/// from 0, which restarts everything
+		/// @param objects the vector bound.Objects refers to; rebuilt when the frame carries a table
+		/// @param meshes at least MeshCount() stand-ins
+		/// @param pipelines stand-ins for pipelines 1..; missing ones draw with the default pipeline
+		void Apply(uint32_t idx, VkBoundData& bound, std::vector<EngineObjectData>& objects,
+				const std::vector<Mesh>& meshes, const std::vector<VkPipeline>& pipelines) const;
+	};
+}
+
+#endif //PHUSIS_FRAMECAPTURE_HXX
@@ -0,0 +1,34 @@
+#ifndef PHUSIS_LODSELECT_HXX
+#define PHUSIS_LODSELECT_HXX
+
+#include "fw.hxx"
+#include "phusis/engineobject.hxx"
+
+namespace Phusis::Internal
+{
+	struct LodPolicy
+	{
+		// largest tolerated projected error, in pixels
+		float Threshold = 1.f;
+		// fraction of Threshold a level must move past before switching; suppresses popping at the boundary
+		float Hysteresis = .25f;
+	};
+
+	/// @brief Projected size in pixels of one object-space unit at each object's distance.
+	/// Uses the largest axis scale of the transform; 4 objects per iteration.
+	/// @param matrices world matrices, stride bytes apart, so both dense arrays and EngineObjectTransform::Rotation fit
+	/// @param focal pixels per unit at distance 1, i.e. Projection[1][1] * height / 2
+	void LodScales(
+			const glm::mat4* matrices,
+			size_t stride,
+			uint32_t n,
+			const glm::mat4& view,
+			float focal,
+			float* scales) noexcept;
+
+	/// @brief Coarsest level whose error projects under the threshold, kept at previous while
+	/// previous stays inside the hysteresis band
+	uint32_t SelectLod(const Mesh& mesh, float scale, uint32_t previous, const LodPolicy& policy) noexcept;
+}
+
+#endif //PHUSIS_LODSELECT_HXX
@@ -0,0 +1,36 @@
+#ifndef PHUSIS_MESHLETCULL_HXX
+#define PHUSIS_MESHLETCULL_HXX
+
+#include "fw.hxx"
+#include "phusis/meshlet.hxx"
+
+namespace Phusis::Internal
+{
+	/// @brief Culling volume in one object's space
+	struct MeshletFrustum
+	{
+		// left, right, bottom, top, near, far; normalized, inside where dot(plane, p) >= 0
+		glm::vec4 Planes[6];
+		glm::vec3 Camera;
+	};
+
+	/// @brief Contiguous surviving meshlets, one indexed draw
+	struct MeshletRun
+	{
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+		// meshlets merged into the run
+		uint32_t Count;
+	};
+
+	/// @brief Object-space frustum and eye; modelView must not include Mesh::Dequantization.
+	/// Cone tests assume the model transform keeps angles, i.e. has no non-uniform scale.
+	MeshletFrustum MakeMeshletFrustum(const glm::mat4& projection, const glm::mat4& modelView) noexcept;
+
+	/// @brief Frustum and normal-cone test per meshlet; survivors whose index ranges touch are merged
+	/// @param runs at least n entries
+	/// @return number of runs written
+	uint32_t CullMeshlets(const Meshlet* meshlets, uint32_t n, const MeshletFrustum& frustum, MeshletRun* runs) noexcept;
+}
+
+#endif //PHUSIS_MESHLETCULL_HXX
@@ -0,0 +1,43 @@
+#ifndef PHUSIS_VKCOMMANDPOOL_HXX
+#define PHUSIS_VKCOMMANDPOOL_HXX
+
+#include "fw.hxx"
+
+namespace Phusis::Internal
+{
+	/// @brief Secondary command-buffers owned by one thread for one frame in flight.
+	/// Buffers are recycled by resetting the whole pool once the frame has retired;
+	/// capacity grows geometrically and is never given back while the pool is alive.
+	/// Debug builds bind the pool to the first thread that uses it after Initialize and
+	/// assert on access from any other; Initialize and Release are exempt.
+	class VkCommandBufferPool
+	{
+	private:
+		VkDevice _device = nullptr;
+		VkCommandPool _pool = nullptr;
+
+		std::vector<VkCommandBuffer> _buffers{};
+		uint32_t _used = 0;
+
+#ifndef NDEBUG
+		std::thread::id _owner{};
+#endif
+
+	private:
+		void CheckAffinity() noexcept;
+
+	public:
+		bool Initialize(VkDevice device, uint32_t queueIdx) noexcept;
+		void Release() noexcept;
+
+		bool Reset() noexcept;
+		bool Reserve(uint32_t n) noexcept;
+
+		VkCommandBuffer Acquire() noexcept;
+
+		[[nodiscard]] uint32_t Capacity() const noexcept;
+		[[nodiscard]] uint32_t Used() const noexcept;
+	};
+}
+
+#endif //PHUSIS_VKCOMMANDPOOL_HXX
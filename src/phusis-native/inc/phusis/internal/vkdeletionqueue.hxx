@@ -0,0 +1,63 @@
+#ifndef PHUSIS_VKDELETIONQUEUE_HXX
+#define PHUSIS_VKDELETIONQUEUE_HXX
+
+#include "fw.hxx"
+
+namespace Phusis::Internal
+{
+	struct VkRetiredHandle
+	{
+		// frame serial or timeline value the handle was last used by
+		uint64_t Value;
+		VkObjectType Type;
+		uint64_t Handle;
+	};
+
+	/// @brief Vulkan handles waiting for the GPU to pass the last frame that referenced them.
+	/// Values are expected to be non-decreasing in retirement order; an out-of-order value only
+	/// delays the handles behind it, never frees anything early. Retire is safe from any thread;
+	/// Advance, Collect and Flush belong to the frame loop.
+	class VkDeletionQueue
+	{
+	private:
+		VkDevice _device = nullptr;
+
+		// tag for handles retired without an explicit value; the next frame to be submitted
+		std::atomic<uint64_t> _recording{ 1 };
+
+		mutable std::mutex _lock;
+		std::deque<VkRetiredHandle> _pending{};
+
+	private:
+		void Retire(VkObjectType type, uint64_t handle, uint64_t value);
+		void Destroy(const VkRetiredHandle& retired) noexcept;
+
+	public:
+		void Initialize(VkDevice device) noexcept;
+
+		/// @brief Set the serial of the frame being recorded; handles retired from now on live until it completes
+		void Advance(uint64_t frame) noexcept;
+
+		void Retire(VkBuffer buffer);
+		void Retire(VkDeviceMemory memory);
+		void Retire(VkImage image);
+		void Retire(VkImageView view);
+		void Retire(VkFramebuffer framebuffer);
+		void Retire(VkPipeline pipeline);
+		void Retire(VkSwapchainKHR swapchain);
+
+		/// @brief Retire against an explicit frame serial or timeline-semaphore value
+		void Retire(VkBuffer buffer, uint64_t value);
+		void Retire(VkDeviceMemory memory, uint64_t value);
+
+		/// @brief Destroy everything whose value is at or below completed
+		void Collect(uint64_t completed) noexcept;
+
+		/// @brief Destroy everything; the device must be idle
+		void Flush() noexcept;
+
+		[[nodiscard]] size_t Pending() const noexcept;
+	};
+}
+
+#endif //PHUSIS_VKDELETIONQUEUE_HXX
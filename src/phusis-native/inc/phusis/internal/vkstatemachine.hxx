@@ -3,9 +3,22 @@
 
 #include "fw.hxx"
 #include "phusis/engineobject.hxx"
+#include "phusis/entitystore.hxx"
+#include "phusis/scenechannel.hxx"
+#include "phusis/transformhierarchy.hxx"
+#include "phusis/internal/constantblock.hxx"
+#include "phusis/internal/vkcommandpool.hxx"
+#include "phusis/internal/vkuploadring.hxx"
+#include "phusis/internal/drawsort.hxx"
+#include "phusis/internal/lodselect.hxx"
+#include "phusis/internal/meshletcull.hxx"
+#include "sys/arena.hxx"
+#include "sys/workers.hxx"
 
 namespace Phusis::Internal
 {
+	constexpr uint32_t FramesInFlight = 2;
+
 	struct VkBoundData
 	{
 		uint32_t Width;
@@ -14,6 +27,17 @@ namespace Phusis::Internal
 		glm::mat4 Projection;
 
 		const std::vector<EngineObjectData>& Objects;
+		// same length as Objects
+		std::vector<EngineObjectTransform>& Transforms;
+
+		// optional; drained into Transforms at the start of each update
+		SceneChannel* Channel;
+
+		// optional; makes each Rotation relative to the object's parent, updated after Channel is drained
+		TransformHierarchy* Hierarchy;
+
+		// optional; entities with the object components are drawn alongside Objects
+		EntityStore* Entities;
 	};
 
 	struct VkRendererInheritance
@@ -24,36 +48,223 @@ namespace Phusis::Internal
 		uint32_t QueueIdx;
 
 		VkCommandPool Pool;
-		VkCommandBuffer Buffer;
 		VkRenderPass RenderPass;
 
 		VkPipeline Pipeline;
 		VkPipelineLayout PipelineLayout;
 
 		VkClearColorValue ClearColor;
+
+		// VK_KHR_dynamic_rendering + VK_KHR_synchronization2; render-pass path if false
+		bool DynamicRendering;
+		VkFormat ColorFormat;
+		VkFormat DepthFormat;
+
+		PFN_vkCmdBeginRenderingKHR CmdBeginRendering;
+		PFN_vkCmdEndRenderingKHR CmdEndRendering;
+		PFN_vkCmdPipelineBarrier2KHR CmdPipelineBarrier2;
+
+		// VK_EXT_mesh_shader; levels with device meshlets of objects on the default pipeline are drawn
+		// as task dispatches when all three are set, see MeshletConstantBlock
+		VkPipeline MeshPipeline;
+		VkPipelineLayout MeshPipelineLayout;
+		PFN_vkCmdDrawMeshTasksEXT CmdDrawMeshTasks;
+
+		// optional; one region per flight, reset once the flight retires and flushed before submission
+		VkUploadRing* Upload;
+
+		// with Upload, the meshlet runs culled on the workers are written there as indirect commands and drawn
+		// by one vkCmdDrawIndexedIndirect of at most this many; 0 draws each run directly
+		uint32_t DrawIndirectCount;
+
+		// VK_EXT_descriptor_indexing; other objects on the default pipeline are drawn with BindlessPipeline
+		// when it, the layout and Upload are set, reading their BindlessObject from the flight's region
+		// through the flight's set
+		VkPipeline BindlessPipeline;
+		VkPipelineLayout BindlessPipelineLayout;
+		std::array<VkDescriptorSet, FramesInFlight> BindlessSets;
+
+		// nanoseconds per timestamp tick, see VkFrameTimings::Gpu; 0 when the queue writes no timestamps
+		float TimestampPeriod;
+		// timestampValidBits of the queue family; the counter wraps past them
+		uint32_t TimestampBits;
+	};
+
+	struct VkRecordStats
+	{
+		uint32_t Draws;
+		uint64_t Triangles;
+
+		// meshlets tested on the workers or dispatched to task shaders, and those culled on the workers
+		uint32_t Clusters;
+		uint32_t ClustersCulled;
+
+		// bindless objects folded into the instanced draw of the object before them
+		uint32_t Instances;
+
+		uint32_t PipelineBinds;
+		uint32_t VertexBinds;
+		uint32_t IndexBinds;
+
+		// binds skipped because the state was already bound
+		uint32_t RedundantPipelineBinds;
+		uint32_t RedundantVertexBinds;
+		uint32_t RedundantIndexBinds;
+
+		// secondaries recorded and worker arena bytes taken for them
+		uint32_t CommandBuffers;
+		uint64_t ArenaBytes;
+
+		// heap allocations during the whole update; 0 unless built with PHUSIS_COUNT_ALLOCATIONS
+		uint64_t Allocations;
+
+		VkRecordStats& operator+=(const VkRecordStats& other) noexcept
+		{
+			Draws += other.Draws;
+			Triangles += other.Triangles;
+			Clusters += other.Clusters;
+			ClustersCulled += other.ClustersCulled;
+			Instances += other.Instances;
+			PipelineBinds += other.PipelineBinds;
+			VertexBinds += other.VertexBinds;
+			IndexBinds += other.IndexBinds;
+			RedundantPipelineBinds += other.RedundantPipelineBinds;
+			RedundantVertexBinds += other.RedundantVertexBinds;
+			RedundantIndexBinds += other.RedundantIndexBinds;
+			CommandBuffers += other.CommandBuffers;
+			ArenaBytes += other.ArenaBytes;
+			Allocations += other.Allocations;
+			return *this;
+		}
+	};
+
+	/// @brief Time of the last update's phases, in microseconds
+	struct VkFrameTimings
+	{
+		// fence wait for the reused flight
+		double Wait;
+		// scene channel, transform hierarchy, sort keys and sort
+		double Prepare;
+		// secondary recording across all threads
+		double Record;
+		// primary end and queue submission
+		double Submit;
+		// input sample to present, 0 when the frame was not presented or input was not sampled
+		double Latency;
+		// GPU execution of the primary of the last retired flight, FramesInFlight frames old; 0 without timestamps
+		double Gpu;
+	};
+
+	/// @brief Bindless records of one worker's slice of the sorted draws, taken from the upload ring
+	struct VkObjectBlock
+	{
+		BindlessObject* Data;
+		// instance index of Data[0] in the flight's region
+		uint32_t Base;
+		// draw slot of Data[0]; slots past First + Count take the push-constant path
+		uint32_t First;
+		uint32_t Count;
 	};
 
 	struct VkThreadData
 	{
 		uint32_t Index;
-		VkCommandPool Pool;
+
+		VkRecordStats Stats;
+		VkObjectBlock Objects;
+
+		std::array<VkCommandBufferPool, FramesInFlight> Pools;
+		std::array<sys::arena, FramesInFlight> Arenas;
+
+		// recorded for the current frame; capacity is kept across frames
 		std::vector<VkCommandBuffer> Buffers;
 	};
 
+	struct VkFlightData
+	{
+		VkCommandBuffer Buffer;
+		VkFence Fence;
+
+		// swapchain image acquired / rendering done, used when the frame is presented
+		VkSemaphore Acquired;
+		VkSemaphore Rendered;
+
+		// FrameNumber() after this flight's last submission; 0 if never submitted
+		uint64_t Serial;
+
+		// timestamps at the start and end of the primary; nullptr without TimestampPeriod
+		VkQueryPool Queries;
+	};
+
 	struct VkFrameData
 	{
 		VkFramebuffer Framebuffer;
+
+		VkImage Image;
+		VkImageView View;
+
+		// optional; one image of DepthFormat, shared by every swapchain image
+		VkImage DepthImage;
+		VkImageView DepthView;
 	};
 
 	struct VkFrameDataLocal
 	{
 		VkCommandBufferInheritanceInfo Inheritance;
+		VkCommandBufferInheritanceRenderingInfoKHR Rendering;
 	};
 
-	enum class BufferDistributionStrategy
+	enum class RecordingMode
 	{
-		Optimal,
-		Uniform
+		PerObject,
+		Batched
+	};
+
+	// VkDrawItem::Index of an entity: this bit, the chunk's place in the frame's chunk list, then the row
+	constexpr uint32_t EntityDrawBit = 1u << 31;
+
+	/// @brief Columns of one entity chunk drawn this frame
+	struct VkEntityChunk
+	{
+		const EntityChunk* Chunk;
+		const ObjectTransform* Transforms;
+		const ObjectColor* Colors;
+		const ObjectRenderable* Renderables;
+		ObjectLod* Lods;
+
+		// draw slot of the chunk's first enabled row
+		uint32_t First;
+	};
+
+	/// @brief What recording reads of one object, wherever it is stored; nothing is copied
+	struct VkObjectView
+	{
+		const struct Mesh* Mesh;
+		// nullptr selects the default pipeline
+		VkPipeline Pipeline;
+		const glm::mat4* World;
+		const glm::vec4* Color;
+		uint32_t Material;
+	};
+
+	struct VkRecordState
+	{
+		VkCommandBuffer Buffer;
+		VkRecordStats* Stats;
+		sys::arena* Arena;
+		const VkObjectBlock* Objects;
+
+		VkPipeline Pipeline;
+		const struct Mesh* Mesh;
+		VkBuffer IndexBuffer;
+		VkDeviceSize IndexOffset;
+
+		// bindless: set and push constants bound for the current layout, and the pending instanced draw
+		// by instance index
+		bool Bindless;
+		uint32_t InstanceFirst;
+		uint32_t InstanceCount;
+		uint32_t InstanceIndices;
 	};
 
 	class VkStateMachine
@@ -65,31 +276,157 @@ namespace Phusis::Internal
 
 		VkFrameDataLocal _local;
 
+		// _threads[i] belongs to worker i; only that worker touches its pools and arenas
 		std::vector<VkThreadData> _threads;
-		std::vector<VkCommandBuffer> _buffer;
+		sys::workers _workers;
+
+		// enabled objects in sort-key order, rebuilt every frame
+		std::vector<VkDrawItem> _draws;
+		std::vector<VkDrawItem> _drawsScratch;
+
+		// entity chunks with an enabled row, rebuilt every frame
+		std::vector<VkEntityChunk> _chunks;
 
-		uint32_t _knownTargetCount;
-		clock_t _previousT;
-		clock_t _deltaT;
+		// per object, indexed like Objects: level drawn last frame, this frame's projected scale and view-space position
+		std::vector<uint8_t> _lods;
+		std::vector<float> _lodScales;
+		std::vector<pre::vec4f> _eyes;
 
-		VkFence _renderFence;
+		// this frame's camera as the record paths consume it
+		pre::mat4f _view;
+		pre::mat4f _viewProjection;
+		LodPolicy _lodPolicy{};
+		bool _clusterCulling = true;
+
+		VkRecordStats _stats{};
+		VkFrameTimings _timings{};
+
+		std::array<VkFlightData, FramesInFlight> _flights{};
+		uint32_t _flight = 0;
+		uint64_t _frameNumber = 0;
+		uint64_t _completed = 0;
+
+		// set by Acquire, consumed by Submit and Present
+		bool _acquired = false;
+		uint32_t _submitted = 0;
+		std::chrono::steady_clock::time_point _input{};
+
+		// main-thread scratch; workers use VkThreadData::Arenas
+		std::array<sys::arena, FramesInFlight> _arenas;
+
+		RecordingMode _mode;
+
+		// objects and entities of the last update; an unchanged count marks a steady-state frame
+		uint32_t _knownTargetCount = 0;
+		clock_t _previousT = 0;
+		clock_t _deltaT = 0;
 
 	private:
 		bool PrepareSecondaryPools();
-		bool PrepareCommandBuffers(uint32_t idx, uint32_t n);
-		bool DistributeBuffers(int32_t update, BufferDistributionStrategy strategy);
+		bool PrepareFlights();
+		/// @brief Grow the worker's pool for a slice of n draws
+		bool PrepareCommandBuffers(uint32_t n);
+
+		bool WaitFlight();
+
+		sys::arena& FrameArena() noexcept;
+
+		/// @brief World matrix of an object: the hierarchy's output if one is bound, else its Rotation
+		const glm::mat4& World(uint32_t idx) const noexcept;
+
+		/// @brief Object or entity behind a VkDrawItem::Index
+		VkObjectView View(uint32_t index) const noexcept;
+
+		/// @brief Per-thread data of the calling worker
+		VkThreadData& Local() noexcept;
+
+		void PrepareDraws();
+		void PrepareEntityDraws(uint32_t begin, uint32_t end, float focal, uint32_t& count);
 
 		bool BatchBuffer();
-		bool BatchBufferLocal(uint32_t idx, uint32_t offset, uint32_t size);
+		bool BatchBufferLocal(uint32_t offset, uint32_t size);
+
+		/// @brief Meshlets of the level if it has any
+		static const MeshletLevel* Clusters(const Mesh& mesh, uint32_t lod) noexcept;
+
+		/// @brief Whether the level goes through the task / mesh shader path
+		bool MeshTasks(const Mesh& mesh, VkPipeline pipeline, uint32_t lod) const noexcept;
+		/// @brief Whether the level is drawn with BindlessPipeline, given a record for its slot
+		bool Bindless(const Mesh& mesh, VkPipeline pipeline, uint32_t lod) const noexcept;
+		VkPipeline DrawPipeline(const Mesh& mesh, VkPipeline pipeline, uint32_t lod) const noexcept;
+
+		/// @brief Sort key of a draw; bindless draws ignore the material, which the shader looks up
+		uint64_t DrawKey(const Mesh& mesh, VkPipeline pipeline, uint32_t material, uint32_t lod, float depth) const noexcept;
+
+		bool BeginSecondary(VkRecordState& state);
+		/// @param slot position of the draw in the sorted list
+		void RecordObject(VkRecordState& state, const VkObjectView& object, uint32_t lod, uint32_t slot);
+		void RecordMeshTasks(VkRecordState& state, const VkObjectView& object, uint32_t lod);
+
+		/// @brief Record the pending instanced draw, if any
+		void FlushInstances(VkRecordState& state);
+		bool EndSecondary(VkRecordState& state);
+
+		void PrepareInheritance();
+
+		void BeginRendering();
+		void EndRendering();
 
 		bool BeginDraw();
-		bool EndDraw();
+		/// @param execute false closes the primary without the secondaries, whose recording failed
+		bool EndDraw(bool execute);
 
 		bool Submit();
 
 	public:
+		explicit VkStateMachine(
+				const VkRendererInheritance& inheritance,
+				uint32_t threads = std::thread::hardware_concurrency(),
+				RecordingMode mode = RecordingMode::Batched) noexcept;
+
+		~VkStateMachine() noexcept;
+
+		/// @brief Set the scene and target for the following updates; both must outlive them
+		void Bind(const VkBoundData* bound, const VkFrameData* frame) noexcept;
+
+		void SetLodPolicy(const LodPolicy& policy) noexcept;
+
+		/// @brief Test meshlets against the frustum and their normal cones while recording; on by default
+		void SetClusterCulling(bool enabled) noexcept;
+
 		void Start();
-		void Update();
+
+		/// @brief Record and submit a frame for the bound scene
+		/// @return false when the device failed the frame's fence or submission; nothing may be presented then
+		bool Update();
+
+		/// @brief Wait until frame N-2 has retired; call right before sampling input so the
+		/// CPU never runs more than one frame ahead of the GPU with stale input
+		bool WaitLatency();
+
+		/// @brief Mark the input sample the next presented frame is built from
+		/// @param time when the oldest input the frame reacts to arrived
+		void SampleInput(std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now()) noexcept;
+
+		/// @brief Acquire the next swapchain image; the following Update renders after it is available
+		VkResult Acquire(VkSwapchainKHR swapchain, uint32_t& image);
+
+		/// @brief Present the image rendered by the last Update
+		VkResult Present(VkSwapchainKHR swapchain, uint32_t image);
+
+		/// @brief The recording workers; idle between updates, when the caller may run its own work on them
+		[[nodiscard]] sys::workers& Workers() noexcept;
+
+		/// @brief Bind and draw counts of the last recorded frame
+		[[nodiscard]] const VkRecordStats& Statistics() const noexcept;
+
+		[[nodiscard]] const VkFrameTimings& Timings() const noexcept;
+
+		/// @brief Frames submitted so far; after WaitLatency every frame below FrameNumber() - 1 has retired
+		[[nodiscard]] uint64_t FrameNumber() const noexcept;
+
+		/// @brief Highest frame serial at or below which every frame has finished on the GPU; polls, never blocks
+		[[nodiscard]] uint64_t CompletedFrames() noexcept;
 	};
 }
 
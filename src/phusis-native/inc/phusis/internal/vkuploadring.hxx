@@ -0,0 +1,95 @@
+#ifndef PHUSIS_VKUPLOADRING_HXX
+#define PHUSIS_VKUPLOADRING_HXX
+
+#include "fw.hxx"
+#include "pre/simd.hxx"
+
+namespace Phusis::Internal
+{
+	struct VkUploadAllocation
+	{
+		// nullptr when the region is full
+		uint8_t* Data;
+		// from the start of the ring's buffer
+		VkDeviceSize Offset;
+	};
+
+	/// @brief Host-visible buffer mapped for its whole life, one region per frame in flight
+	/// @details Each region is bump-allocated from an atomic head, so workers take memory concurrently while
+	/// recording without locks or API calls. A region is reset once its flight has retired and, on
+	/// non-coherent memory, flushed with a single range before the frame is submitted. Allocations stay
+	/// valid until the same flight comes around again.
+	class VkUploadRing
+	{
+	private:
+		VkDevice _device = nullptr;
+		VkBuffer _buffer = nullptr;
+		VkDeviceMemory _memory = nullptr;
+		uint8_t* _mapped = nullptr;
+
+		VkDeviceSize _region = 0;
+		uint32_t _regions = 0;
+		uint32_t _flight = 0;
+
+		bool _coherent = true;
+		VkDeviceSize _atom = 1;
+
+		// bytes taken from the current region; workers race on it, so it gets a line of its own
+		alignas(64) std::atomic<VkDeviceSize> _head = 0;
+
+	public:
+		VkUploadRing() noexcept = default;
+		VkUploadRing(const VkUploadRing&) = delete;
+		~VkUploadRing() noexcept;
+
+		VkUploadRing& operator=(const VkUploadRing&) = delete;
+
+	public:
+		/// @brief Create and map regions * region bytes; prefers device-local, host-coherent memory
+		/// @param region rounded up so every region starts on the device's offset alignments
+		bool Initialize(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize region, uint32_t regions, VkBufferUsageFlags usage) noexcept;
+		void Release() noexcept;
+
+		/// @brief Start allocating from the flight's region; everything allocated there before is dropped
+		void Reset(uint32_t flight) noexcept;
+
+		/// @brief Take size bytes from the current region; thread-safe and lock-free
+		/// @param alignment relative to the region start, which is aligned for any descriptor or binding;
+		/// need not be a power of two
+		[[nodiscard]] VkUploadAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment) noexcept;
+
+		/// @brief Make the current region's writes visible to the device; a no-op on coherent memory
+		bool Flush() noexcept;
+
+		[[nodiscard]] VkBuffer Buffer() const noexcept;
+		[[nodiscard]] VkDeviceSize RegionOffset(uint32_t flight) const noexcept;
+		[[nodiscard]] VkDeviceSize RegionSize() const noexcept;
+
+		/// @brief Bytes taken from the current region
+		[[nodiscard]] VkDeviceSize Used() const noexcept;
+
+		/// @brief Copy with non-temporal stores, bypassing the cache on the way to write-combined memory
+		/// @details dst 16-byte aligned and size a multiple of 16; the writer calls StreamFence before
+		/// handing the data over to another thread
+		static void Stream(void* dst, const void* src, size_t size) noexcept
+		{
+#if PRE_SSE
+			auto* d = static_cast<float*>(dst);
+			auto* s = static_cast<const float*>(src);
+			for (size_t i = 0; i < size / sizeof(float); i += 4)
+				_mm_stream_ps(d + i, _mm_loadu_ps(s + i));
+#else
+			std::memcpy(dst, src, size);
+#endif
+		}
+
+		static void StreamFence() noexcept
+		{
+#if PRE_SSE
+			_mm_sfence();
+#endif
+		}
+	};
+}
+
+#endif //PHUSIS_VKUPLOADRING_HXX
@@ -0,0 +1,62 @@
+#ifndef PHUSIS_MANAGED_HXX
+#define PHUSIS_MANAGED_HXX
+
+#include "fw.hxx"
+#include "application.hxx"
+
+// bump when an entry is removed, reordered or changes signature; appending keeps the version
+#define PHUSIS_API_VERSION 1
+
+// X(name, return type, parameters...); the table below and its initializer are generated from this list
+#define PHUSIS_API_FUNCTIONS(X) \
+	X(Create, Phusis::Application*, int32_t mode, uint32_t validation) \
+	X(Destroy, void, Phusis::Application* app) \
+	X(Initialize, int32_t, Phusis::Application* app) \
+	X(Run, int32_t, Phusis::Application* app) \
+	X(ObjectCount, uint32_t, const Phusis::Application* app) \
+	X(Transforms, Phusis::EngineObjectTransform*, Phusis::Application* app) \
+	X(SetTransforms, void, Phusis::Application* app, const uint32_t* indices, const Phusis::EngineObjectTransform* src, uint32_t n) \
+	X(SetRotations, void, Phusis::Application* app, const uint32_t* indices, const glm::mat4* src, uint32_t n) \
+	X(SetEnabled, void, Phusis::Application* app, const uint32_t* indices, const uint32_t* src, uint32_t n) \
+	X(AcquireUpdates, Phusis::SceneUpdate*, Phusis::Application* app, uint32_t n, uint32_t* granted) \
+	X(PublishUpdates, void, Phusis::Application* app, uint32_t n) \
+	X(SetParents, void, Phusis::Application* app, const uint32_t* indices, const uint32_t* src, uint32_t n) \
+	X(Invalidate, void, Phusis::Application* app, const uint32_t* indices, uint32_t n) \
+	X(ExportMetrics, void, Phusis::Application* app, const char* path, double seconds) \
+	X(Capture, void, Phusis::Application* app, const char* path, uint32_t frames) \
+	X(SetCamera, void, Phusis::Application* app, const glm::mat4* view, const glm::mat4* projection) \
+	X(LoadMeshes, uint32_t, Phusis::Application* app, const char* path) \
+	X(MeshCount, uint32_t, const Phusis::Application* app) \
+	X(CreateObject, uint32_t, Phusis::Application* app, uint32_t mesh, uint32_t material) \
+	X(DestroyObject, uint32_t, Phusis::Application* app, uint32_t idx)
+
+namespace Phusis
+{
+	/// @brief Engine entry points for managed assemblies, fetched once at load
+	/// @details Batched setters take an optional index list; nullptr addresses objects [0, n). They, like
+	/// AcquireUpdates/PublishUpdates, stream deltas through the scene channel, so they are safe while Run
+	/// renders and apply at its next frame; all of them must come from the same thread, the channel's one
+	/// producer. Transforms() exposes native memory directly for callers that write in place before Run,
+	/// who then Invalidate the rotations they changed. Rotations are relative to the parent set with
+	/// SetParents. ExportMetrics writes frame statistics as Prometheus text every seconds; nullptr stops
+	/// it. Capture records the next frames for phusis-replay; nullptr stops it. SetCamera moves the camera
+	/// from any thread, taking effect at the next frame. LoadMeshes returns the index of a cooked blob's first
+	/// mesh; CreateObject appends an object drawing a loaded mesh and returns its index, DestroyObject moves
+	/// the objects after it down one index. Those three and Transforms() belong before Run; UINT32_MAX and 0
+	/// report failure.
+	struct ManagedApi
+	{
+		uint32_t Version;
+		uint32_t Size;
+
+#define PHUSIS_API_ENTRY(name, ret, ...) ret (*name)(__VA_ARGS__);
+		PHUSIS_API_FUNCTIONS(PHUSIS_API_ENTRY)
+#undef PHUSIS_API_ENTRY
+	};
+}
+
+/// @brief Get the function table for a managed layer built against version
+/// @return nullptr if version is not served by this build
+extern "C" DLLEXPORT const Phusis::ManagedApi* phusis_get_api(uint32_t version);
+
+#endif //PHUSIS_MANAGED_HXX
@@ -3,20 +3,38 @@
 
 #include "buffer.hxx"
 #include "fw.hxx"
+#include "meshlet.hxx"
 #include <utility>
 
 namespace Phusis
 {
 	struct Mesh
 	{
+		// one stream per binding; binding i feeds shader location i
 		const std::vector<Buffer> Vertices;
+		// one index buffer per level of detail over the same vertices, finest first
 		const std::vector<Buffer> Indices;
 
+		// maps quantized positions back to model space; identity for float positions
+		const glm::mat4 Dequantization;
+
+		// object-space error of each level against level 0, ascending; without errors only level 0 is drawn
+		const std::vector<float> Errors;
+
+		// meshlets of each level, like Indices; levels without them are drawn whole
+		const std::vector<MeshletLevel> Clusters;
+
 		explicit Mesh(
 				std::vector<Buffer> vertices,
-				std::vector<Buffer> indices) noexcept
+				std::vector<Buffer> indices,
+				glm::mat4 dequantization = glm::mat4(1.f),
+				std::vector<float> errors = {},
+				std::vector<MeshletLevel> clusters = {}) noexcept
 				: Vertices(std::move(vertices)),
-				  Indices(std::move(indices))
+				  Indices(std::move(indices)),
+				  Dequantization(dequantization),
+				  Errors(std::move(errors)),
+				  Clusters(std::move(clusters))
 		{
 		}
 	};
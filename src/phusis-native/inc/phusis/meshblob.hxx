@@ -0,0 +1,130 @@
+#ifndef PHUSIS_MESHBLOB_HXX
+#define PHUSIS_MESHBLOB_HXX
+
+#include "fw.hxx"
+#include "mesh.hxx"
+#include "meshlet.hxx"
+#include <type_traits>
+
+namespace Phusis
+{
+	/*
+	 * cooked mesh blob, written by phusis-cook; little-endian, read in place from a mapping
+	 * | MeshBlobHeader | MeshBlobEntry x MeshCount | pad | data section |
+	 * the data section starts on a page and every region in it on MeshBlobAlignment, so the
+	 * whole section is copied into one staging range as-is and regions become buffer offsets
+	 */
+	constexpr uint32_t MeshBlobMagic = 0x424D4850; // "PHMB"
+	constexpr uint32_t MeshBlobVersion = 1;
+	constexpr uint32_t MeshBlobPage = 4096;
+	// covers minStorageBufferOffsetAlignment and index / vertex offset rules on every device we target
+	constexpr uint32_t MeshBlobAlignment = 256;
+
+	constexpr uint32_t MeshBlobMaxStreams = 4;
+	constexpr uint32_t MeshBlobMaxLods = 8;
+
+	struct MeshBlobHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t MeshCount;
+		uint32_t Reserved;
+
+		// from the start of the file
+		uint64_t DataOffset;
+		uint64_t DataSize;
+	};
+
+	// byte range relative to the data section
+	struct MeshBlobRegion
+	{
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	struct MeshBlobStream
+	{
+		MeshBlobRegion Region;
+		// VkFormat
+		uint32_t Format;
+		uint32_t Stride;
+		uint32_t Count;
+		// VertexAttribute
+		uint32_t Attribute;
+	};
+
+	struct MeshBlobLod
+	{
+		// uint32 indices over the mesh's streams
+		MeshBlobRegion Indices;
+		uint32_t Count;
+		// object-space error against level 0
+		float Error;
+
+		// Meshlet array
+		MeshBlobRegion Meshlets;
+		uint32_t MeshletCount;
+		uint32_t Reserved;
+	};
+
+	struct MeshBlobEntry
+	{
+		char Name[64];
+
+		uint32_t StreamCount;
+		uint32_t LodCount;
+		MeshBlobStream Streams[MeshBlobMaxStreams];
+		MeshBlobLod Lods[MeshBlobMaxLods];
+
+		// column-major Mesh::Dequantization
+		float Dequantization[16];
+
+		// bounding sphere of the whole mesh
+		float Center[3];
+		float Radius;
+	};
+
+	static_assert(std::is_trivially_copyable_v<MeshBlobHeader> && sizeof(MeshBlobHeader) == 32);
+	static_assert(std::is_trivially_copyable_v<MeshBlobEntry> && sizeof(MeshBlobEntry) % 8 == 0);
+
+	/// @brief Read-only mapping of a cooked blob. Nothing is parsed: entries are used where they lie,
+	/// Data() is copied to the GPU in one piece, and Meshes() points Buffers at that copy.
+	class DLLEXPORT MeshBlob
+	{
+	private:
+		const uint8_t* _mapping = nullptr;
+		size_t _size = 0;
+
+		const MeshBlobHeader* _header = nullptr;
+		const MeshBlobEntry* _entries = nullptr;
+
+	public:
+		MeshBlob() noexcept = default;
+		MeshBlob(const MeshBlob&) = delete;
+		~MeshBlob() noexcept;
+
+		MeshBlob& operator=(const MeshBlob&) = delete;
+
+	public:
+		/// @brief Map and validate the blob; false on I/O errors, bad magic, version or bounds
+		bool Open(const std::filesystem::path& path) noexcept;
+		void Close() noexcept;
+
+		[[nodiscard]] uint32_t Count() const noexcept;
+		[[nodiscard]] const MeshBlobEntry& Entry(uint32_t idx) const noexcept;
+
+		/// @brief Data section; page aligned
+		[[nodiscard]] const void* Data() const noexcept;
+		[[nodiscard]] size_t DataSize() const noexcept;
+
+		/// @brief Meshlets of one level, read from the mapping
+		[[nodiscard]] const Meshlet* Meshlets(uint32_t idx, uint32_t lod) const noexcept;
+
+		/// @brief Meshes over a device buffer holding a copy of Data() at offset base; their meshlets point
+		/// into the mapping, which must stay open while they are drawn
+		/// @param address device address of buffer; enables the mesh shader path, 0 keeps the indexed path
+		[[nodiscard]] std::vector<Mesh> Meshes(VkBuffer buffer, VkDeviceSize base = 0, VkDeviceAddress address = 0) const;
+	};
+}
+
+#endif //PHUSIS_MESHBLOB_HXX
@@ -0,0 +1,47 @@
+#ifndef PHUSIS_MESHLET_HXX
+#define PHUSIS_MESHLET_HXX
+
+#include "fw.hxx"
+#include <type_traits>
+
+namespace Phusis
+{
+	constexpr uint32_t MeshletMaxVertices = 64;
+	constexpr uint32_t MeshletMaxTriangles = 124;
+
+	/// @brief Triangle cluster of at most MeshletMaxVertices / MeshletMaxTriangles, stored as a
+	/// contiguous range of its level's uint32 index buffer; the layout task shaders read (std430)
+	struct Meshlet
+	{
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+
+		// bounding sphere in dequantized object space
+		float Center[3];
+		float Radius;
+
+		// normal cone; back-facing for every view with dot(view, axis) >= cutoff, cutoff 1 disables
+		float ConeAxis[3];
+		float ConeCutoff;
+	};
+
+	static_assert(std::is_trivially_copyable_v<Meshlet> && sizeof(Meshlet) == 40);
+
+	/// @brief Meshlets of one level of a mesh
+	struct MeshletLevel
+	{
+		// read by cluster culling on the recording workers; must outlive the mesh, e.g. a MeshBlob mapping
+		const Meshlet* Meshlets;
+		uint32_t Count;
+
+		// task / mesh shader path: the same records, the level's indices and the position stream as byte
+		// offsets from one device address, which keeps them inside the push-constant budget; 0 keeps the
+		// level on the indexed path
+		VkDeviceAddress Address;
+		uint32_t Records;
+		uint32_t Indices;
+		uint32_t Positions;
+	};
+}
+
+#endif //PHUSIS_MESHLET_HXX
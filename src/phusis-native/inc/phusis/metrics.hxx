@@ -0,0 +1,77 @@
+#ifndef PHUSIS_METRICS_HXX
+#define PHUSIS_METRICS_HXX
+
+#include "fw.hxx"
+#include "sys/histogram.hxx"
+#include <memory>
+
+namespace Phusis
+{
+	/// @brief One named distribution, exported as a Prometheus summary
+	/// @details Quantiles cover the values recorded since the previous export; sum and count cover
+	/// everything since start, so rates and means come out of the scraper's side. Recording is a handful
+	/// of relaxed atomic adds and safe from any thread.
+	class DLLEXPORT Metric
+	{
+		friend class MetricsRegistry;
+
+	private:
+		std::string _name;
+		std::string _help;
+		// exported value per recorded unit, e.g. 1e-9 for nanoseconds exported as seconds
+		double _scale;
+
+		// recorders write _windows[_window]; an export flips it and reads the other one
+		std::array<sys::histogram, 2> _windows{};
+		std::atomic<uint32_t> _window{ 0 };
+
+		std::atomic<uint64_t> _count{ 0 };
+		std::atomic<uint64_t> _sum{ 0 };
+
+	public:
+		Metric(std::string name, std::string help, double scale) noexcept;
+		Metric(const Metric&) = delete;
+
+		Metric& operator=(const Metric&) = delete;
+
+	public:
+		void Record(uint64_t value) noexcept;
+
+		[[nodiscard]] const std::string& Name() const noexcept;
+	};
+
+	/// @brief Engine and application metrics, written periodically as a Prometheus text file
+	/// @details Metrics are registered up front and recorded into without locks. Export renames a
+	/// finished temporary over the target, so a collector reading the file (e.g. node_exporter's textfile
+	/// collector) never sees it half written.
+	class DLLEXPORT MetricsRegistry
+	{
+	private:
+		// registration, configuration and export; never taken by Record
+		std::mutex _lock;
+		std::vector<std::unique_ptr<Metric>> _metrics;
+
+		std::filesystem::path _path;
+		std::chrono::steady_clock::duration _interval{ 0 };
+		std::chrono::steady_clock::time_point _next{};
+		bool _failed = false;
+
+	public:
+		/// @brief Metric called name, created on first use; the reference lives as long as the registry
+		/// @param name Prometheus metric name, with its unit as a suffix, e.g. phusis_frame_seconds
+		/// @param scale applied to recorded values on export
+		Metric& Register(const std::string& name, const std::string& help, double scale = 1.);
+
+		/// @brief Write every metric to path every seconds from then on; an empty path or 0 stops
+		void ExportTo(const std::filesystem::path& path, double seconds);
+
+		/// @brief Export if due; cheap to call often
+		/// @return false if writing failed
+		bool Export() noexcept;
+
+		/// @brief Prometheus text of every metric, starting a new quantile window for each
+		void Write(std::ostream& out);
+	};
+}
+
+#endif //PHUSIS_METRICS_HXX
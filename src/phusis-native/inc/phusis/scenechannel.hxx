@@ -0,0 +1,66 @@
+#ifndef PHUSIS_SCENECHANNEL_HXX
+#define PHUSIS_SCENECHANNEL_HXX
+
+#include "fw.hxx"
+#include "engineobject.hxx"
+#include "transformhierarchy.hxx"
+#include "sys/spsc.hxx"
+
+namespace Phusis
+{
+	constexpr uint32_t SceneUpdateRotation = 1u << 0;
+	constexpr uint32_t SceneUpdateColor = 1u << 1;
+	constexpr uint32_t SceneUpdateEnabled = 1u << 2;
+	constexpr uint32_t SceneUpdateParent = 1u << 3;
+	// Rotation was written in place; only tells the hierarchy to recompute the object's world matrix
+	constexpr uint32_t SceneUpdateInvalidate = 1u << 4;
+
+	/// @brief One delta for one object; Fields selects which members are applied
+	struct SceneUpdate
+	{
+		uint32_t Index;
+		uint32_t Fields;
+		uint32_t Enabled;
+		// TransformHierarchy::NoParent detaches
+		uint32_t Parent;
+		glm::mat4 Rotation;
+		glm::vec4 Color;
+	};
+
+	static_assert(std::is_standard_layout_v<SceneUpdate> && std::is_trivially_copyable_v<SceneUpdate>);
+	static_assert(sizeof(SceneUpdate) == 96 && offsetof(SceneUpdate, Rotation) == 16);
+
+	/// @brief Scene deltas over a lock-free single-producer/single-consumer sys::spsc ring
+	/// @details Managed code produces: Acquire a contiguous run of slots, fill it, Publish.
+	/// The frame loop consumes everything published so far in one pass. Deltas are never dropped;
+	/// a full ring makes Acquire grant fewer slots until the next frame drains it.
+	class DLLEXPORT SceneChannel
+	{
+	private:
+		sys::spsc<SceneUpdate> _ring;
+
+	public:
+		/// @param capacityLog2 ring holds 2^capacityLog2 updates (default 256k, 24MiB)
+		explicit SceneChannel(uint32_t capacityLog2 = 18) noexcept;
+
+		SceneChannel(const SceneChannel&) = delete;
+		SceneChannel& operator=(const SceneChannel&) = delete;
+
+	public:
+		/// @brief Producer: up to n free slots, contiguous in memory
+		/// @param granted slots actually available; fewer than n at the ring's end or when full
+		SceneUpdate* Acquire(uint32_t n, uint32_t& granted) noexcept;
+
+		/// @brief Producer: make the first n acquired slots visible to the consumer
+		void Publish(uint32_t n) noexcept;
+
+		/// @brief Consumer: apply every published update in order
+		/// @param hierarchy optional, already sized to transforms; takes parent links and marks changed rotations
+		/// @return number of updates applied
+		uint32_t Consume(std::vector<EngineObjectTransform>& transforms, TransformHierarchy* hierarchy = nullptr) noexcept;
+
+		[[nodiscard]] uint32_t Capacity() const noexcept;
+	};
+}
+
+#endif //PHUSIS_SCENECHANNEL_HXX
@@ -0,0 +1,78 @@
+#ifndef PHUSIS_TRANSFORMHIERARCHY_HXX
+#define PHUSIS_TRANSFORMHIERARCHY_HXX
+
+#include "fw.hxx"
+#include "engineobject.hxx"
+#include "sys/workers.hxx"
+
+namespace Phusis
+{
+	/// @brief Parent links between objects and the world matrices they produce
+	/// @details EngineObjectTransform::Rotation is relative to the object's parent; roots are in world space.
+	/// Nodes are kept sorted by depth in flat arrays, so one level reads only world matrices finished by the
+	/// level above and is split across workers without locks. Only subtrees under a changed transform are
+	/// recomputed. Not thread-safe; the render thread owns it between updates.
+	class DLLEXPORT TransformHierarchy
+	{
+	public:
+		static constexpr uint32_t NoParent = UINT32_MAX;
+
+	private:
+		// indexed like the objects
+		std::vector<uint32_t> _parents;
+		std::vector<uint32_t> _depths;
+		std::vector<glm::mat4> _worlds;
+
+		// depth-sorted: object index and parent of each node, and where each level starts
+		std::vector<uint32_t> _order;
+		std::vector<uint32_t> _orderParents;
+		std::vector<uint32_t> _levels;
+
+		// per object: its world matrix is recomputed this update; per level: nodes marked since the last one
+		std::vector<uint8_t> _dirty;
+		std::vector<uint32_t> _marked;
+
+		// topology changed; the next update re-sorts and recomputes everything
+		bool _stale = true;
+		uint32_t _updated = 0;
+
+	private:
+		void Sort();
+
+		/// @brief Recompute the dirty nodes in [begin, end) of the sorted order
+		/// @return number of world matrices written
+		uint32_t UpdateRange(const EngineObjectTransform* locals, uint32_t begin, uint32_t end) noexcept;
+
+	public:
+		/// @brief Track n objects; new ones are roots
+		void Resize(uint32_t n);
+
+		/// @brief Drop object idx; the objects after it move down one index and its children become roots
+		void Erase(uint32_t idx) noexcept;
+
+		/// @brief Attach child under parent, or make it a root with NoParent
+		/// @return false if either index is out of range or the link would form a cycle
+		bool SetParent(uint32_t child, uint32_t parent) noexcept;
+
+		/// @brief Mark an object whose local transform changed; its subtree is recomputed on the next update
+		void Invalidate(uint32_t idx) noexcept;
+		void InvalidateAll() noexcept;
+
+		/// @brief Bring every world matrix up to date with locals, one level at a time across workers
+		/// @param locals one per object; resizes the hierarchy when the count changed
+		void Update(const std::vector<EngineObjectTransform>& locals, sys::workers& workers);
+
+		[[nodiscard]] uint32_t Parent(uint32_t idx) const noexcept;
+
+		/// @brief World matrices, indexed like the objects; valid after Update
+		[[nodiscard]] const glm::mat4* Worlds() const noexcept;
+
+		[[nodiscard]] uint32_t Count() const noexcept;
+		[[nodiscard]] uint32_t Depth() const noexcept;
+
+		/// @brief World matrices recomputed by the last Update
+		[[nodiscard]] uint32_t Updated() const noexcept;
+	};
+}
+
+#endif //PHUSIS_TRANSFORMHIERARCHY_HXX
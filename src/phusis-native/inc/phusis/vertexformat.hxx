@@ -0,0 +1,83 @@
+#ifndef PHUSIS_VERTEXFORMAT_HXX
+#define PHUSIS_VERTEXFORMAT_HXX
+
+#include "fw.hxx"
+#include "mesh.hxx"
+#include "pre/vec3.hxx"
+
+namespace Phusis
+{
+	enum class VertexAttribute
+	{
+		Position,
+		Normal,
+		TexCoord
+	};
+
+	enum class VertexEncoding
+	{
+		// 32-bit floats
+		Full,
+		// unorm16 positions (mesh dequantization), octahedral snorm16 normals, half-float uvs
+		Compressed
+	};
+
+	struct VertexStreamFormat
+	{
+		VkFormat Format;
+		uint32_t Stride;
+	};
+
+	constexpr VertexStreamFormat StreamFormat(VertexAttribute attribute, VertexEncoding encoding) noexcept
+	{
+		if (encoding == VertexEncoding::Full)
+		{
+			switch (attribute)
+			{
+			case VertexAttribute::Position:
+			case VertexAttribute::Normal:
+				return { VK_FORMAT_R32G32B32_SFLOAT, 12 };
+			case VertexAttribute::TexCoord:
+				return { VK_FORMAT_R32G32_SFLOAT, 8 };
+			}
+		}
+
+		switch (attribute)
+		{
+		case VertexAttribute::Position:
+			// 4th lane pads to 8 bytes; 3-component 16-bit formats are rarely supported
+			return { VK_FORMAT_R16G16B16A16_UNORM, 8 };
+		case VertexAttribute::Normal:
+			return { VK_FORMAT_R16G16_SNORM, 4 };
+		case VertexAttribute::TexCoord:
+			return { VK_FORMAT_R16G16_SFLOAT, 4 };
+		}
+
+		return { VK_FORMAT_UNDEFINED, 0 };
+	}
+
+	/// @brief Mesh::Dequantization for positions packed with pre::pack_unorm16 over [min, max]
+	glm::mat4 DequantizationMatrix(const pre::vec3f& min, const pre::vec3f& max) noexcept;
+
+	/// @brief Pipeline vertex input matching a mesh's streams (binding i, location i)
+	class VertexInputDescription
+	{
+	private:
+		std::vector<VkVertexInputBindingDescription> _bindings;
+		std::vector<VkVertexInputAttributeDescription> _attributes;
+		VkPipelineVertexInputStateCreateInfo _info;
+
+	public:
+		explicit VertexInputDescription(const Mesh& mesh) noexcept;
+		explicit VertexInputDescription(const std::vector<VertexStreamFormat>& streams) noexcept;
+
+		VertexInputDescription(const VertexInputDescription&) = delete;
+		VertexInputDescription& operator=(const VertexInputDescription&) = delete;
+
+	public:
+		/// @brief Valid while this description is alive
+		[[nodiscard]] const VkPipelineVertexInputStateCreateInfo& Info() const noexcept;
+	};
+}
+
+#endif //PHUSIS_VERTEXFORMAT_HXX
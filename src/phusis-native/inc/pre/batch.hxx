@@ -0,0 +1,21 @@
+#ifndef PHUSIS_BATCH_HXX
+#define PHUSIS_BATCH_HXX
+
+#include "fw.hxx"
+#include "span.hxx"
+#include "vec4.hxx"
+#include "mat4.hxx"
+
+namespace pre
+{
+	/// @brief dst[i] = lhs * src[i]; dst may alias src
+	void transform(const mat4f& lhs, span<const mat4f> src, span<mat4f> dst) noexcept;
+
+	/// @brief dst[i] = lhs * src[i]; dst may alias src
+	void transform(const mat4f& lhs, span<const vec4f> src, span<vec4f> dst) noexcept;
+
+	/// @brief dst[i] = lhs[i] * rhs[i]; dst may alias either input
+	void transform(span<const mat4f> lhs, span<const mat4f> rhs, span<mat4f> dst) noexcept;
+}
+
+#endif //PHUSIS_BATCH_HXX
@@ -0,0 +1,38 @@
+#ifndef PHUSIS_GLM_HXX
+#define PHUSIS_GLM_HXX
+
+#include "fw.hxx"
+#include <cstring>
+#include "vec4.hxx"
+#include "mat4.hxx"
+
+namespace pre
+{
+	// same column-major layout; glm only guarantees 4-byte alignment, so values cross by copy, never by cast
+	static_assert(sizeof(mat4f) == sizeof(glm::mat4));
+	static_assert(sizeof(vec4f) == sizeof(glm::vec4));
+
+	/// @brief Aligned copy of a glm matrix for the simd kernels
+	inline mat4f from_glm(const glm::mat4& m) noexcept
+	{
+		mat4f r;
+		std::memcpy(&r.cols[0].x, &m[0][0], sizeof(mat4f));
+		return r;
+	}
+
+	inline vec4f from_glm(const glm::vec4& v) noexcept
+	{
+		vec4f r;
+		std::memcpy(&r.x, &v.x, sizeof(vec4f));
+		return r;
+	}
+
+	inline glm::mat4 to_glm(const mat4f& m) noexcept
+	{
+		glm::mat4 r;
+		std::memcpy(&r[0][0], &m.cols[0].x, sizeof(mat4f));
+		return r;
+	}
+}
+
+#endif //PHUSIS_GLM_HXX
@@ -0,0 +1,125 @@
+#ifndef PHUSIS_MAT3_HXX
+#define PHUSIS_MAT3_HXX
+
+#include "fw.hxx"
+#include "vec3.hxx"
+
+namespace pre
+{
+	/// @brief Column-major 3x3 matrix, laid out like glm::mat3 / GLSL mat3
+	template<typename T>
+	struct mat3
+	{
+	public:
+		vec3<T> cols[3];
+
+	public:
+		constexpr mat3() noexcept;
+		constexpr explicit mat3(T diagonal) noexcept;
+		constexpr explicit mat3(const vec3<T>& c0, const vec3<T>& c1, const vec3<T>& c2) noexcept;
+
+	public:
+		constexpr vec3<T>& operator[](size_t i) noexcept;
+		constexpr const vec3<T>& operator[](size_t i) const noexcept;
+
+		constexpr mat3<T> operator*(const mat3<T>& m) const noexcept;
+		constexpr vec3<T> operator*(const vec3<T>& v) const noexcept;
+		constexpr mat3<T> operator*(T s) const noexcept;
+
+		constexpr bool operator==(const mat3<T>& m) const noexcept;
+		constexpr bool operator!=(const mat3<T>& m) const noexcept;
+
+		constexpr mat3<T> transpose() const noexcept;
+		constexpr T determinant() const noexcept;
+
+		static constexpr mat3<T> identity() noexcept;
+	};
+
+	using mat3f = mat3<float>;
+}
+
+template<typename T>
+constexpr pre::mat3<T>::mat3() noexcept
+	: cols{ vec3<T>(), vec3<T>(), vec3<T>() }
+{
+}
+
+template<typename T>
+constexpr pre::mat3<T>::mat3(T diagonal) noexcept
+	: cols{
+		vec3<T>(diagonal, 0, 0),
+		vec3<T>(0, diagonal, 0),
+		vec3<T>(0, 0, diagonal) }
+{
+}
+
+template<typename T>
+constexpr pre::mat3<T>::mat3(const vec3<T>& c0, const vec3<T>& c1, const vec3<T>& c2) noexcept
+	: cols{ c0, c1, c2 }
+{
+}
+
+template<typename T>
+constexpr pre::vec3<T>& pre::mat3<T>::operator[](size_t i) noexcept
+{
+	return cols[i];
+}
+
+template<typename T>
+constexpr const pre::vec3<T>& pre::mat3<T>::operator[](size_t i) const noexcept
+{
+	return cols[i];
+}
+
+template<typename T>
+constexpr pre::mat3<T> pre::mat3<T>::operator*(const mat3<T>& m) const noexcept
+{
+	return pre::mat3<T>(*this * m.cols[0], *this * m.cols[1], *this * m.cols[2]);
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::mat3<T>::operator*(const vec3<T>& v) const noexcept
+{
+	return cols[0] * v.x + cols[1] * v.y + cols[2] * v.z;
+}
+
+template<typename T>
+constexpr pre::mat3<T> pre::mat3<T>::operator*(T s) const noexcept
+{
+	return pre::mat3<T>(cols[0] * s, cols[1] * s, cols[2] * s);
+}
+
+template<typename T>
+constexpr bool pre::mat3<T>::operator==(const mat3<T>& m) const noexcept
+{
+	return cols[0] == m.cols[0] && cols[1] == m.cols[1] && cols[2] == m.cols[2];
+}
+
+template<typename T>
+constexpr bool pre::mat3<T>::operator!=(const mat3<T>& m) const noexcept
+{
+	return !(*this == m);
+}
+
+template<typename T>
+constexpr pre::mat3<T> pre::mat3<T>::transpose() const noexcept
+{
+	return pre::mat3<T>(
+			vec3<T>(cols[0].x, cols[1].x, cols[2].x),
+			vec3<T>(cols[0].y, cols[1].y, cols[2].y),
+			vec3<T>(cols[0].z, cols[1].z, cols[2].z));
+}
+
+template<typename T>
+constexpr T pre::mat3<T>::determinant() const noexcept
+{
+	return pre::dot(cols[0], pre::cross(cols[1], cols[2]));
+}
+
+template<typename T>
+constexpr pre::mat3<T> pre::mat3<T>::identity() noexcept
+{
+	return pre::mat3<T>(1);
+}
+
+#endif //PHUSIS_MAT3_HXX
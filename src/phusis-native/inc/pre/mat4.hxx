@@ -0,0 +1,167 @@
+#ifndef PHUSIS_MAT4_HXX
+#define PHUSIS_MAT4_HXX
+
+#include "fw.hxx"
+#include "simd.hxx"
+#include "vec4.hxx"
+#include "mat3.hxx"
+
+namespace pre
+{
+	/// @brief Column-major 4x4 matrix, laid out like glm::mat4 / GLSL mat4
+	template<typename T>
+	struct mat4
+	{
+	public:
+		vec4<T> cols[4];
+
+	public:
+		constexpr mat4() noexcept;
+		constexpr explicit mat4(T diagonal) noexcept;
+		constexpr explicit mat4(const vec4<T>& c0, const vec4<T>& c1, const vec4<T>& c2, const vec4<T>& c3) noexcept;
+		constexpr explicit mat4(const mat3<T>& m) noexcept;
+
+	public:
+		constexpr vec4<T>& operator[](size_t i) noexcept;
+		constexpr const vec4<T>& operator[](size_t i) const noexcept;
+
+		constexpr mat4<T> operator*(const mat4<T>& m) const noexcept;
+		constexpr vec4<T> operator*(const vec4<T>& v) const noexcept;
+
+		constexpr bool operator==(const mat4<T>& m) const noexcept;
+		constexpr bool operator!=(const mat4<T>& m) const noexcept;
+
+		constexpr mat4<T> transpose() const noexcept;
+		constexpr mat3<T> upper() const noexcept;
+
+		static constexpr mat4<T> identity() noexcept;
+		static constexpr mat4<T> translation(const vec3<T>& v) noexcept;
+		static constexpr mat4<T> scale(const vec3<T>& v) noexcept;
+	};
+
+	using mat4f = mat4<float>;
+
+	namespace simd
+	{
+		mat4f mul(const mat4f& a, const mat4f& b) noexcept;
+		vec4f mul(const mat4f& a, const vec4f& v) noexcept;
+	}
+}
+
+template<typename T>
+constexpr pre::mat4<T>::mat4() noexcept
+	: cols{ vec4<T>(), vec4<T>(), vec4<T>(), vec4<T>() }
+{
+}
+
+template<typename T>
+constexpr pre::mat4<T>::mat4(T diagonal) noexcept
+	: cols{
+		vec4<T>(diagonal, 0, 0, 0),
+		vec4<T>(0, diagonal, 0, 0),
+		vec4<T>(0, 0, diagonal, 0),
+		vec4<T>(0, 0, 0, diagonal) }
+{
+}
+
+template<typename T>
+constexpr pre::mat4<T>::mat4(const vec4<T>& c0, const vec4<T>& c1, const vec4<T>& c2, const vec4<T>& c3) noexcept
+	: cols{ c0, c1, c2, c3 }
+{
+}
+
+template<typename T>
+constexpr pre::mat4<T>::mat4(const mat3<T>& m) noexcept
+	: cols{
+		vec4<T>(m.cols[0], 0),
+		vec4<T>(m.cols[1], 0),
+		vec4<T>(m.cols[2], 0),
+		vec4<T>(0, 0, 0, 1) }
+{
+}
+
+template<typename T>
+constexpr pre::vec4<T>& pre::mat4<T>::operator[](size_t i) noexcept
+{
+	return cols[i];
+}
+
+template<typename T>
+constexpr const pre::vec4<T>& pre::mat4<T>::operator[](size_t i) const noexcept
+{
+	return cols[i];
+}
+
+template<typename T>
+constexpr pre::mat4<T> pre::mat4<T>::operator*(const mat4<T>& m) const noexcept
+{
+	if constexpr (std::is_same_v<T, float>)
+		if (!PRE_CONSTANT_EVALUATED())
+			return pre::simd::mul(*this, m);
+
+	return pre::mat4<T>(*this * m.cols[0], *this * m.cols[1], *this * m.cols[2], *this * m.cols[3]);
+}
+
+template<typename T>
+constexpr pre::vec4<T> pre::mat4<T>::operator*(const vec4<T>& v) const noexcept
+{
+	if constexpr (std::is_same_v<T, float>)
+		if (!PRE_CONSTANT_EVALUATED())
+			return pre::simd::mul(*this, v);
+
+	return cols[0] * v.x + cols[1] * v.y + cols[2] * v.z + cols[3] * v.w;
+}
+
+template<typename T>
+constexpr bool pre::mat4<T>::operator==(const mat4<T>& m) const noexcept
+{
+	return cols[0] == m.cols[0] && cols[1] == m.cols[1] && cols[2] == m.cols[2] && cols[3] == m.cols[3];
+}
+
+template<typename T>
+constexpr bool pre::mat4<T>::operator!=(const mat4<T>& m) const noexcept
+{
+	return !(*this == m);
+}
+
+template<typename T>
+constexpr pre::mat4<T> pre::mat4<T>::transpose() const noexcept
+{
+	return pre::mat4<T>(
+			vec4<T>(cols[0].x, cols[1].x, cols[2].x, cols[3].x),
+			vec4<T>(cols[0].y, cols[1].y, cols[2].y, cols[3].y),
+			vec4<T>(cols[0].z, cols[1].z, cols[2].z, cols[3].z),
+			vec4<T>(cols[0].w, cols[1].w, cols[2].w, cols[3].w));
+}
+
+template<typename T>
+constexpr pre::mat3<T> pre::mat4<T>::upper() const noexcept
+{
+	return pre::mat3<T>(cols[0].xyz(), cols[1].xyz(), cols[2].xyz());
+}
+
+template<typename T>
+constexpr pre::mat4<T> pre::mat4<T>::identity() noexcept
+{
+	return pre::mat4<T>(1);
+}
+
+template<typename T>
+constexpr pre::mat4<T> pre::mat4<T>::translation(const vec3<T>& v) noexcept
+{
+	pre::mat4<T> m(1);
+	m.cols[3] = vec4<T>(v, 1);
+	return m;
+}
+
+template<typename T>
+constexpr pre::mat4<T> pre::mat4<T>::scale(const vec3<T>& v) noexcept
+{
+	pre::mat4<T> m(1);
+	m.cols[0].x = v.x;
+	m.cols[1].y = v.y;
+	m.cols[2].z = v.z;
+	return m;
+}
+
+#endif //PHUSIS_MAT4_HXX
@@ -0,0 +1,36 @@
+#ifndef PHUSIS_PACK_HXX
+#define PHUSIS_PACK_HXX
+
+#include "fw.hxx"
+#include "span.hxx"
+#include "vec2.hxx"
+#include "vec3.hxx"
+#include "mat4.hxx"
+
+namespace pre
+{
+	/// @brief Component-wise bounds of src; both zero when src is empty
+	void bounds(span<const vec3f> src, vec3f& min, vec3f& max) noexcept;
+
+	/// @brief Scale/offset mapping unorm16 positions in [0, 1] back onto [min, max]
+	constexpr mat4f dequantization(const vec3f& min, const vec3f& max) noexcept
+	{
+		return mat4f::translation(min) * mat4f::scale(max - min);
+	}
+
+	/// @brief Quantizes positions within [min, max] to unorm16, 4 components per vertex (w = 0)
+	void pack_unorm16(span<const vec3f> src, const vec3f& min, const vec3f& max, span<uint16_t> dst) noexcept;
+
+	/// @brief Octahedral-encodes unit normals to snorm16, 2 components per vertex
+	void pack_octahedral(span<const vec3f> src, span<int16_t> dst) noexcept;
+
+	/// @brief IEEE binary16, round to nearest even
+	uint16_t to_half(float f) noexcept;
+
+	void pack_half(span<const float> src, span<uint16_t> dst) noexcept;
+
+	/// @brief Half-float uvs, 2 components per vertex
+	void pack_half(span<const vec2f> src, span<uint16_t> dst) noexcept;
+}
+
+#endif //PHUSIS_PACK_HXX
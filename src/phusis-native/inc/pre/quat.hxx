@@ -0,0 +1,119 @@
+#ifndef PHUSIS_QUAT_HXX
+#define PHUSIS_QUAT_HXX
+
+#include "fw.hxx"
+#include "vec3.hxx"
+#include "mat3.hxx"
+#include "mat4.hxx"
+
+namespace pre
+{
+	/// @brief Rotation quaternion stored (x, y, z, w) like glm::quat's default layout
+	template<typename T>
+	struct alignas(4 * sizeof(T)) quat
+	{
+	public:
+		T x;
+		T y;
+		T z;
+		T w;
+
+	public:
+		constexpr quat() noexcept;
+		constexpr explicit quat(T cx, T cy, T cz, T cw) noexcept;
+
+	public:
+		constexpr quat<T> operator*(const quat<T>& q) const noexcept;
+		constexpr vec3<T> operator*(const vec3<T>& v) const noexcept;
+
+		constexpr bool operator==(const quat<T>& q) const noexcept;
+		constexpr bool operator!=(const quat<T>& q) const noexcept;
+
+		constexpr quat<T> conjugate() const noexcept;
+
+		constexpr mat3<T> to_mat3() const noexcept;
+		constexpr mat4<T> to_mat4() const noexcept;
+
+		static quat<T> axis_angle(const vec3<T>& axis, T radians) noexcept;
+	};
+
+	using quatf = quat<float>;
+}
+
+template<typename T>
+constexpr pre::quat<T>::quat() noexcept
+	: x(0), y(0), z(0), w(1)
+{
+}
+
+template<typename T>
+constexpr pre::quat<T>::quat(T cx, T cy, T cz, T cw) noexcept
+	: x(cx), y(cy), z(cz), w(cw)
+{
+}
+
+template<typename T>
+constexpr pre::quat<T> pre::quat<T>::operator*(const quat<T>& q) const noexcept
+{
+	return pre::quat<T>(
+			w * q.x + x * q.w + y * q.z - z * q.y,
+			w * q.y - x * q.z + y * q.w + z * q.x,
+			w * q.z + x * q.y - y * q.x + z * q.w,
+			w * q.w - x * q.x - y * q.y - z * q.z);
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::quat<T>::operator*(const vec3<T>& v) const noexcept
+{
+	// v + 2w(u x v) + 2u x (u x v)
+	pre::vec3<T> u(x, y, z);
+	pre::vec3<T> uv = pre::cross(u, v);
+	pre::vec3<T> uuv = pre::cross(u, uv);
+	return v + (uv * w + uuv) * T(2);
+}
+
+template<typename T>
+constexpr bool pre::quat<T>::operator==(const quat<T>& q) const noexcept
+{
+	return x == q.x && y == q.y && z == q.z && w == q.w;
+}
+
+template<typename T>
+constexpr bool pre::quat<T>::operator!=(const quat<T>& q) const noexcept
+{
+	return !(*this == q);
+}
+
+template<typename T>
+constexpr pre::quat<T> pre::quat<T>::conjugate() const noexcept
+{
+	return pre::quat<T>(-x, -y, -z, w);
+}
+
+template<typename T>
+constexpr pre::mat3<T> pre::quat<T>::to_mat3() const noexcept
+{
+	T xx = x * x, yy = y * y, zz = z * z;
+	T xy = x * y, xz = x * z, yz = y * z;
+	T wx = w * x, wy = w * y, wz = w * z;
+
+	return pre::mat3<T>(
+			vec3<T>(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy)),
+			vec3<T>(2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx)),
+			vec3<T>(2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy)));
+}
+
+template<typename T>
+constexpr pre::mat4<T> pre::quat<T>::to_mat4() const noexcept
+{
+	return pre::mat4<T>(to_mat3());
+}
+
+template<typename T>
+pre::quat<T> pre::quat<T>::axis_angle(const vec3<T>& axis, T radians) noexcept
+{
+	pre::vec3<T> n = pre::normalize(axis) * std::sin(radians / 2);
+	return pre::quat<T>(n.x, n.y, n.z, std::cos(radians / 2));
+}
+
+#endif //PHUSIS_QUAT_HXX
@@ -0,0 +1,27 @@
+#ifndef PHUSIS_SIMD_HXX
+#define PHUSIS_SIMD_HXX
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PRE_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PRE_NEON 1
+#endif
+
+// run-time selected kernel variants: PRE_TARGET compiles one function for an extension the
+// build does not assume, PRE_SUPPORTS checks the executing cpu before calling it
+#if defined(PHUSIS_ARCH_DISPATCH) && PRE_SSE && (defined(__GNUC__) || defined(__clang__))
+#define PRE_DISPATCH 1
+#define PRE_TARGET(ext) __attribute__((target(ext)))
+#define PRE_SUPPORTS(ext) __builtin_cpu_supports(ext)
+#endif
+
+// constexpr functions take the scalar path at compile time and the vector path at run time
+#if defined(__GNUC__) || defined(__clang__)
+#define PRE_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define PRE_CONSTANT_EVALUATED() true
+#endif
+
+#endif //PHUSIS_SIMD_HXX
@@ -0,0 +1,68 @@
+#ifndef PHUSIS_SPAN_HXX
+#define PHUSIS_SPAN_HXX
+
+#include "fw.hxx"
+
+namespace pre
+{
+	/// @brief Non-owning view over contiguous elements (std::span stand-in for C++17)
+	template<typename T>
+	class span
+	{
+	private:
+		T* _data;
+		size_t _size;
+
+	public:
+		constexpr span() noexcept : _data(nullptr), _size(0)
+		{
+		}
+
+		constexpr span(T* data, size_t size) noexcept : _data(data), _size(size)
+		{
+		}
+
+		template<typename C, typename = decltype(std::declval<C&>().data())>
+		constexpr span(C& c) noexcept : _data(c.data()), _size(c.size())
+		{
+		}
+
+		template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+		constexpr span(const span<U>& other) noexcept : _data(other.data()), _size(other.size())
+		{
+		}
+
+	public:
+		constexpr T* data() const noexcept
+		{
+			return _data;
+		}
+
+		constexpr size_t size() const noexcept
+		{
+			return _size;
+		}
+
+		constexpr T& operator[](size_t i) const noexcept
+		{
+			return _data[i];
+		}
+
+		constexpr T* begin() const noexcept
+		{
+			return _data;
+		}
+
+		constexpr T* end() const noexcept
+		{
+			return _data + _size;
+		}
+
+		constexpr span<T> subspan(size_t offset, size_t count) const noexcept
+		{
+			return span<T>(_data + offset, count);
+		}
+	};
+}
+
+#endif //PHUSIS_SPAN_HXX
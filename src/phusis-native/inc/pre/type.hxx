@@ -7,7 +7,7 @@ namespace pre
 	class type
 	{
 	public:
-		static const T& __default;
+		static constexpr T __default{};
 	};
 }
 
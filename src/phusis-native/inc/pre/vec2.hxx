@@ -14,72 +14,118 @@ namespace pre
 		T y;
 
 	public:
-		vec2() noexcept;
-		explicit vec2(T cx, T cy) noexcept;
-		vec2(const vec2<T>& other) noexcept;
+		constexpr vec2() noexcept;
+		constexpr explicit vec2(T s) noexcept;
+		constexpr explicit vec2(T cx, T cy) noexcept;
+		constexpr vec2(const vec2<T>& other) noexcept = default;
 
 	public:
-		vec2<T> operator+(vec2<T> v) noexcept;
-		vec2<T> operator-(vec2<T> v) noexcept;
-		vec2<T> operator*(T v) noexcept;
-		vec2<T> operator/(T v) noexcept;
+		constexpr T& operator[](size_t i) noexcept;
+		constexpr const T& operator[](size_t i) const noexcept;
 
-		vec2<T>& operator=(const vec2<T>& v) noexcept;
+		constexpr vec2<T> operator+(const vec2<T>& v) const noexcept;
+		constexpr vec2<T> operator-(const vec2<T>& v) const noexcept;
+		constexpr vec2<T> operator*(const vec2<T>& v) const noexcept;
+		constexpr vec2<T> operator*(T v) const noexcept;
+		constexpr vec2<T> operator/(T v) const noexcept;
+		constexpr vec2<T> operator-() const noexcept;
+
+		constexpr bool operator==(const vec2<T>& v) const noexcept;
+		constexpr bool operator!=(const vec2<T>& v) const noexcept;
+
+		constexpr vec2<T>& operator=(const vec2<T>& v) noexcept = default;
 	};
 
+	template<typename T>
+	constexpr T dot(const vec2<T>& a, const vec2<T>& b) noexcept;
+
 	using vec2i = vec2<int32_t>;
 	using vec2u = vec2<uint32_t>;
+	using vec2f = vec2<float>;
 }
 
 template<typename T>
-pre::vec2<T>::vec2() noexcept
+constexpr pre::vec2<T>::vec2() noexcept
 	: x(pre::type<T>::__default), y(pre::type<T>::__default)
 {
+}
 
+template<typename T>
+constexpr pre::vec2<T>::vec2(T s) noexcept
+	: x(s), y(s)
+{
 }
 
 template<typename T>
-pre::vec2<T>::vec2(T cx, T cy) noexcept
+constexpr pre::vec2<T>::vec2(T cx, T cy) noexcept
 	: x(cx), y(cy)
 {
 }
 
 template<typename T>
-pre::vec2<T>::vec2(const vec2<T>& other) noexcept
-	: x(other.x), y(other.y)
+constexpr T& pre::vec2<T>::operator[](size_t i) noexcept
 {
+	return i == 0 ? x : y;
 }
 
 template<typename T>
-pre::vec2<T> pre::vec2<T>::operator+(vec2<T> v) noexcept
+constexpr const T& pre::vec2<T>::operator[](size_t i) const noexcept
+{
+	return i == 0 ? x : y;
+}
+
+template<typename T>
+constexpr pre::vec2<T> pre::vec2<T>::operator+(const vec2<T>& v) const noexcept
 {
 	return pre::vec2<T>(x + v.x, y + v.y);
 }
 
 template<typename T>
-pre::vec2<T> pre::vec2<T>::operator-(vec2<T> v) noexcept
+constexpr pre::vec2<T> pre::vec2<T>::operator-(const vec2<T>& v) const noexcept
 {
 	return pre::vec2<T>(x - v.x, y - v.y);
 }
 
 template<typename T>
-pre::vec2<T> pre::vec2<T>::operator*(T v) noexcept
+constexpr pre::vec2<T> pre::vec2<T>::operator*(const vec2<T>& v) const noexcept
+{
+	return pre::vec2<T>(x * v.x, y * v.y);
+}
+
+template<typename T>
+constexpr pre::vec2<T> pre::vec2<T>::operator*(T v) const noexcept
 {
 	return pre::vec2<T>(x * v, y * v);
 }
 
 template<typename T>
-pre::vec2<T> pre::vec2<T>::operator/(T v) noexcept
+constexpr pre::vec2<T> pre::vec2<T>::operator/(T v) const noexcept
 {
 	return pre::vec2<T>(x / v, y / v);
 }
 
 template<typename T>
-pre::vec2<T>& pre::vec2<T>::operator=(const vec2<T>& v) noexcept
+constexpr pre::vec2<T> pre::vec2<T>::operator-() const noexcept
+{
+	return pre::vec2<T>(-x, -y);
+}
+
+template<typename T>
+constexpr bool pre::vec2<T>::operator==(const vec2<T>& v) const noexcept
+{
+	return x == v.x && y == v.y;
+}
+
+template<typename T>
+constexpr bool pre::vec2<T>::operator!=(const vec2<T>& v) const noexcept
+{
+	return !(*this == v);
+}
+
+template<typename T>
+constexpr T pre::dot(const vec2<T>& a, const vec2<T>& b) noexcept
 {
-	this->x = v.x;
-	this->y = v.y;
-	return *this;
+	return a.x * b.x + a.y * b.y;
 }
 
 #endif //PHUSIS_VEC2_HXX
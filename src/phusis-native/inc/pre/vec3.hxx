@@ -0,0 +1,201 @@
+#ifndef PHUSIS_VEC3_HXX
+#define PHUSIS_VEC3_HXX
+
+#include "fw.hxx"
+#include "type.hxx"
+#include "vec2.hxx"
+
+namespace pre
+{
+	template<typename T>
+	struct vec3
+	{
+	public:
+		T x;
+		T y;
+		T z;
+
+	public:
+		constexpr vec3() noexcept;
+		constexpr explicit vec3(T s) noexcept;
+		constexpr explicit vec3(T cx, T cy, T cz) noexcept;
+		constexpr explicit vec3(const vec2<T>& v, T cz) noexcept;
+		constexpr vec3(const vec3<T>& other) noexcept = default;
+
+	public:
+		constexpr T& operator[](size_t i) noexcept;
+		constexpr const T& operator[](size_t i) const noexcept;
+
+		constexpr vec3<T> operator+(const vec3<T>& v) const noexcept;
+		constexpr vec3<T> operator-(const vec3<T>& v) const noexcept;
+		constexpr vec3<T> operator*(const vec3<T>& v) const noexcept;
+		constexpr vec3<T> operator*(T v) const noexcept;
+		constexpr vec3<T> operator/(T v) const noexcept;
+		constexpr vec3<T> operator-() const noexcept;
+
+		constexpr vec3<T>& operator+=(const vec3<T>& v) noexcept;
+		constexpr vec3<T>& operator-=(const vec3<T>& v) noexcept;
+		constexpr vec3<T>& operator*=(T v) noexcept;
+
+		constexpr bool operator==(const vec3<T>& v) const noexcept;
+		constexpr bool operator!=(const vec3<T>& v) const noexcept;
+
+		constexpr vec3<T>& operator=(const vec3<T>& v) noexcept = default;
+	};
+
+	template<typename T>
+	constexpr T dot(const vec3<T>& a, const vec3<T>& b) noexcept;
+
+	template<typename T>
+	constexpr vec3<T> cross(const vec3<T>& a, const vec3<T>& b) noexcept;
+
+	template<typename T>
+	T length(const vec3<T>& v) noexcept;
+
+	template<typename T>
+	vec3<T> normalize(const vec3<T>& v) noexcept;
+
+	using vec3i = vec3<int32_t>;
+	using vec3u = vec3<uint32_t>;
+	using vec3f = vec3<float>;
+}
+
+template<typename T>
+constexpr pre::vec3<T>::vec3() noexcept
+	: x(pre::type<T>::__default), y(pre::type<T>::__default), z(pre::type<T>::__default)
+{
+}
+
+template<typename T>
+constexpr pre::vec3<T>::vec3(T s) noexcept
+	: x(s), y(s), z(s)
+{
+}
+
+template<typename T>
+constexpr pre::vec3<T>::vec3(T cx, T cy, T cz) noexcept
+	: x(cx), y(cy), z(cz)
+{
+}
+
+template<typename T>
+constexpr pre::vec3<T>::vec3(const vec2<T>& v, T cz) noexcept
+	: x(v.x), y(v.y), z(cz)
+{
+}
+
+template<typename T>
+constexpr T& pre::vec3<T>::operator[](size_t i) noexcept
+{
+	return i == 0 ? x : i == 1 ? y : z;
+}
+
+template<typename T>
+constexpr const T& pre::vec3<T>::operator[](size_t i) const noexcept
+{
+	return i == 0 ? x : i == 1 ? y : z;
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::vec3<T>::operator+(const vec3<T>& v) const noexcept
+{
+	return pre::vec3<T>(x + v.x, y + v.y, z + v.z);
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::vec3<T>::operator-(const vec3<T>& v) const noexcept
+{
+	return pre::vec3<T>(x - v.x, y - v.y, z - v.z);
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::vec3<T>::operator*(const vec3<T>& v) const noexcept
+{
+	return pre::vec3<T>(x * v.x, y * v.y, z * v.z);
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::vec3<T>::operator*(T v) const noexcept
+{
+	return pre::vec3<T>(x * v, y * v, z * v);
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::vec3<T>::operator/(T v) const noexcept
+{
+	return pre::vec3<T>(x / v, y / v, z / v);
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::vec3<T>::operator-() const noexcept
+{
+	return pre::vec3<T>(-x, -y, -z);
+}
+
+template<typename T>
+constexpr pre::vec3<T>& pre::vec3<T>::operator+=(const vec3<T>& v) noexcept
+{
+	x += v.x;
+	y += v.y;
+	z += v.z;
+	return *this;
+}
+
+template<typename T>
+constexpr pre::vec3<T>& pre::vec3<T>::operator-=(const vec3<T>& v) noexcept
+{
+	x -= v.x;
+	y -= v.y;
+	z -= v.z;
+	return *this;
+}
+
+template<typename T>
+constexpr pre::vec3<T>& pre::vec3<T>::operator*=(T v) noexcept
+{
+	x *= v;
+	y *= v;
+	z *= v;
+	return *this;
+}
+
+template<typename T>
+constexpr bool pre::vec3<T>::operator==(const vec3<T>& v) const noexcept
+{
+	return x == v.x && y == v.y && z == v.z;
+}
+
+template<typename T>
+constexpr bool pre::vec3<T>::operator!=(const vec3<T>& v) const noexcept
+{
+	return !(*this == v);
+}
+
+template<typename T>
+constexpr T pre::dot(const vec3<T>& a, const vec3<T>& b) noexcept
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::cross(const vec3<T>& a, const vec3<T>& b) noexcept
+{
+	return pre::vec3<T>(
+			a.y * b.z - a.z * b.y,
+			a.z * b.x - a.x * b.z,
+			a.x * b.y - a.y * b.x);
+}
+
+template<typename T>
+T pre::length(const vec3<T>& v) noexcept
+{
+	return std::sqrt(pre::dot(v, v));
+}
+
+template<typename T>
+pre::vec3<T> pre::normalize(const vec3<T>& v) noexcept
+{
+	return v / pre::length(v);
+}
+
+#endif //PHUSIS_VEC3_HXX
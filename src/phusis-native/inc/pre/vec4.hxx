@@ -0,0 +1,201 @@
+#ifndef PHUSIS_VEC4_HXX
+#define PHUSIS_VEC4_HXX
+
+#include "fw.hxx"
+#include "type.hxx"
+#include "vec3.hxx"
+
+namespace pre
+{
+	template<typename T>
+	struct alignas(4 * sizeof(T)) vec4
+	{
+	public:
+		T x;
+		T y;
+		T z;
+		T w;
+
+	public:
+		constexpr vec4() noexcept;
+		constexpr explicit vec4(T s) noexcept;
+		constexpr explicit vec4(T cx, T cy, T cz, T cw) noexcept;
+		constexpr explicit vec4(const vec3<T>& v, T cw) noexcept;
+		constexpr vec4(const vec4<T>& other) noexcept = default;
+
+	public:
+		constexpr T& operator[](size_t i) noexcept;
+		constexpr const T& operator[](size_t i) const noexcept;
+
+		constexpr vec3<T> xyz() const noexcept;
+
+		constexpr vec4<T> operator+(const vec4<T>& v) const noexcept;
+		constexpr vec4<T> operator-(const vec4<T>& v) const noexcept;
+		constexpr vec4<T> operator*(const vec4<T>& v) const noexcept;
+		constexpr vec4<T> operator*(T v) const noexcept;
+		constexpr vec4<T> operator/(T v) const noexcept;
+		constexpr vec4<T> operator-() const noexcept;
+
+		constexpr vec4<T>& operator+=(const vec4<T>& v) noexcept;
+		constexpr vec4<T>& operator-=(const vec4<T>& v) noexcept;
+		constexpr vec4<T>& operator*=(T v) noexcept;
+
+		constexpr bool operator==(const vec4<T>& v) const noexcept;
+		constexpr bool operator!=(const vec4<T>& v) const noexcept;
+
+		constexpr vec4<T>& operator=(const vec4<T>& v) noexcept = default;
+	};
+
+	template<typename T>
+	constexpr T dot(const vec4<T>& a, const vec4<T>& b) noexcept;
+
+	template<typename T>
+	T length(const vec4<T>& v) noexcept;
+
+	template<typename T>
+	vec4<T> normalize(const vec4<T>& v) noexcept;
+
+	using vec4i = vec4<int32_t>;
+	using vec4u = vec4<uint32_t>;
+	using vec4f = vec4<float>;
+}
+
+template<typename T>
+constexpr pre::vec4<T>::vec4() noexcept
+	: x(pre::type<T>::__default), y(pre::type<T>::__default), z(pre::type<T>::__default), w(pre::type<T>::__default)
+{
+}
+
+template<typename T>
+constexpr pre::vec4<T>::vec4(T s) noexcept
+	: x(s), y(s), z(s), w(s)
+{
+}
+
+template<typename T>
+constexpr pre::vec4<T>::vec4(T cx, T cy, T cz, T cw) noexcept
+	: x(cx), y(cy), z(cz), w(cw)
+{
+}
+
+template<typename T>
+constexpr pre::vec4<T>::vec4(const vec3<T>& v, T cw) noexcept
+	: x(v.x), y(v.y), z(v.z), w(cw)
+{
+}
+
+template<typename T>
+constexpr pre::vec3<T> pre::vec4<T>::xyz() const noexcept
+{
+	return pre::vec3<T>(x, y, z);
+}
+
+template<typename T>
+constexpr T& pre::vec4<T>::operator[](size_t i) noexcept
+{
+	return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+}
+
+template<typename T>
+constexpr const T& pre::vec4<T>::operator[](size_t i) const noexcept
+{
+	return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+}
+
+template<typename T>
+constexpr pre::vec4<T> pre::vec4<T>::operator+(const vec4<T>& v) const noexcept
+{
+	return pre::vec4<T>(x + v.x, y + v.y, z + v.z, w + v.w);
+}
+
+template<typename T>
+constexpr pre::vec4<T> pre::vec4<T>::operator-(const vec4<T>& v) const noexcept
+{
+	return pre::vec4<T>(x - v.x, y - v.y, z - v.z, w - v.w);
+}
+
+template<typename T>
+constexpr pre::vec4<T> pre::vec4<T>::operator*(const vec4<T>& v) const noexcept
+{
+	return pre::vec4<T>(x * v.x, y * v.y, z * v.z, w * v.w);
+}
+
+template<typename T>
+constexpr pre::vec4<T> pre::vec4<T>::operator*(T v) const noexcept
+{
+	return pre::vec4<T>(x * v, y * v, z * v, w * v);
+}
+
+template<typename T>
+constexpr pre::vec4<T> pre::vec4<T>::operator/(T v) const noexcept
+{
+	return pre::vec4<T>(x / v, y / v, z / v, w / v);
+}
+
+template<typename T>
+constexpr pre::vec4<T> pre::vec4<T>::operator-() const noexcept
+{
+	return pre::vec4<T>(-x, -y, -z, -w);
+}
+
+template<typename T>
+constexpr pre::vec4<T>& pre::vec4<T>::operator+=(const vec4<T>& v) noexcept
+{
+	x += v.x;
+	y += v.y;
+	z += v.z;
+	w += v.w;
+	return *this;
+}
+
+template<typename T>
+constexpr pre::vec4<T>& pre::vec4<T>::operator-=(const vec4<T>& v) noexcept
+{
+	x -= v.x;
+	y -= v.y;
+	z -= v.z;
+	w -= v.w;
+	return *this;
+}
+
+template<typename T>
+constexpr pre::vec4<T>& pre::vec4<T>::operator*=(T v) noexcept
+{
+	x *= v;
+	y *= v;
+	z *= v;
+	w *= v;
+	return *this;
+}
+
+template<typename T>
+constexpr bool pre::vec4<T>::operator==(const vec4<T>& v) const noexcept
+{
+	return x == v.x && y == v.y && z == v.z && w == v.w;
+}
+
+template<typename T>
+constexpr bool pre::vec4<T>::operator!=(const vec4<T>& v) const noexcept
+{
+	return !(*this == v);
+}
+
+template<typename T>
+constexpr T pre::dot(const vec4<T>& a, const vec4<T>& b) noexcept
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+template<typename T>
+T pre::length(const vec4<T>& v) noexcept
+{
+	return std::sqrt(pre::dot(v, v));
+}
+
+template<typename T>
+pre::vec4<T> pre::normalize(const vec4<T>& v) noexcept
+{
+	return v / pre::length(v);
+}
+
+#endif //PHUSIS_VEC4_HXX
@@ -0,0 +1,13 @@
+#ifndef PHUSIS_ALLOCATION_HXX
+#define PHUSIS_ALLOCATION_HXX
+
+#include "fw.hxx"
+
+namespace sys
+{
+	/// @brief Number of global operator new calls so far, aligned and nothrow forms included.
+	/// Only counted when built with PHUSIS_COUNT_ALLOCATIONS; otherwise always 0.
+	uint64_t allocations() noexcept;
+}
+
+#endif //PHUSIS_ALLOCATION_HXX
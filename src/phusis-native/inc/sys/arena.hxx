@@ -0,0 +1,95 @@
+#ifndef PHUSIS_ARENA_HXX
+#define PHUSIS_ARENA_HXX
+
+#include "fw.hxx"
+
+namespace sys
+{
+	/// @brief Linear bump allocator for data that dies together (e.g. one frame).
+	/// Memory is only returned on reset(); overflow blocks are folded into one block
+	/// on reset, so a steady workload stops touching the heap after a few cycles.
+	class arena
+	{
+	private:
+		struct block
+		{
+			block* next;
+			size_t size;
+		};
+
+		block* _head = nullptr;
+		size_t _used = 0;
+		size_t _total = 0;
+		size_t _bytes = 0;
+
+	public:
+		arena() noexcept = default;
+		arena(const arena&) = delete;
+		arena(arena&& other) noexcept;
+		~arena() noexcept;
+
+		arena& operator=(const arena&) = delete;
+
+	private:
+		static block* acquire(size_t size) noexcept;
+		static void release(block* b) noexcept;
+
+	public:
+		void* allocate(size_t size, size_t align) noexcept;
+		void reset() noexcept;
+
+		[[nodiscard]] size_t used() const noexcept;
+		[[nodiscard]] size_t capacity() const noexcept;
+	};
+
+	template<typename T>
+	class arena_allocator
+	{
+		template<typename U>
+		friend class arena_allocator;
+
+	private:
+		arena* _arena;
+
+	public:
+		using value_type = T;
+
+		explicit arena_allocator(arena& a) noexcept : _arena(&a)
+		{
+		}
+
+		template<typename U>
+		arena_allocator(const arena_allocator<U>& other) noexcept : _arena(other._arena)
+		{
+		}
+
+		T* allocate(size_t n)
+		{
+			void* p = _arena->allocate(n * sizeof(T), alignof(T));
+			if (!p)
+				throw std::bad_alloc();
+			return static_cast<T*>(p);
+		}
+
+		void deallocate(T*, size_t) noexcept
+		{
+		}
+
+		template<typename U>
+		bool operator==(const arena_allocator<U>& other) const noexcept
+		{
+			return _arena == other._arena;
+		}
+
+		template<typename U>
+		bool operator!=(const arena_allocator<U>& other) const noexcept
+		{
+			return _arena != other._arena;
+		}
+	};
+
+	template<typename T>
+	using arena_vector = std::vector<T, arena_allocator<T>>;
+}
+
+#endif //PHUSIS_ARENA_HXX
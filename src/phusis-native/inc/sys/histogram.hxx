@@ -0,0 +1,43 @@
+#ifndef PHUSIS_HISTOGRAM_HXX
+#define PHUSIS_HISTOGRAM_HXX
+
+#include "fw.hxx"
+
+namespace sys
+{
+	/// @brief Lock-free log-linear histogram over the whole uint64_t range.
+	/// Every power of two is split into 32 linear buckets, so any quantile is within 1/32 of the
+	/// recorded value; values below 32 are exact. Any thread may record while another reads.
+	class histogram
+	{
+	public:
+		static constexpr uint32_t sub_bits = 5;
+		static constexpr uint32_t sub_count = 1u << sub_bits;
+		// one exact group below sub_count, then one group per octave up to bit 63
+		static constexpr uint32_t bucket_count = sub_count * (64 - sub_bits + 1);
+
+	private:
+		std::array<std::atomic<uint64_t>, bucket_count> _buckets{};
+		std::atomic<uint64_t> _count{ 0 };
+
+	public:
+		/// @brief Count one value; a couple of relaxed atomic adds
+		void record(uint64_t value) noexcept;
+
+		/// @brief Forget everything; values recorded meanwhile may or may not survive
+		void clear() noexcept;
+
+		[[nodiscard]] uint64_t count() const noexcept;
+
+		/// @brief Smallest bucket bound at or above a fraction q of the recorded values
+		/// @return 0 when empty
+		[[nodiscard]] uint64_t quantile(double q) const noexcept;
+
+		[[nodiscard]] static uint32_t index(uint64_t value) noexcept;
+
+		/// @brief Largest value counted in bucket idx
+		[[nodiscard]] static uint64_t upper(uint32_t idx) noexcept;
+	};
+}
+
+#endif //PHUSIS_HISTOGRAM_HXX
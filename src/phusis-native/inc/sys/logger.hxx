@@ -61,6 +61,9 @@ namespace sys
 	{
 	public:
 		loggerctx __head(loggerctrl ctrl, const char* file, int32_t line);
+
+		/// @brief Write every message from now on to out instead of std::cout, e.g. to keep stdout for data
+		void redirect(std::ostream& out) noexcept;
 	};
 
 	[[maybe_unused]]
@@ -0,0 +1,26 @@
+#ifndef PHUSIS_PACER_HXX
+#define PHUSIS_PACER_HXX
+
+#include "fw.hxx"
+
+namespace sys
+{
+	/// @brief Frame rate limiter with a fixed cadence.
+	/// Sleeps most of the interval and spins the last stretch, since sleep granularity is too
+	/// coarse for frame pacing; resynchronizes instead of bursting after a long stall.
+	class pacer
+	{
+	private:
+		std::chrono::steady_clock::duration _interval{ 0 };
+		std::chrono::steady_clock::time_point _next{};
+
+	public:
+		/// @param hz target rate; 0 disables the limiter
+		void limit(double hz) noexcept;
+
+		/// @brief Block until the next frame is due
+		void wait() noexcept;
+	};
+}
+
+#endif //PHUSIS_PACER_HXX
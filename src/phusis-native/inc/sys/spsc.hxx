@@ -0,0 +1,109 @@
+#ifndef PHUSIS_SPSC_HXX
+#define PHUSIS_SPSC_HXX
+
+#include "fw.hxx"
+
+namespace sys
+{
+	/// @brief Bounded lock-free ring between exactly one producer and one consumer thread.
+	/// Neither side ever blocks; push and acquire fail or grant less when full, pop when empty.
+	/// The producer either pushes one value or acquires a contiguous run of slots, fills it and publishes;
+	/// the consumer either pops one value or drains everything published so far.
+	template<typename T>
+	class spsc
+	{
+	private:
+		// cursors only grow; slot = cursor & _mask. head is the producer's, tail the consumer's
+		alignas(64) std::atomic<uint64_t> _head{ 0 };
+		alignas(64) std::atomic<uint64_t> _tail{ 0 };
+
+		// producer side only
+		alignas(64) uint64_t _granted = 0;
+
+		std::vector<T> _slots;
+		uint64_t _mask;
+
+	public:
+		/// @param capacityLog2 ring holds 2^capacityLog2 values
+		explicit spsc(uint32_t capacityLog2) noexcept
+				: _slots(size_t(1) << capacityLog2), _mask((uint64_t(1) << capacityLog2) - 1)
+		{
+		}
+
+		spsc(const spsc&) = delete;
+		spsc& operator=(const spsc&) = delete;
+
+	public:
+		/// @brief Producer
+		bool push(const T& value) noexcept
+		{
+			uint64_t head = _head.load(std::memory_order_relaxed);
+			if (head - _tail.load(std::memory_order_acquire) > _mask)
+				return false;
+
+			_slots[head & _mask] = value;
+			_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// @brief Producer: up to n free slots, contiguous in memory
+		/// @param granted slots actually available; fewer than n at the ring's end or when full
+		T* acquire(uint32_t n, uint32_t& granted) noexcept
+		{
+			uint64_t head = _head.load(std::memory_order_relaxed);
+			uint64_t tail = _tail.load(std::memory_order_acquire);
+
+			uint64_t capacity = _mask + 1;
+			uint64_t start = head & _mask;
+			uint64_t available = std::min(capacity - (head - tail), capacity - start);
+
+			granted = static_cast<uint32_t>(std::min<uint64_t>(n, available));
+			_granted = granted;
+			return _slots.data() + start;
+		}
+
+		/// @brief Producer: make the first n acquired slots visible to the consumer
+		void publish(uint32_t n) noexcept
+		{
+			uint64_t count = std::min<uint64_t>(n, _granted);
+			_granted = 0;
+
+			_head.store(_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+		}
+
+		/// @brief Consumer
+		bool pop(T& value) noexcept
+		{
+			uint64_t tail = _tail.load(std::memory_order_relaxed);
+			if (tail == _head.load(std::memory_order_acquire))
+				return false;
+
+			value = _slots[tail & _mask];
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// @brief Consumer: f(const T&) for every published value in order, then hand their slots back
+		/// @return number of values drained
+		template<typename F>
+		uint64_t drain(F&& f) noexcept
+		{
+			uint64_t tail = _tail.load(std::memory_order_relaxed);
+			uint64_t head = _head.load(std::memory_order_acquire);
+
+			for (uint64_t cursor = tail; cursor != head; ++cursor)
+				f(static_cast<const T&>(_slots[cursor & _mask]));
+
+			// only after they have been read
+			_tail.store(head, std::memory_order_release);
+			return head - tail;
+		}
+
+		[[nodiscard]] uint64_t capacity() const noexcept
+		{
+			return _mask + 1;
+		}
+	};
+}
+
+#endif //PHUSIS_SPSC_HXX
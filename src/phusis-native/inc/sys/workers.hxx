@@ -0,0 +1,61 @@
+#ifndef PHUSIS_WORKERS_HXX
+#define PHUSIS_WORKERS_HXX
+
+#include "fw.hxx"
+
+namespace sys
+{
+	/// @brief Fixed set of persistent threads; run() hands every worker its own index and
+	/// returns once all of them are done. A worker index always maps to the same OS thread,
+	/// so per-worker state (command pools, arenas) never needs a lock.
+	class workers
+	{
+	public:
+		static constexpr uint32_t npos = UINT32_MAX;
+
+	private:
+		using task = void (*)(void* context, uint32_t index);
+
+		std::vector<std::thread> _threads{};
+
+		std::mutex _mutex{};
+		std::condition_variable _wake{};
+		std::condition_variable _done{};
+
+		std::atomic<uint64_t> _generation{ 0 };
+		uint32_t _remaining = 0;
+		bool _stop = false;
+
+		// spinning only pays off when no worker competes with another for a core
+		uint32_t _spin = 0;
+
+		task _task = nullptr;
+		void* _context = nullptr;
+
+	private:
+		void loop(uint32_t index) noexcept;
+		void dispatch(task fn, void* context) noexcept;
+
+	public:
+		explicit workers(uint32_t count);
+		workers(const workers&) = delete;
+		~workers() noexcept;
+
+		workers& operator=(const workers&) = delete;
+
+		/// @brief Call fn(index) once on every worker and wait for all of them
+		template<typename F>
+		void run(F&& fn) noexcept
+		{
+			using function = std::remove_reference_t<F>;
+			dispatch([](void* context, uint32_t index) { (*static_cast<function*>(context))(index); }, &fn);
+		}
+
+		[[nodiscard]] uint32_t size() const noexcept;
+
+		/// @brief Index of the calling worker, npos outside of any worker
+		[[nodiscard]] static uint32_t current() noexcept;
+	};
+}
+
+#endif //PHUSIS_WORKERS_HXX
@@ -1,9 +1,73 @@
 #include <cstring>
 #include "phusis/internal/constantblock.hxx"
+#include "phusis/internal/vkstatemachine.hxx"
 #include "phusis/application.hxx"
 #include "sys/logger.hxx"
 #include "sys/os.hxx"
 
+// per frame in flight; 100k bindless objects take 9.6 MB of it
+constexpr VkDeviceSize UploadRegion = 16ull << 20;
+
+// the window thread wakes this often without events, only to notice glfwSetWindowShouldClose
+constexpr double EventTimeout = .25;
+// the render thread checks a minimized window for events this often
+constexpr std::chrono::milliseconds IdleInterval(100);
+
+// recorded by the render thread after every presented frame; times in nanoseconds, exported in seconds
+struct FrameMetrics
+{
+	Phusis::Metric& Frame;
+	Phusis::Metric& Prepare;
+	Phusis::Metric& Record;
+	Phusis::Metric& Gpu;
+	Phusis::Metric& Latency;
+	Phusis::Metric& Draws;
+	Phusis::Metric& Culled;
+	Phusis::Metric& CommandBuffers;
+	Phusis::Metric& ArenaBytes;
+	Phusis::Metric& UploadBytes;
+	Phusis::Metric& Allocations;
+};
+
+static FrameMetrics RegisterFrameMetrics(Phusis::MetricsRegistry& registry)
+{
+	return FrameMetrics{
+			registry.Register("phusis_frame_seconds", "Time between presented frames", 1e-9),
+			registry.Register("phusis_prepare_seconds", "CPU time preparing a frame's draws", 1e-9),
+			registry.Register("phusis_record_seconds", "CPU time recording a frame's secondary command buffers", 1e-9),
+			registry.Register("phusis_gpu_seconds", "GPU time executing a frame, absent without timestamp support", 1e-9),
+			registry.Register("phusis_input_latency_seconds", "Time from the input a frame reacts to until its present", 1e-9),
+			registry.Register("phusis_draws", "Draws recorded per frame"),
+			registry.Register("phusis_clusters_culled", "Meshlets culled on the CPU per frame"),
+			registry.Register("phusis_command_buffers", "Secondary command buffers recorded per frame"),
+			registry.Register("phusis_arena_bytes", "Worker arena bytes used per frame"),
+			registry.Register("phusis_upload_bytes", "Upload ring bytes used per frame"),
+			registry.Register("phusis_heap_allocations", "Heap allocations per frame, 0 unless counted at build time"),
+	};
+}
+
+static uint64_t Nanos(double micros) noexcept
+{
+	return static_cast<uint64_t>(std::max(micros, 0.) * 1000.);
+}
+
+// set on the thread running RenderLoop, which owns the scene while Run renders
+static thread_local bool rendering = false;
+
+static uint32_t MemoryType(const VkPhysicalDeviceMemoryProperties& properties, uint32_t bits, VkMemoryPropertyFlags flags) noexcept
+{
+	for (uint32_t i = 0; i < properties.memoryTypeCount; ++i)
+		if ((bits & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags)
+			return i;
+
+	return UINT32_MAX;
+}
+
+static Phusis::Application* Self(GLFWwindow* window) noexcept
+{
+	return static_cast<Phusis::Application*>(glfwGetWindowUserPointer(window));
+}
+
 Phusis::Application::Application(
 		const std::vector<std::string>& requiredLayers,
 		const std::vector<std::string>& requiredExtensions,
@@ -49,6 +113,29 @@ bool Phusis::Application::GLFWCreateWindow() noexcept
 		return false;
 	}
 
+	glfwGetFramebufferSize(_window, &_framebufferWidth, &_framebufferHeight);
+
+	// everything the render thread needs to know about the window arrives through _events
+	glfwSetWindowUserPointer(_window, this);
+	glfwSetFramebufferSizeCallback(_window, [](GLFWwindow* window, int w, int h) {
+		Self(window)->Post(WindowEventType::Resize, w, h);
+	});
+	glfwSetWindowFocusCallback(_window, [](GLFWwindow* window, int focused) {
+		Self(window)->Post(WindowEventType::Focus, focused);
+	});
+	glfwSetWindowIconifyCallback(_window, [](GLFWwindow* window, int iconified) {
+		Self(window)->Post(WindowEventType::Iconify, iconified);
+	});
+	glfwSetKeyCallback(_window, [](GLFWwindow* window, int, int, int, int) {
+		Self(window)->Post(WindowEventType::Input);
+	});
+	glfwSetMouseButtonCallback(_window, [](GLFWwindow* window, int, int, int) {
+		Self(window)->Post(WindowEventType::Input);
+	});
+	glfwSetCursorPosCallback(_window, [](GLFWwindow* window, double, double) {
+		Self(window)->Post(WindowEventType::Input);
+	});
+
 	sys::log.head(sys::INFO) << "GLFW window created" << sys::EOM;
 
 	return true;
@@ -151,8 +238,15 @@ bool Phusis::Application::VkInitializeInstance() noexcept
 	for (size_t i = 0; i < cExt; ++i)
 		exts[i] = _requiredExtensions[i].c_str();
 
+	// 1.1 for vkGetPhysicalDeviceFeatures2
+	VkApplicationInfo app_info{};
+	app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	app_info.pEngineName = "phusis";
+	app_info.apiVersion = VK_API_VERSION_1_1;
+
 	VkInstanceCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	create_info.pApplicationInfo = &app_info;
 	create_info.enabledLayerCount = cLayer;
 	create_info.ppEnabledLayerNames = layers;
 	create_info.enabledExtensionCount = cExt;
@@ -226,24 +320,35 @@ bool Phusis::Application::VkInitializeLogicalDevice() noexcept
 	queueCreateInfo.queueCount = 1;
 	queueCreateInfo.pQueuePriorities = &priority;
 
-	static const std::array<const char*, 1> ext = {
+	std::vector<const char*> ext = {
 			VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 
+	static const std::array<const char*, 4> dynamicExt = {
+			VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+			VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+			VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+			VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME
+	};
+
 	uint32_t cExt;
 	vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &cExt, nullptr);
 
 	std::vector<VkExtensionProperties> extensions(cExt);
 	vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &cExt, &extensions[0]);
 
+	auto supported = [&extensions](const char* e)
+	{
+		for (const auto& extension: extensions)
+			if (strcmp(extension.extensionName, e) == 0)
+				return true;
+		return false;
+	};
+
 	bool failed = false;
 	for (const auto& e: ext)
 	{
-		uint32_t i;
-		for (i = 0; i < extensions.size(); ++i)
-			if (strcmp(extensions[i].extensionName, e) == 0)
-				break;
-		if (i == extensions.size())
+		if (!supported(e))
 		{
 			sys::log.head(sys::FAIL) << "D-EXT not matched: " << e << sys::EOM;
 			failed = true;
@@ -259,8 +364,123 @@ bool Phusis::Application::VkInitializeLogicalDevice() noexcept
 		return false;
 	}
 
+	// task / mesh shaders read meshlets and vertices through buffer device addresses
+	static const std::array<const char*, 4> meshExt = {
+			VK_EXT_MESH_SHADER_EXTENSION_NAME,
+			VK_KHR_SPIRV_1_4_EXTENSION_NAME,
+			VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME,
+			VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME
+	};
+
+	auto optional = [&supported](const auto& exts)
+	{
+		bool result = true;
+		for (const auto& e: exts)
+		{
+			if (supported(e))
+				continue;
+			sys::log.head(sys::VERB) << "D-EXT not matched: " << e << sys::EOM;
+			result = false;
+		}
+		return result;
+	};
+
+	// one global set of per-object data and an unbounded texture array, updated while frames are in flight
+	static const std::array<const char*, 2> bindlessExt = {
+			VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+			VK_KHR_MAINTENANCE_3_EXTENSION_NAME
+	};
+
+	bool dynamicRendering = optional(dynamicExt);
+	bool meshShading = optional(meshExt);
+	bool bindless = optional(bindlessExt);
+
+	VkPhysicalDeviceSynchronization2FeaturesKHR sync2{};
+	sync2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic{};
+	dynamic.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+
+	VkPhysicalDeviceMeshShaderFeaturesEXT mesh{};
+	mesh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+
+	VkPhysicalDeviceBufferDeviceAddressFeaturesKHR address{};
+	address.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexing{};
+	indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+	if (dynamicRendering || meshShading || bindless)
+	{
+		dynamic.pNext = &sync2;
+		sync2.pNext = &mesh;
+		mesh.pNext = &address;
+		address.pNext = &indexing;
+
+		VkPhysicalDeviceFeatures2 features{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &dynamic;
+		vkGetPhysicalDeviceFeatures2(PhysicalDevice, &features);
+
+		dynamicRendering = dynamicRendering && dynamic.dynamicRendering && sync2.synchronization2;
+		meshShading = meshShading && mesh.taskShader && mesh.meshShader && address.bufferDeviceAddress;
+		bindless = bindless && indexing.shaderSampledImageArrayNonUniformIndexing && indexing.runtimeDescriptorArray &&
+				   indexing.descriptorBindingPartiallyBound && indexing.descriptorBindingVariableDescriptorCount &&
+				   indexing.descriptorBindingSampledImageUpdateAfterBind && indexing.descriptorBindingUpdateUnusedWhilePending;
+	}
+
+	// the query filled in every feature the device has; chain only what is enabled
+	mesh = {};
+	mesh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+	mesh.taskShader = VK_TRUE;
+	mesh.meshShader = VK_TRUE;
+
+	address = {};
+	address.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+	address.bufferDeviceAddress = VK_TRUE;
+
+	indexing = {};
+	indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	indexing.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	indexing.runtimeDescriptorArray = VK_TRUE;
+	indexing.descriptorBindingPartiallyBound = VK_TRUE;
+	indexing.descriptorBindingVariableDescriptorCount = VK_TRUE;
+	indexing.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	indexing.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+	void* chain = nullptr;
+	if (dynamicRendering)
+	{
+		sync2.pNext = chain;
+		dynamic.pNext = &sync2;
+		chain = &dynamic;
+		ext.insert(ext.end(), dynamicExt.begin(), dynamicExt.end());
+	}
+	if (meshShading)
+	{
+		address.pNext = chain;
+		mesh.pNext = &address;
+		chain = &mesh;
+		ext.insert(ext.end(), meshExt.begin(), meshExt.end());
+	}
+	if (bindless)
+	{
+		indexing.pNext = chain;
+		chain = &indexing;
+		ext.insert(ext.end(), bindlessExt.begin(), bindlessExt.end());
+	}
+
+	// of the core features only multi-draw indirect, for the meshlet runs culled on the workers
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(PhysicalDevice, &supportedFeatures);
+
+	VkPhysicalDeviceFeatures core{};
+	core.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+
 	VkDeviceCreateInfo deviceCreateInfo{};
 	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceCreateInfo.pNext = chain;
+	deviceCreateInfo.pEnabledFeatures = &core;
 	deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(ext.size());
 	deviceCreateInfo.ppEnabledExtensionNames = &ext[0];
 	deviceCreateInfo.queueCreateInfoCount = 1;
@@ -274,6 +494,43 @@ bool Phusis::Application::VkInitializeLogicalDevice() noexcept
 		return false;
 	}
 
+	if (dynamicRendering)
+	{
+		CmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(
+				vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR"));
+		CmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(
+				vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR"));
+		CmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(
+				vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR"));
+
+		dynamicRendering = CmdBeginRendering && CmdEndRendering && CmdPipelineBarrier2;
+	}
+	DynamicRendering = dynamicRendering;
+
+	if (DynamicRendering)
+		sys::log.head(sys::INFO) << "dynamic rendering enabled" << sys::EOM;
+	else
+		sys::log.head(sys::INFO) << "dynamic rendering unavailable; falling back to render-pass" << sys::EOM;
+
+	if (meshShading)
+	{
+		CmdDrawMeshTasks = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(
+				vkGetDeviceProcAddr(device, "vkCmdDrawMeshTasksEXT"));
+		meshShading = CmdDrawMeshTasks;
+	}
+	MeshShading = meshShading;
+
+	if (MeshShading)
+		sys::log.head(sys::INFO) << "mesh shading enabled" << sys::EOM;
+	else
+		sys::log.head(sys::INFO) << "mesh shading unavailable; meshlets are culled on the CPU" << sys::EOM;
+
+	Bindless = bindless;
+	if (Bindless)
+		sys::log.head(sys::INFO) << "descriptor indexing enabled" << sys::EOM;
+	else
+		sys::log.head(sys::INFO) << "descriptor indexing unavailable; objects are drawn with push constants" << sys::EOM;
+
 	VkQueue queue;
 	vkGetDeviceQueue(device, queueFamilyIdx, 0, &queue);
 
@@ -281,6 +538,16 @@ bool Phusis::Application::VkInitializeLogicalDevice() noexcept
 	Queue = queue;
 	_queueFamilyIdx = queueFamilyIdx;
 
+	// frames measure their GPU time where the queue can write timestamps
+	VkPhysicalDeviceProperties physical;
+	vkGetPhysicalDeviceProperties(PhysicalDevice, &physical);
+	_timestampBits = properties[queueFamilyIdx].timestampValidBits;
+	_timestampPeriod = _timestampBits ? physical.limits.timestampPeriod : 0.f;
+
+	DrawIndirectCount = core.multiDrawIndirect ? physical.limits.maxDrawIndirectCount : 0;
+	if (!DrawIndirectCount)
+		sys::log.head(sys::INFO) << "multi-draw indirect unavailable; culled meshlet runs are drawn one by one" << sys::EOM;
+
 	sys::log.head(sys::INFO) << "vulkan device & queue has been ready" << sys::EOM;
 
 	return true;
@@ -328,7 +595,6 @@ bool Phusis::Application::VkValidateSwapchain() noexcept
 			"VK_PRESENT_MODE_MAX_ENUM_KHR"
 	};
 
-	bool matched = false;
 	for (const auto& mode: modes)
 	{
 		int idx;
@@ -348,26 +614,33 @@ bool Phusis::Application::VkValidateSwapchain() noexcept
 			break;
 		}
 
-		if (mode == 2)
-		{
-			_presentMode = mode;
-			matched = true;
-		}
-
 		sys::log.head(sys::VERB) << "SRF found: " << modeMap[idx] << sys::EOM;
 	}
 
-	if (!matched)
-	{
-		sys::log.head(sys::CRIT) << "SRF not matched: " << modeMap[2] << sys::EOM;
-		return false;
-	}
-	else
+	// performant trades tearing / discarded frames for latency, quality keeps vsync;
+	// FIFO is the only mode the spec guarantees so it terminates both lists
+	static const std::vector<VkPresentModeKHR> performant = {
+			VK_PRESENT_MODE_MAILBOX_KHR,
+			VK_PRESENT_MODE_IMMEDIATE_KHR,
+			VK_PRESENT_MODE_FIFO_KHR
+	};
+	static const std::vector<VkPresentModeKHR> quality = {
+			VK_PRESENT_MODE_FIFO_KHR
+	};
+
+	const auto& preferred = _mode == ApplicationMode::Performant ? performant : quality;
+	for (const auto& mode: preferred)
 	{
-		sys::log.head(sys::INFO) << "SRF matched: " << modeMap[2] << sys::EOM;
+		if (std::find(modes.begin(), modes.end(), mode) != modes.end())
+		{
+			_presentMode = mode;
+			sys::log.head(sys::INFO) << "SRF matched: " << modeMap[mode] << sys::EOM;
+			return true;
+		}
 	}
 
-	return true;
+	sys::log.head(sys::CRIT) << "SRF not matched: " << modeMap[preferred.back()] << sys::EOM;
+	return false;
 }
 
 bool Phusis::Application::VkInitializeSurface() noexcept
@@ -407,19 +680,32 @@ bool Phusis::Application::VkInitializeSurface() noexcept
 
 bool Phusis::Application::VkInitializeSwapchain() noexcept
 {
+	VkExtent2D extent = _surfaceCapabilities.currentExtent;
+	if (extent.width == UINT32_MAX)
+	{
+		// the surface takes its size from the swapchain; the last size the window thread reported
+		extent.width = std::clamp(static_cast<uint32_t>(_framebufferWidth),
+				_surfaceCapabilities.minImageExtent.width, _surfaceCapabilities.maxImageExtent.width);
+		extent.height = std::clamp(static_cast<uint32_t>(_framebufferHeight),
+				_surfaceCapabilities.minImageExtent.height, _surfaceCapabilities.maxImageExtent.height);
+	}
+
 	VkSwapchainCreateInfoKHR info{};
 	info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
 	info.surface = Surface;
-	info.minImageCount = 2;
+	info.minImageCount = ImageCount();
 	info.imageFormat = _surfaceFormat.format;
 	info.imageColorSpace = _surfaceFormat.colorSpace;
-	info.imageExtent = _surfaceCapabilities.currentExtent;
+	info.imageExtent = extent;
 	info.imageArrayLayers = 1;
 	info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 	info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	info.preTransform = _surfaceCapabilities.currentTransform;
 	info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 	info.presentMode = _presentMode;
+	info.clipped = VK_TRUE;
+	// on recreation the old swapchain hands its images over instead of being torn down first
+	info.oldSwapchain = Swapchain;
 
 	_swapchainInfo = info;
 
@@ -432,12 +718,26 @@ bool Phusis::Application::VkInitializeSwapchain() noexcept
 	}
 
 	Swapchain = swapchain;
+	Width = extent.width;
+	Height = extent.height;
 
 	sys::log.head(sys::INFO) << "swapchain initialized" << sys::EOM;
 
 	return true;
 }
 
+uint32_t Phusis::Application::ImageCount() const noexcept
+{
+	// a third image keeps mailbox / immediate from stalling on the image being scanned out
+	uint32_t count = _mode == ApplicationMode::Performant ? 3 : 2;
+
+	count = std::max(count, _surfaceCapabilities.minImageCount);
+	if (_surfaceCapabilities.maxImageCount)
+		count = std::min(count, _surfaceCapabilities.maxImageCount);
+
+	return count;
+}
+
 bool Phusis::Application::VkInitializeImageViews() noexcept
 {
 	uint32_t cBuffer;
@@ -465,7 +765,7 @@ bool Phusis::Application::VkInitializeImageViews() noexcept
 	viewInfo.subresourceRange.baseMipLevel = 0;
 	viewInfo.subresourceRange.levelCount = 1;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
-	viewInfo.subresourceRange.layerCount = _requiredLayers.size();
+	viewInfo.subresourceRange.layerCount = 1;
 	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 
 	bool failed = false;
@@ -512,33 +812,7 @@ bool Phusis::Application::VkInitializeCommandPool() noexcept
 
 	sys::log.head(sys::INFO) << "primary command-pool created" << sys::EOM;
 
-	bool failed = false;
-	for (auto& data: _threads)
-	{
-		VkCommandPoolCreateInfo info{};
-		info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		info.queueFamilyIndex = _queueFamilyIdx;
-
-		VkCommandPool localPool;
-		VkResult localResult = vkCreateCommandPool(Device, &info, nullptr, &localPool);
-		if (localResult != VK_SUCCESS)
-		{
-			sys::log.head(sys::FAIL) << "could not create secondary command-pool" << sys::EOM;
-			failed = true;
-			continue;
-		}
-
-		data.CommandPool = localPool;
-	}
-	if (failed)
-	{
-		sys::log.head(sys::CRIT) << "could not initialize secondary command-pool set" << sys::EOM;
-		return false;
-	}
-
-	sys::log.head(sys::INFO) << "secondary command-pool created" << sys::EOM;
-
+	// secondaries come from the pools VkStateMachine keeps on each of its workers
 	return true;
 }
 
@@ -559,28 +833,6 @@ bool Phusis::Application::VkInitializeCommandBuffer() noexcept
 	}
 	PrimaryCommandBuffer = buffer;
 
-	bool failed = false;
-	for (auto& data: _threads)
-	{
-		info.commandPool = data.CommandPool;
-		info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
-
-		result = vkAllocateCommandBuffers(Device, &info, &buffer);
-		if (result != VK_SUCCESS)
-		{
-			sys::log.head(sys::FAIL) << "could not create secondary command-buffer" << sys::EOM;
-			failed = true;
-			continue;
-		}
-
-		data.CommandBuffer = buffer;
-	}
-	if (failed)
-	{
-		sys::log.head(sys::CRIT) << "could not initialize command-buffer set" << sys::EOM;
-		return false;
-	}
-
 	sys::log.head(sys::INFO) << "command-buffer set initialized" << sys::EOM;
 
 	return true;
@@ -611,6 +863,7 @@ bool Phusis::Application::VkInitializeRenderPass() noexcept
 		sys::log.head(sys::CRIT) << "supported stencil-depth format not found" << sys::EOM;
 		return false;
 	}
+	_depthFormat = depthFormat;
 
 	std::array<VkAttachmentDescription, 2> desc{};
 
@@ -624,15 +877,15 @@ bool Phusis::Application::VkInitializeRenderPass() noexcept
 	desc[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	desc[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
-	// depth desc
-	desc[0].format = depthFormat;
-	desc[0].samples = VK_SAMPLE_COUNT_1_BIT;
-	desc[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	desc[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	desc[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	desc[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	desc[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	desc[0].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	// depth desc; nothing reads it after the pass
+	desc[1].format = depthFormat;
+	desc[1].samples = VK_SAMPLE_COUNT_1_BIT;
+	desc[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	desc[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	desc[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	desc[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	desc[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	desc[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 	std::array<VkAttachmentReference, 2> ref{};
 
@@ -641,7 +894,7 @@ bool Phusis::Application::VkInitializeRenderPass() noexcept
 	ref[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 	// depth ref
-	ref[1].attachment = 0;
+	ref[1].attachment = 1;
 	ref[1].layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 	VkSubpassDescription subpass{};
@@ -700,26 +953,90 @@ bool Phusis::Application::VkInitializeRenderPass() noexcept
 	return true;
 }
 
-bool Phusis::Application::VkInitializeFramebuffers() noexcept
+bool Phusis::Application::VkInitializeDepth() noexcept
 {
-	int32_t w, h;
-	glfwGetWindowSize(_window, &w, &h);
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = _depthFormat;
+	imageInfo.extent = { Width, Height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	if (vkCreateImage(Device, &imageInfo, nullptr, &_depthImage) != VK_SUCCESS)
+	{
+		_depthImage = nullptr;
+		sys::log.head(sys::CRIT) << "could not create depth image" << sys::EOM;
+		return false;
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(Device, _depthImage, &requirements);
+
+	VkPhysicalDeviceMemoryProperties memory;
+	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &memory);
+
+	VkMemoryAllocateInfo allocate{};
+	allocate.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate.allocationSize = requirements.size;
+	allocate.memoryTypeIndex = MemoryType(memory, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (allocate.memoryTypeIndex == UINT32_MAX)
+		allocate.memoryTypeIndex = MemoryType(memory, requirements.memoryTypeBits, 0);
+
+	if (allocate.memoryTypeIndex == UINT32_MAX ||
+		vkAllocateMemory(Device, &allocate, nullptr, &_depthMemory) != VK_SUCCESS ||
+		vkBindImageMemory(Device, _depthImage, _depthMemory, 0) != VK_SUCCESS)
+	{
+		sys::log.head(sys::CRIT) << "could not allocate depth image memory" << sys::EOM;
+		return false;
+	}
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = _depthImage;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = _depthFormat;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(Device, &viewInfo, nullptr, &_depthView) != VK_SUCCESS)
+	{
+		_depthView = nullptr;
+		sys::log.head(sys::CRIT) << "could not create depth image-view" << sys::EOM;
+		return false;
+	}
+
+	// every frame starts it from UNDEFINED: the render pass through initialLayout, dynamic rendering by a barrier
+	sys::log.head(sys::INFO) << "depth image created at " << Width << "x" << Height << sys::EOM;
 
+	return true;
+}
+
+bool Phusis::Application::VkInitializeFramebuffers() noexcept
+{
 	VkFramebufferCreateInfo info{};
 	info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 	info.pNext = nullptr;
 	info.renderPass = RenderPass;
 	info.attachmentCount = _defaultRenderPassInfo.attachmentCount;
-	info.width = w;
-	info.height = h;
-	info.layers = _requiredLayers.size();
+	info.width = Width;
+	info.height = Height;
+	info.layers = 1;
 
 	std::vector<VkFramebuffer> framebuffers{_swapchainBuffers.size()};
 
 	bool failed = false;
 	for (uint32_t i = 0; i < _swapchainBuffers.size(); ++i)
 	{
-		info.pAttachments = &_swapchainViews[i];
+		// in the order of the default render pass' descriptions
+		std::array<VkImageView, 2> attachments = { _swapchainViews[i], _depthView };
+		info.pAttachments = attachments.data();
 		VkResult result = vkCreateFramebuffer(Device, &info, nullptr, &framebuffers[i]);
 		if (result != VK_SUCCESS)
 		{
@@ -740,93 +1057,278 @@ bool Phusis::Application::VkInitializeFramebuffers() noexcept
 	return true;
 }
 
-bool Phusis::Application::UpdateCommandBuffers(VkFramebuffer buffer) noexcept
+bool Phusis::Application::VkInitializePipelineLayout() noexcept
 {
-	int32_t w, h;
-	glfwGetWindowSize(_window, &w, &h);
+	VkPushConstantRange range{};
+	range.size = sizeof(Phusis::Internal::ConstantBlock);
+	range.offset = 0;
+	range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-	VkCommandBufferBeginInfo bufInfo{};
-	bufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	VkPipelineLayoutCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	info.setLayoutCount = 0;
+	info.pSetLayouts = nullptr;
+	info.pushConstantRangeCount = 1;
+	info.pPushConstantRanges = &range;
 
-	VkClearColorValue color{};
-	color.uint32[0] = 1; // B
-	color.uint32[1] = 1; // G
-	color.uint32[2] = 1; // R
-	color.uint32[3] = 0; // A
+	VkPipelineLayout layout;
+	VkResult result = vkCreatePipelineLayout(Device, &info, nullptr, &layout);
+	if (result != VK_SUCCESS)
+	{
+		sys::log.head(sys::CRIT) << "could not create vulkan pipeline layout" << sys::EOM;
+		return false;
+	}
 
-	VkClearValue clear[2];
-	clear[0].color = color;
-	clear[1].depthStencil = {1.0f, 0};
+	PipelineLayout = layout;
 
-	VkRenderPassBeginInfo renderpassInfo{};
-	renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderpassInfo.renderPass = RenderPass;
-	renderpassInfo.renderArea.offset.x = 0;
-	renderpassInfo.renderArea.offset.y = 0;
-	renderpassInfo.renderArea.extent.width = w;
-	renderpassInfo.renderArea.extent.height = h;
-	renderpassInfo.clearValueCount = 2;
-	renderpassInfo.pClearValues = clear;
-	renderpassInfo.framebuffer = buffer;
+	if (!MeshShading)
+		return true;
 
-	vkBeginCommandBuffer(PrimaryCommandBuffer, &bufInfo);
-	vkCmdBeginRenderPass(PrimaryCommandBuffer, &renderpassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	VkPushConstantRange meshRange{};
+	meshRange.size = sizeof(Phusis::Internal::MeshletConstantBlock);
+	meshRange.offset = 0;
+	meshRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+	info.pPushConstantRanges = &meshRange;
 
-	VkCommandBufferInheritanceInfo info{};
-	info.renderPass = RenderPass;
-	info.framebuffer = buffer;
+	result = vkCreatePipelineLayout(Device, &info, nullptr, &layout);
+	if (result != VK_SUCCESS)
+	{
+		// the indexed path still works; only the mesh shader path is lost
+		sys::log.head(sys::WARN) << "could not create mesh pipeline layout" << sys::EOM;
+		MeshShading = false;
+		return true;
+	}
 
-	// update secondary
-	// render thread
+	MeshPipelineLayout = layout;
 
-	std::vector<VkCommandBuffer> buffers{_threads.size()};
-	for (uint32_t i = 0; i < _threads.size(); ++i)
-		buffers[i] = _threads[i].CommandBuffer;
+	return true;
+}
 
-	vkCmdExecuteCommands(PrimaryCommandBuffer, buffers.size(), buffers.data());
-	vkCmdEndRenderPass(PrimaryCommandBuffer);
+bool Phusis::Application::VkInitializeUploadRing() noexcept
+{
+	constexpr VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+										 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+										 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
-	VkResult result = vkEndCommandBuffer(PrimaryCommandBuffer);
-	if (result != VK_SUCCESS)
+	return _upload.Initialize(PhysicalDevice, Device, UploadRegion, Internal::FramesInFlight, usage);
+}
+
+bool Phusis::Application::VkInitializeBindless() noexcept
+{
+	using namespace Phusis::Internal;
+
+	if (!Bindless)
+		return true;
+
+	// the objects live in the upload ring
+	if (!_upload.Buffer())
 	{
-		sys::log.head(sys::WARN) << "could not end primary command-buffer; output can be incorrect" << sys::EOM;
-		return false;
+		Bindless = false;
+		return true;
 	}
 
-	sys::log.head(sys::INFO) << "command-buffer updated" << sys::EOM;
-	return false;
-}
+	// the push-constant path still works; only the bindless path is lost
+	auto fail = [this](const char* message)
+	{
+		sys::log.head(sys::WARN) << message << "; descriptor indexing disabled" << sys::EOM;
+		VkReleaseBindless();
+		Bindless = false;
+		return true;
+	};
+
+	VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexing{};
+	indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &indexing;
+	vkGetPhysicalDeviceProperties2(PhysicalDevice, &properties);
+
+	_textureCapacity = std::min({ BindlessTextureCapacity,
+								  indexing.maxPerStageDescriptorUpdateAfterBindSampledImages,
+								  indexing.maxDescriptorSetUpdateAfterBindSampledImages });
+	_textureCount = 0;
+
+	std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+	bindings[0].binding = BindlessObjectBinding;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[1].binding = BindlessTextureBinding;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[1].descriptorCount = _textureCapacity;
+	bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	// textures are appended while frames that bound the set are in flight; unwritten slots are never read
+	std::array<VkDescriptorBindingFlags, 2> flags = {
+			0,
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+	};
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlags{};
+	bindingFlags.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlags.bindingCount = flags.size();
+	bindingFlags.pBindingFlags = flags.data();
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext = &bindingFlags;
+	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.bindingCount = bindings.size();
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(Device, &layoutInfo, nullptr, &BindlessSetLayout) != VK_SUCCESS)
+	{
+		BindlessSetLayout = nullptr;
+		return fail("could not create bindless set layout");
+	}
 
-bool Phusis::Application::VkInitializePipelineLayout() noexcept
-{
 	VkPushConstantRange range{};
-	range.size = sizeof(Phusis::Internal::ConstantBlock);
+	range.size = sizeof(BindlessConstantBlock);
 	range.offset = 0;
 	range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-	VkPipelineLayoutCreateInfo info{};
-	info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	info.setLayoutCount = 0;
-	info.pSetLayouts = nullptr;
-	info.pushConstantRangeCount = 1;
-	info.pPushConstantRanges = &range;
+	VkPipelineLayoutCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineInfo.setLayoutCount = 1;
+	pipelineInfo.pSetLayouts = &BindlessSetLayout;
+	pipelineInfo.pushConstantRangeCount = 1;
+	pipelineInfo.pPushConstantRanges = &range;
 
-	VkPipelineLayout layout;
-	VkResult result = vkCreatePipelineLayout(Device, &info, nullptr, &layout);
-	if (result != VK_SUCCESS)
+	if (vkCreatePipelineLayout(Device, &pipelineInfo, nullptr, &BindlessPipelineLayout) != VK_SUCCESS)
 	{
-		sys::log.head(sys::CRIT) << "could not create vulkan pipeline layout" << sys::EOM; 
+		BindlessPipelineLayout = nullptr;
+		return fail("could not create bindless pipeline layout");
 	}
 
-	PipelineLayout = layout;
+	std::array<VkDescriptorPoolSize, 2> sizes{};
+	sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	sizes[0].descriptorCount = FramesInFlight;
+	sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	sizes[1].descriptorCount = _textureCapacity * FramesInFlight;
 
-	return false;
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.maxSets = FramesInFlight;
+	poolInfo.poolSizeCount = sizes.size();
+	poolInfo.pPoolSizes = sizes.data();
+
+	if (vkCreateDescriptorPool(Device, &poolInfo, nullptr, &_bindlessPool) != VK_SUCCESS)
+	{
+		_bindlessPool = nullptr;
+		return fail("could not create bindless descriptor pool");
+	}
+
+	std::array<VkDescriptorSetLayout, FramesInFlight> layouts;
+	std::array<uint32_t, FramesInFlight> counts;
+	layouts.fill(BindlessSetLayout);
+	counts.fill(_textureCapacity);
+
+	VkDescriptorSetVariableDescriptorCountAllocateInfo variable{};
+	variable.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+	variable.descriptorSetCount = FramesInFlight;
+	variable.pDescriptorCounts = counts.data();
+
+	VkDescriptorSetAllocateInfo setInfo{};
+	setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setInfo.pNext = &variable;
+	setInfo.descriptorPool = _bindlessPool;
+	setInfo.descriptorSetCount = FramesInFlight;
+	setInfo.pSetLayouts = layouts.data();
+
+	_bindlessSets.resize(FramesInFlight);
+	if (vkAllocateDescriptorSets(Device, &setInfo, _bindlessSets.data()) != VK_SUCCESS)
+	{
+		_bindlessSets.clear();
+		return fail("could not allocate bindless descriptor sets");
+	}
+
+	std::array<VkDescriptorBufferInfo, FramesInFlight> regions{};
+	std::array<VkWriteDescriptorSet, FramesInFlight> writes{};
+	for (uint32_t i = 0; i < FramesInFlight; ++i)
+	{
+		regions[i].buffer = _upload.Buffer();
+		regions[i].offset = _upload.RegionOffset(i);
+		regions[i].range = _upload.RegionSize();
+
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = _bindlessSets[i];
+		writes[i].dstBinding = BindlessObjectBinding;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].pBufferInfo = &regions[i];
+	}
+	vkUpdateDescriptorSets(Device, writes.size(), writes.data(), 0, nullptr);
+
+	sys::log.head(sys::INFO) << "bindless set ready for " << _upload.RegionSize() / sizeof(BindlessObject) << " objects and "
+							 << _textureCapacity << " textures" << sys::EOM;
+
+	return true;
+}
+
+void Phusis::Application::VkReleaseBindless() noexcept
+{
+	// sets go with their pool
+	vkDestroyDescriptorPool(Device, _bindlessPool, nullptr);
+	vkDestroyPipelineLayout(Device, BindlessPipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(Device, BindlessSetLayout, nullptr);
+
+	_bindlessPool = nullptr;
+	_bindlessSets.clear();
+	BindlessPipelineLayout = nullptr;
+	BindlessSetLayout = nullptr;
+}
+
+bool Phusis::Application::VkRecreateSwapchain() noexcept
+{
+	VkSurfaceCapabilitiesKHR capabilities;
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(PhysicalDevice, Surface, &capabilities);
+	_surfaceCapabilities = capabilities;
+
+	// frames already submitted may still reference these; destroyed once they retire
+	for (const auto& buffer : _framebuffers)
+		_deletions.Retire(buffer);
+	for (const auto& view : _swapchainViews)
+		_deletions.Retire(view);
+	_deletions.Retire(_depthView);
+	_deletions.Retire(_depthImage);
+	_deletions.Retire(_depthMemory);
+	_framebuffers.clear();
+	_swapchainViews.clear();
+	_depthView = nullptr;
+	_depthImage = nullptr;
+	_depthMemory = nullptr;
+
+	// handed over as oldSwapchain, retired after the new one exists
+	VkSwapchainKHR old = Swapchain;
+	bool created = VkInitializeSwapchain();
+	_deletions.Retire(old);
+	if (!created)
+	{
+		Swapchain = nullptr;
+		return false;
+	}
+
+	if (!VkInitializeImageViews())
+		return false;
+	if (!VkInitializeDepth())
+		return false;
+	if (!DynamicRendering && !VkInitializeFramebuffers())
+		return false;
+
+	sys::log.head(sys::INFO) << "swapchain recreated at " << Width << "x" << Height << sys::EOM;
+
+	return true;
 }
 
 int32_t Phusis::Application::InitializeDeviceDependents() noexcept
 {
 	sys::log.head(sys::INFO) << "initializing device-dependants" << sys::EOM;
 
+	_deletions.Initialize(Device);
+
 	if (!VkCreateSurface())
 		return 8;
 	if (!VkValidateSwapchain())
@@ -843,10 +1345,17 @@ int32_t Phusis::Application::InitializeDeviceDependents() noexcept
 		return 14;
 	if (!VkInitializeRenderPass())
 		return 15;
-	if (!VkInitializeFramebuffers())
+	if (!VkInitializeDepth())
 		return 16;
-	if (!VkInitializePipelineLayout())
+	// framebuffers are only needed by the render-pass fallback
+	if (!DynamicRendering && !VkInitializeFramebuffers())
 		return 17;
+	if (!VkInitializePipelineLayout())
+		return 18;
+	if (!VkInitializeUploadRing())
+		return 19;
+	if (!VkInitializeBindless())
+		return 20;
 
 	sys::log.head(sys::INFO) << "" << sys::EOM;
 
@@ -857,14 +1366,26 @@ void Phusis::Application::ReleaseDeviceDependents() noexcept
 {
 	sys::log.head(sys::INFO) << "clean up device-dependent resources..." << sys::EOM;
 
+	vkDeviceWaitIdle(Device);
+	_deletions.Flush();
+
 	for (const auto& buffer : _framebuffers)
 		vkDestroyFramebuffer(Device, buffer, nullptr);
 	vkDestroyRenderPass(Device, RenderPass, nullptr);
-	for (const auto& data: _threads)
-		vkDestroyCommandPool(Device, data.CommandPool, nullptr);
+	vkDestroyPipelineLayout(Device, PipelineLayout, nullptr);
+	vkDestroyPipelineLayout(Device, MeshPipelineLayout, nullptr);
+	VkReleaseBindless();
+	_upload.Release();
 	vkDestroyCommandPool(Device, PrimaryCommandPool, nullptr);
 	for (const auto& view : _swapchainViews)
 		vkDestroyImageView(Device, view, nullptr);
+	vkDestroyImageView(Device, _depthView, nullptr);
+	vkDestroyImage(Device, _depthImage, nullptr);
+	vkFreeMemory(Device, _depthMemory, nullptr);
+	for (const auto& buffer : _meshBuffers)
+		vkDestroyBuffer(Device, buffer, nullptr);
+	for (const auto& memory : _meshMemory)
+		vkFreeMemory(Device, memory, nullptr);
 	vkDestroySwapchainKHR(Device, Swapchain, nullptr);
 	vkDestroySurfaceKHR(Instance, Surface, nullptr);
 }
@@ -883,7 +1404,7 @@ void Phusis::Application::ReleaseDeviceIndependents() noexcept
 int32_t Phusis::Application::InitializeComponents() noexcept
 {
 	sys::log.head(sys::DBUG) << "\n=== SYSTEM CONFIGURATION ===\n"
-							 << "Hardware Concurrency : " << _threads.size() << "\n"
+							 << "Hardware Concurrency : " << std::thread::hardware_concurrency() << "\n"
 							 << sys::EOM;
 
 	if (!GLFWInitialize())
@@ -912,12 +1433,526 @@ int32_t Phusis::Application::InitializeComponents() noexcept
 
 int32_t Phusis::Application::Run() noexcept
 {
-	while (!glfwWindowShouldClose(_window))
+	Internal::VkRendererInheritance inheritance{};
+	inheritance.Device = Device;
+	inheritance.Queue = Queue;
+	inheritance.QueueIdx = _queueFamilyIdx;
+	inheritance.Pool = PrimaryCommandPool;
+	inheritance.RenderPass = RenderPass;
+	inheritance.Pipeline = Pipeline;
+	inheritance.PipelineLayout = PipelineLayout;
+	inheritance.ClearColor = { { 0.f, 0.f, 0.f, 1.f } };
+	inheritance.DynamicRendering = DynamicRendering;
+	inheritance.ColorFormat = _surfaceFormat.format;
+	inheritance.DepthFormat = _depthFormat;
+	inheritance.CmdBeginRendering = CmdBeginRendering;
+	inheritance.CmdEndRendering = CmdEndRendering;
+	inheritance.CmdPipelineBarrier2 = CmdPipelineBarrier2;
+	inheritance.MeshPipeline = MeshShading ? MeshPipeline : nullptr;
+	inheritance.MeshPipelineLayout = MeshPipelineLayout;
+	inheritance.CmdDrawMeshTasks = CmdDrawMeshTasks;
+	inheritance.Upload = &_upload;
+	inheritance.DrawIndirectCount = DrawIndirectCount;
+	inheritance.TimestampPeriod = _timestampPeriod;
+	inheritance.TimestampBits = _timestampBits;
+	if (Bindless)
 	{
-		glfwPollEvents();
+		inheritance.BindlessPipeline = BindlessPipeline;
+		inheritance.BindlessPipelineLayout = BindlessPipelineLayout;
+		for (uint32_t i = 0; i < Internal::FramesInFlight; ++i)
+			inheritance.BindlessSets[i] = _bindlessSets[i];
 	}
 
-	return 0;
+	Internal::VkStateMachine machine(inheritance);
+	machine.Start();
+
+	Internal::VkBoundData bound{ Width, Height, View, Projection, _objects, _transforms, &_channel, &_hierarchy, &_entities };
+
+	_running = true;
+	int32_t code = 0;
+	std::thread render([this, &machine, &bound, &code]() {
+		code = RenderLoop(machine, bound);
+		_running = false;
+		glfwPostEmptyEvent();
+	});
+
+	// this thread owns the window and sleeps until the OS has something for it; metrics are written
+	// from here so file I/O never stalls a frame
+	while (_running && !glfwWindowShouldClose(_window))
+	{
+		glfwWaitEventsTimeout(EventTimeout);
+		_metrics.Export();
+	}
+
+	Post(WindowEventType::Close);
+	render.join();
+	_recorder.Close();
+
+	vkDeviceWaitIdle(Device);
+	_deletions.Flush();
+
+	return code;
 }
 
+void Phusis::Application::Post(WindowEventType type, int32_t x, int32_t y) noexcept
+{
+	WindowEvent event{ type, x, y, std::chrono::steady_clock::now() };
 
+	// input only dates the frame's sample, so a full queue may drop it; state changes must arrive
+	while (!_events.push(event))
+	{
+		if (type == WindowEventType::Input || !_running)
+			return;
+		std::this_thread::yield();
+	}
+}
+
+int32_t Phusis::Application::RenderLoop(Internal::VkStateMachine& machine, Internal::VkBoundData& bound) noexcept
+{
+	rendering = true;
+
+	std::vector<Internal::VkFrameData> frames{};
+	auto target = [&]() {
+		frames.resize(_swapchainBuffers.size());
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			frames[i].Framebuffer = i < _framebuffers.size() ? _framebuffers[i] : nullptr;
+			frames[i].Image = _swapchainBuffers[i];
+			frames[i].View = _swapchainViews[i];
+			frames[i].DepthImage = _depthImage;
+			frames[i].DepthView = _depthView;
+		}
+		bound.Width = Width;
+		bound.Height = Height;
+	};
+	target();
+
+	bool focused = true;
+	bool iconified = false;
+	double rate = -1.;
+
+	FrameMetrics metrics = RegisterFrameMetrics(_metrics);
+	std::chrono::steady_clock::time_point presented{};
+
+	while (true)
+	{
+		double limit = focused ? _frameRate.load(std::memory_order_relaxed) : _backgroundRate.load(std::memory_order_relaxed);
+		if (!focused && limit <= 0.)
+			limit = _frameRate.load(std::memory_order_relaxed);
+		if (limit != rate)
+		{
+			_pacer.limit(limit);
+			rate = limit;
+		}
+		_pacer.wait();
+
+		// block on frame N-2 before draining events so the input used for this frame is as fresh as possible
+		if (!machine.WaitLatency())
+		{
+			sys::log.head(sys::CRIT) << "device lost while waiting for frame" << sys::EOM;
+			return -1;
+		}
+		_deletions.Collect(machine.CompletedFrames());
+		_deletions.Advance(machine.FrameNumber() + 1);
+
+		std::chrono::steady_clock::time_point input{};
+		WindowEvent event;
+		while (_events.pop(event))
+		{
+			switch (event.Type)
+			{
+			case WindowEventType::Resize:
+				_framebufferWidth = event.X;
+				_framebufferHeight = event.Y;
+				_resized = true;
+				break;
+			case WindowEventType::Focus:
+				focused = event.X;
+				break;
+			case WindowEventType::Iconify:
+				iconified = event.X;
+				break;
+			case WindowEventType::Input:
+				if (input == std::chrono::steady_clock::time_point{})
+					input = event.Time;
+				break;
+			case WindowEventType::Close:
+				return 0;
+			}
+		}
+
+		// minimized; nothing can be presented until the window comes back
+		if (iconified || !_framebufferWidth || !_framebufferHeight)
+		{
+			// the pause is not a frame time
+			presented = {};
+			std::this_thread::sleep_for(IdleInterval);
+			continue;
+		}
+
+		if (_captureRequested.exchange(false, std::memory_order_acquire))
+		{
+			std::lock_guard guard(_captureLock);
+			if (_capturePath.empty())
+				_recorder.Close();
+			else
+				_recorder.Open(_capturePath, _captureFrames);
+		}
+
+		if (_cameraChanged.exchange(false, std::memory_order_acquire))
+		{
+			std::lock_guard guard(_cameraLock);
+			bound.View = _cameraView;
+			bound.Projection = _cameraProjection;
+		}
+
+		if (_systemsAdded.exchange(false, std::memory_order_acquire))
+		{
+			std::lock_guard guard(_systemLock);
+			for (auto& system: _addedSystems)
+				_systems.push_back(std::move(system));
+			_addedSystems.clear();
+		}
+
+		// the last frame's recording is over and the next has not begun; the workers are free
+		for (auto& system: _systems)
+			system(_entities, machine.Workers());
+
+		// latency runs from the oldest input this frame reacts to, or from now without any
+		machine.SampleInput(input == std::chrono::steady_clock::time_point{} ? std::chrono::steady_clock::now() : input);
+
+		if (_resized)
+		{
+			if (!VkRecreateSwapchain())
+			{
+				sys::log.head(sys::CRIT) << "could not recreate swapchain" << sys::EOM;
+				return -1;
+			}
+			target();
+			_resized = false;
+		}
+
+		uint32_t image;
+		VkResult result = machine.Acquire(Swapchain, image);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			_resized = true;
+			continue;
+		}
+		// surface or device lost; retrying would only fail the same way every frame
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		{
+			sys::log.head(sys::CRIT) << "could not acquire swapchain image: " << result << sys::EOM;
+			return -1;
+		}
+
+		machine.Bind(&bound, &frames[image]);
+		if (!machine.Update())
+		{
+			sys::log.head(sys::CRIT) << "device lost while rendering frame" << sys::EOM;
+			return -1;
+		}
+
+		result = machine.Present(Swapchain, image);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+			_resized = true;
+		else if (result != VK_SUCCESS)
+		{
+			sys::log.head(sys::CRIT) << "could not present swapchain image: " << result << sys::EOM;
+			return -1;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if (presented != std::chrono::steady_clock::time_point{})
+			metrics.Frame.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - presented).count());
+		presented = now;
+
+		const Internal::VkFrameTimings& timings = machine.Timings();
+		const Internal::VkRecordStats& stats = machine.Statistics();
+		metrics.Prepare.Record(Nanos(timings.Prepare));
+		metrics.Record.Record(Nanos(timings.Record));
+		if (timings.Gpu > 0.)
+			metrics.Gpu.Record(Nanos(timings.Gpu));
+		if (timings.Latency > 0.)
+			metrics.Latency.Record(Nanos(timings.Latency));
+		metrics.Draws.Record(stats.Draws);
+		metrics.Culled.Record(stats.ClustersCulled);
+		metrics.CommandBuffers.Record(stats.CommandBuffers);
+		metrics.ArenaBytes.Record(stats.ArenaBytes);
+		metrics.UploadBytes.Record(_upload.Used());
+		metrics.Allocations.Record(stats.Allocations);
+
+		if (_recorder.Active())
+			_recorder.Record(bound, timings);
+	}
+}
+
+bool Phusis::Application::Running() const noexcept
+{
+	return _running.load(std::memory_order_acquire);
+}
+
+void Phusis::Application::SetCamera(const glm::mat4& view, const glm::mat4& projection) noexcept
+{
+	std::lock_guard guard(_cameraLock);
+	_cameraView = view;
+	_cameraProjection = projection;
+	_cameraChanged.store(true, std::memory_order_release);
+}
+
+bool Phusis::Application::Owns(const char* what) const noexcept
+{
+	if (rendering || !_running.load(std::memory_order_acquire))
+		return true;
+
+	sys::log.head(sys::WARN) << what << " used off the render thread while running" << sys::EOM;
+	return false;
+}
+
+void Phusis::Application::AddSystem(System system) noexcept
+{
+	std::lock_guard guard(_systemLock);
+	_addedSystems.push_back(std::move(system));
+	_systemsAdded.store(true, std::memory_order_release);
+}
+
+void Phusis::Application::LimitFrameRate(double hz) noexcept
+{
+	// applied by the render thread before its next frame
+	_frameRate = hz;
+}
+
+void Phusis::Application::LimitBackgroundRate(double hz) noexcept
+{
+	_backgroundRate = hz;
+}
+
+uint32_t Phusis::Application::ObjectCount() const noexcept
+{
+	return _objects.size();
+}
+
+VkFormat Phusis::Application::DepthFormat() const noexcept
+{
+	return _depthFormat;
+}
+
+uint32_t Phusis::Application::LoadMeshes(const std::filesystem::path& path) noexcept
+{
+	if (!Owns("mesh loading"))
+		return UINT32_MAX;
+
+	if (!Device)
+	{
+		sys::log.head(sys::WARN) << "meshes loaded before the device was initialized" << sys::EOM;
+		return UINT32_MAX;
+	}
+
+	auto blob = std::make_unique<MeshBlob>();
+	if (!blob->Open(path))
+	{
+		sys::log.head(sys::FAIL) << "could not load meshes from " << path.string() << sys::EOM;
+		return UINT32_MAX;
+	}
+
+	// task and mesh shaders read the same data through its device address
+	VkBufferCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	info.size = blob->DataSize();
+	info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	if (MeshShading)
+		info.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+	info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VkBuffer buffer;
+	if (vkCreateBuffer(Device, &info, nullptr, &buffer) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create mesh buffer" << sys::EOM;
+		return UINT32_MAX;
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(Device, buffer, &requirements);
+
+	VkPhysicalDeviceMemoryProperties properties;
+	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &properties);
+
+	VkMemoryAllocateFlagsInfo flags{};
+	flags.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+	flags.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+	// written once through a mapping; device-local where the host can reach it
+	VkMemoryAllocateInfo allocate{};
+	allocate.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate.pNext = MeshShading ? &flags : nullptr;
+	allocate.allocationSize = requirements.size;
+	allocate.memoryTypeIndex = MemoryType(properties, requirements.memoryTypeBits,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	if (allocate.memoryTypeIndex == UINT32_MAX)
+		allocate.memoryTypeIndex = MemoryType(properties, requirements.memoryTypeBits,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	VkDeviceMemory memory = nullptr;
+	void* mapped = nullptr;
+	if (allocate.memoryTypeIndex == UINT32_MAX ||
+		vkAllocateMemory(Device, &allocate, nullptr, &memory) != VK_SUCCESS ||
+		vkBindBufferMemory(Device, buffer, memory, 0) != VK_SUCCESS ||
+		vkMapMemory(Device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not allocate mesh memory" << sys::EOM;
+		vkDestroyBuffer(Device, buffer, nullptr);
+		vkFreeMemory(Device, memory, nullptr);
+		return UINT32_MAX;
+	}
+	std::memcpy(mapped, blob->Data(), blob->DataSize());
+	vkUnmapMemory(Device, memory);
+
+	// without it the meshes keep to the indexed path
+	VkDeviceAddress address = 0;
+	auto bufferAddress = MeshShading ? reinterpret_cast<PFN_vkGetBufferDeviceAddressKHR>(
+			vkGetDeviceProcAddr(Device, "vkGetBufferDeviceAddressKHR")) : nullptr;
+	if (bufferAddress)
+	{
+		VkBufferDeviceAddressInfo addressInfo{};
+		addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+		addressInfo.buffer = buffer;
+		address = bufferAddress(Device, &addressInfo);
+	}
+
+	uint32_t first = _meshes.size();
+	for (const auto& mesh: blob->Meshes(buffer, 0, address))
+		_meshes.push_back(mesh);
+
+	sys::log.head(sys::INFO) << "loaded " << _meshes.size() - first << " meshes from " << path.string() << sys::EOM;
+
+	_blobs.push_back(std::move(blob));
+	_meshBuffers.push_back(buffer);
+	_meshMemory.push_back(memory);
+	return first;
+}
+
+uint32_t Phusis::Application::MeshCount() const noexcept
+{
+	return _meshes.size();
+}
+
+const Phusis::Mesh& Phusis::Application::LoadedMesh(uint32_t idx) const noexcept
+{
+	return _meshes[idx];
+}
+
+uint32_t Phusis::Application::CreateObject(const Mesh& mesh, VkPipeline pipeline, uint32_t material) noexcept
+{
+	if (!Owns("object creation"))
+		return UINT32_MAX;
+
+	EngineObjectTransform transform{};
+	transform.Rotation = glm::mat4(1.f);
+	transform.Color = glm::vec4(1.f);
+	transform.Enabled = 1;
+
+	// the renderer and the hierarchy pick up the new count at the next frame
+	_objects.emplace_back(mesh, pipeline, material);
+	_transforms.push_back(transform);
+	return _objects.size() - 1;
+}
+
+bool Phusis::Application::DestroyObject(uint32_t idx) noexcept
+{
+	if (!Owns("object destruction"))
+		return false;
+
+	if (idx >= _objects.size())
+	{
+		sys::log.head(sys::WARN) << "object " << idx << " out of range" << sys::EOM;
+		return false;
+	}
+
+	// objects hold their mesh by value and cannot be assigned, so the survivors are rebuilt in order
+	std::vector<EngineObjectData> kept;
+	kept.reserve(_objects.size() - 1);
+	for (uint32_t i = 0; i < _objects.size(); ++i)
+		if (i != idx)
+			kept.push_back(std::move(_objects[i]));
+	_objects.swap(kept);
+
+	_transforms.erase(_transforms.begin() + idx);
+	_hierarchy.Erase(idx);
+	return true;
+}
+
+Phusis::EngineObjectTransform* Phusis::Application::Transforms() noexcept
+{
+	// still handed out; the warning points at the race
+	Owns("transforms");
+	return _transforms.data();
+}
+
+Phusis::SceneChannel& Phusis::Application::Channel() noexcept
+{
+	return _channel;
+}
+
+Phusis::TransformHierarchy& Phusis::Application::Hierarchy() noexcept
+{
+	Owns("hierarchy");
+	return _hierarchy;
+}
+
+Phusis::EntityStore& Phusis::Application::Entities() noexcept
+{
+	Owns("entity store");
+	return _entities;
+}
+
+Phusis::MetricsRegistry& Phusis::Application::Metrics() noexcept
+{
+	return _metrics;
+}
+
+void Phusis::Application::Capture(const std::filesystem::path& path, uint32_t frames) noexcept
+{
+	std::lock_guard guard(_captureLock);
+	_capturePath = path;
+	_captureFrames = frames;
+	_captureRequested.store(true, std::memory_order_release);
+}
+
+uint32_t Phusis::Application::RegisterTexture(VkImageView view, VkSampler sampler) noexcept
+{
+	if (!Owns("texture registration"))
+		return UINT32_MAX;
+
+	if (!Bindless || _textureCount >= _textureCapacity)
+	{
+		sys::log.head(sys::WARN) << "could not register texture; bindless array unavailable or full" << sys::EOM;
+		return UINT32_MAX;
+	}
+
+	VkDescriptorImageInfo image{};
+	image.sampler = sampler;
+	image.imageView = view;
+	image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	// the slot is unused by every recorded frame, so no frame has to retire first
+	std::array<VkWriteDescriptorSet, Internal::FramesInFlight> writes{};
+	for (uint32_t i = 0; i < writes.size(); ++i)
+	{
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = _bindlessSets[i];
+		writes[i].dstBinding = Internal::BindlessTextureBinding;
+		writes[i].dstArrayElement = _textureCount;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writes[i].pImageInfo = &image;
+	}
+	vkUpdateDescriptorSets(Device, writes.size(), writes.data(), 0, nullptr);
+
+	return _textureCount++;
+}
+
+void Phusis::Application::Release(VkBuffer buffer, VkDeviceMemory memory) noexcept
+{
+	_deletions.Retire(buffer);
+	_deletions.Retire(memory);
+}
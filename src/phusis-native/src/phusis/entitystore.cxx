@@ -0,0 +1,323 @@
+#include "phusis/entitystore.hxx"
+#include "sys/logger.hxx"
+
+static uint32_t align(uint32_t offset, uint32_t alignment) noexcept
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+static bool bit(const uint8_t* data, uint32_t row) noexcept
+{
+	return reinterpret_cast<const uint64_t*>(data)[row / 64] >> (row % 64) & 1;
+}
+
+static void assign(uint8_t* data, uint32_t row, bool value) noexcept
+{
+	uint64_t& word = reinterpret_cast<uint64_t*>(data)[row / 64];
+	word = value ? word | uint64_t(1) << (row % 64) : word & ~(uint64_t(1) << (row % 64));
+}
+
+Phusis::EntityChunk::EntityChunk(EntityArchetype* archetype)
+		: _archetype(archetype),
+		  _data(static_cast<uint8_t*>(operator new(EntityChunkBytes, std::align_val_t(EntityColumnAlignment))))
+{
+	std::memset(_data, 0, EntityChunkBytes);
+}
+
+Phusis::EntityChunk::~EntityChunk() noexcept
+{
+	operator delete(_data, std::align_val_t(EntityColumnAlignment));
+}
+
+uint32_t Phusis::EntityChunk::Count() const noexcept
+{
+	return _count;
+}
+
+uint32_t Phusis::EntityChunk::EnabledCount() const noexcept
+{
+	return _enabled;
+}
+
+bool Phusis::EntityChunk::Enabled(uint32_t row) const noexcept
+{
+	return row < _count && bit(_data, row);
+}
+
+const uint64_t* Phusis::EntityChunk::EnabledMask() const noexcept
+{
+	return reinterpret_cast<const uint64_t*>(_data);
+}
+
+const Phusis::Entity* Phusis::EntityChunk::Entities() const noexcept
+{
+	return reinterpret_cast<const Entity*>(_data + _archetype->EntityOffset);
+}
+
+const Phusis::EntityArchetype& Phusis::EntityChunk::Archetype() const noexcept
+{
+	return *_archetype;
+}
+
+Phusis::EntityStore::~EntityStore() noexcept = default;
+
+bool Phusis::EntityStore::Register(uint32_t id, uint32_t size, uint32_t alignment) noexcept
+{
+	if (!_sizes[id])
+	{
+		_sizes[id] = size;
+		_alignments[id] = alignment;
+		return true;
+	}
+
+	if (_sizes[id] != size || _alignments[id] != alignment)
+	{
+		sys::log.head(sys::FAIL) << "component id " << id << " registered with size " << _sizes[id]
+								 << ", used with size " << size << sys::EOM;
+		return false;
+	}
+
+	return true;
+}
+
+Phusis::EntityArchetype* Phusis::EntityStore::Archetype(ComponentMask mask)
+{
+	auto found = _lookup.find(mask);
+	if (found != _lookup.end())
+		return found->second;
+
+	auto archetype = std::make_unique<EntityArchetype>();
+	archetype->Mask = mask;
+	archetype->Offsets.fill(0);
+
+	uint32_t row = sizeof(Entity);
+	for (uint32_t id = 0; id < EntityMaxComponents; ++id)
+	{
+		if (!(mask >> id & 1))
+			continue;
+
+		if (!_sizes[id])
+		{
+			sys::log.head(sys::FAIL) << "component id " << id << " used before registration" << sys::EOM;
+			return nullptr;
+		}
+		archetype->Columns.push_back(EntityColumn{ id, 0, _sizes[id] });
+		row += _sizes[id];
+	}
+
+	// columns of the given capacity laid out after the enable mask and the entities; returns the end
+	auto layout = [&archetype, this](uint32_t capacity)
+	{
+		uint32_t offset = align((capacity + 63) / 64 * 8, alignof(Entity));
+		archetype->EntityOffset = offset;
+		offset += capacity * sizeof(Entity);
+
+		for (auto& column: archetype->Columns)
+		{
+			offset = align(offset, std::max(EntityColumnAlignment, _alignments[column.Id]));
+			column.Offset = offset;
+			offset += capacity * column.Size;
+		}
+		return offset;
+	};
+
+	// start from the unpadded bound and drop rows until the padding fits too
+	uint32_t capacity = std::min(EntityChunkBytes * 8 / (row * 8 + 1), 1u << EntityRowBits);
+	while (capacity && layout(capacity) > EntityChunkBytes)
+		capacity--;
+
+	if (!capacity)
+	{
+		sys::log.head(sys::FAIL) << "components of " << row << " bytes do not fit a chunk" << sys::EOM;
+		return nullptr;
+	}
+
+	archetype->Capacity = capacity;
+	for (const auto& column: archetype->Columns)
+		archetype->Offsets[column.Id] = static_cast<uint16_t>(column.Offset);
+
+	EntityArchetype* result = archetype.get();
+	_archetypes.push_back(std::move(archetype));
+	_lookup.emplace(mask, result);
+	return result;
+}
+
+void Phusis::EntityStore::Allocate(EntityArchetype* archetype, Record& record)
+{
+	auto& chunks = archetype->Chunks;
+	if (chunks.empty() || chunks.back()->_count == archetype->Capacity)
+		chunks.push_back(std::make_unique<EntityChunk>(archetype));
+
+	EntityChunk* chunk = chunks.back().get();
+	uint32_t row = chunk->_count++;
+	assign(chunk->_data, row, true);
+	chunk->_enabled++;
+
+	record.Archetype = archetype;
+	record.Chunk = chunk;
+	record.Row = row;
+}
+
+void Phusis::EntityStore::Vacate(const Record& record) noexcept
+{
+	EntityArchetype* archetype = record.Archetype;
+	EntityChunk* chunk = record.Chunk;
+	EntityChunk* last = archetype->Chunks.back().get();
+	uint32_t tail = last->_count - 1;
+
+	if (bit(chunk->_data, record.Row))
+		chunk->_enabled--;
+
+	if (chunk != last || record.Row != tail)
+	{
+		Entity moved = last->Entities()[tail];
+		reinterpret_cast<Entity*>(chunk->_data + archetype->EntityOffset)[record.Row] = moved;
+		for (const auto& column: archetype->Columns)
+			std::memcpy(chunk->_data + column.Offset + record.Row * column.Size,
+						last->_data + column.Offset + tail * column.Size,
+						column.Size);
+
+		bool enabled = bit(last->_data, tail);
+		assign(chunk->_data, record.Row, enabled);
+		chunk->_enabled += enabled;
+		last->_enabled -= enabled;
+
+		_records[moved.Index].Chunk = chunk;
+		_records[moved.Index].Row = record.Row;
+	}
+
+	assign(last->_data, tail, false);
+	last->_count--;
+
+	// the last empty chunk is kept so one entity coming and going does not churn the heap
+	if (!last->_count && archetype->Chunks.size() > 1)
+		archetype->Chunks.pop_back();
+}
+
+bool Phusis::EntityStore::Migrate(Entity entity, ComponentMask mask)
+{
+	EntityArchetype* target = Archetype(mask);
+	if (!target)
+		return false;
+
+	Record& record = _records[entity.Index];
+	Record previous = record;
+	Allocate(target, record);
+
+	uint8_t* dst = record.Chunk->_data;
+	const uint8_t* src = previous.Chunk->_data;
+	reinterpret_cast<Entity*>(dst + target->EntityOffset)[record.Row] = entity;
+	for (const auto& column: target->Columns)
+	{
+		uint8_t* to = dst + column.Offset + record.Row * column.Size;
+		uint16_t from = previous.Archetype->Offsets[column.Id];
+		if (from)
+			std::memcpy(to, src + from + previous.Row * column.Size, column.Size);
+		else
+			std::memset(to, 0, column.Size);
+	}
+
+	if (!bit(src, previous.Row))
+	{
+		assign(dst, record.Row, false);
+		record.Chunk->_enabled--;
+	}
+
+	Vacate(previous);
+	return true;
+}
+
+Phusis::EntityStore::Record* Phusis::EntityStore::Find(Entity entity) noexcept
+{
+	if (entity.Index >= _records.size())
+		return nullptr;
+
+	Record& record = _records[entity.Index];
+	return record.Archetype && record.Generation == entity.Generation ? &record : nullptr;
+}
+
+const Phusis::EntityStore::Record* Phusis::EntityStore::Find(Entity entity) const noexcept
+{
+	return const_cast<EntityStore*>(this)->Find(entity);
+}
+
+void* Phusis::EntityStore::Column(const Record& record, uint32_t id) const noexcept
+{
+	uint16_t offset = record.Archetype->Offsets[id];
+	return offset ? record.Chunk->_data + offset + record.Row * _sizes[id] : nullptr;
+}
+
+Phusis::Entity Phusis::EntityStore::Create(ComponentMask mask)
+{
+	EntityArchetype* archetype = Archetype(mask);
+	if (!archetype)
+		return Entity{};
+
+	uint32_t index;
+	if (_free.empty())
+	{
+		index = _records.size();
+		_records.push_back(Record{ 1, nullptr, nullptr, 0 });
+	}
+	else
+	{
+		index = _free.back();
+		_free.pop_back();
+	}
+
+	Record& record = _records[index];
+	Allocate(archetype, record);
+
+	// rows are reused after a vacate
+	Entity entity{ index, record.Generation };
+	reinterpret_cast<Entity*>(record.Chunk->_data + archetype->EntityOffset)[record.Row] = entity;
+	for (const auto& column: archetype->Columns)
+		std::memset(record.Chunk->_data + column.Offset + record.Row * column.Size, 0, column.Size);
+
+	_count++;
+	return entity;
+}
+
+void Phusis::EntityStore::Destroy(Entity entity)
+{
+	Record* record = Find(entity);
+	if (!record)
+		return;
+
+	Vacate(*record);
+
+	record->Archetype = nullptr;
+	record->Chunk = nullptr;
+	// generation 0 stays reserved for Entity{}
+	if (!++record->Generation)
+		record->Generation = 1;
+
+	_free.push_back(entity.Index);
+	_count--;
+}
+
+bool Phusis::EntityStore::Alive(Entity entity) const noexcept
+{
+	return Find(entity);
+}
+
+void Phusis::EntityStore::SetEnabled(Entity entity, bool enabled) noexcept
+{
+	Record* record = Find(entity);
+	if (!record || bit(record->Chunk->_data, record->Row) == enabled)
+		return;
+
+	assign(record->Chunk->_data, record->Row, enabled);
+	record->Chunk->_enabled += enabled ? 1 : -1;
+}
+
+bool Phusis::EntityStore::Enabled(Entity entity) const noexcept
+{
+	const Record* record = Find(entity);
+	return record && bit(record->Chunk->_data, record->Row);
+}
+
+uint32_t Phusis::EntityStore::Count() const noexcept
+{
+	return _count;
+}
@@ -0,0 +1,105 @@
+#include "phusis/internal/drawsort.hxx"
+#include <cstring>
+
+static uint64_t hash(uint64_t v, uint32_t bits) noexcept
+{
+	// fibonacci hashing; only grouping matters, so collisions just cost extra binds
+	return (v * 0x9E3779B97F4A7C15ull) >> (64 - bits);
+}
+
+uint64_t Phusis::Internal::MakeSortKey(VkPipeline pipeline, uint32_t material, const Mesh& mesh, float depth) noexcept
+{
+	// meshes sharing one buffer differ only by offset
+	uint64_t vertex = mesh.Vertices.empty()
+					  ? 0
+					  : reinterpret_cast<uint64_t>(mesh.Vertices[0].Array) + mesh.Vertices[0].Offset;
+
+	// non-negative IEEE floats order the same as their bit patterns
+	depth = depth > 0.f ? depth : 0.f;
+	uint32_t bits;
+	memcpy(&bits, &depth, sizeof bits);
+
+	return hash(reinterpret_cast<uint64_t>(pipeline), 10) << 54 |
+		   static_cast<uint64_t>(material & 0x3FFF) << 40 |
+		   hash(vertex, 16) << 24 |
+		   static_cast<uint64_t>(bits >> 8);
+}
+
+void Phusis::Internal::SortDraws(
+		std::vector<VkDrawItem>& items,
+		std::vector<VkDrawItem>& scratch,
+		uint32_t partitions,
+		sys::arena& arena) noexcept
+{
+	size_t n = items.size();
+	if (n < 2)
+		return;
+
+	scratch.resize(n);
+
+	// small lists are not worth the fan-out
+	partitions = std::max<uint32_t>(1, std::min<size_t>(partitions, n / 4096 + 1));
+
+	uint64_t diff = 0;
+	for (const auto& item: items)
+		diff |= item.Key ^ items[0].Key;
+
+	sys::arena_vector<std::array<size_t, 256>> histogram(partitions, sys::arena_allocator<std::array<size_t, 256>>(arena));
+	sys::arena_vector<uint32_t> indices(partitions, sys::arena_allocator<uint32_t>(arena));
+	for (uint32_t i = 0; i < partitions; ++i)
+		indices[i] = i;
+
+	auto range = [n, partitions](uint32_t p, size_t& begin, size_t& end)
+	{
+		size_t local = n / partitions;
+		size_t remain = n % partitions;
+		begin = local * p + std::min<size_t>(p, remain);
+		end = begin + local + (p < remain ? 1 : 0);
+	};
+
+	VkDrawItem* src = items.data();
+	VkDrawItem* dst = scratch.data();
+	for (uint32_t shift = 0; shift < 64; shift += 8)
+	{
+		if (((diff >> shift) & 0xFF) == 0)
+			continue;
+
+		std::for_each(std::execution::par_unseq, indices.begin(), indices.end(), [&](uint32_t p)
+		{
+			size_t begin, end;
+			range(p, begin, end);
+
+			auto& local = histogram[p];
+			local.fill(0);
+			for (size_t i = begin; i < end; ++i)
+				++local[(src[i].Key >> shift) & 0xFF];
+		});
+
+		// digit-major, partition-minor offsets keep the sort stable
+		size_t sum = 0;
+		for (size_t d = 0; d < 256; ++d)
+		{
+			for (auto& local: histogram)
+			{
+				size_t count = local[d];
+				local[d] = sum;
+				sum += count;
+			}
+		}
+
+		std::for_each(std::execution::par_unseq, indices.begin(), indices.end(), [&](uint32_t p)
+		{
+			size_t begin, end;
+			range(p, begin, end);
+
+			auto& local = histogram[p];
+			for (size_t i = begin; i < end; ++i)
+				dst[local[(src[i].Key >> shift) & 0xFF]++] = src[i];
+		});
+
+		std::swap(src, dst);
+	}
+
+	if (src != items.data())
+		items.swap(scratch);
+}
@@ -0,0 +1,354 @@
+#include <cstring>
+#include "phusis/internal/framecapture.hxx"
+#include "phusis/internal/vkstatemachine.hxx"
+#include "sys/logger.hxx"
+
+static constexpr const char* Truncated = "is truncated";
+
+Phusis::Internal::FrameRecorder::~FrameRecorder() noexcept
+{
+	Close();
+}
+
+bool Phusis::Internal::FrameRecorder::Write(const void* data, size_t size) noexcept
+{
+	_out.write(static_cast<const char*>(data), size);
+	return _out.good();
+}
+
+bool Phusis::Internal::FrameRecorder::Open(const std::filesystem::path& path, uint32_t frames) noexcept
+{
+	Close();
+
+	_out.open(path, std::ios::binary | std::ios::trunc);
+	FrameCaptureHeader header{ FrameCaptureMagic, FrameCaptureVersion, 0, 0 };
+	if (!_out.is_open() || !Write(&header, sizeof header))
+	{
+		sys::log.head(sys::FAIL) << "could not open frame capture " << path.string() << sys::EOM;
+		_out.close();
+		return false;
+	}
+
+	_path = path;
+	_frames = 0;
+	_limit = frames;
+
+	// the first frame carries everything
+	_objects = nullptr;
+	_objectCount = 0;
+	_meshes.clear();
+	_pipelines.clear();
+	_transforms.clear();
+	_parents.clear();
+
+	sys::log.head(sys::INFO) << "capturing frames to " << path.string() << sys::EOM;
+	return true;
+}
+
+void Phusis::Internal::FrameRecorder::Close() noexcept
+{
+	if (!_out.is_open())
+		return;
+
+	// a capture cut short keeps Frames at 0 and is read to its end instead
+	_out.seekp(offsetof(FrameCaptureHeader, Frames));
+	Write(&_frames, sizeof _frames);
+	_out.close();
+
+	sys::log.head(sys::INFO) << "captured " << _frames << " frames to " << _path.string() << sys::EOM;
+}
+
+bool Phusis::Internal::FrameRecorder::Active() const noexcept
+{
+	return _out.is_open();
+}
+
+void Phusis::Internal::FrameRecorder::Record(const VkBoundData& bound, const VkFrameTimings& timings)
+{
+	if (!_out.is_open())
+		return;
+
+	uint32_t n = bound.Objects.size();
+
+	FrameCaptureFrame frame{};
+	frame.Width = bound.Width;
+	frame.Height = bound.Height;
+	std::memcpy(frame.View, &bound.View, sizeof frame.View);
+	std::memcpy(frame.Projection, &bound.Projection, sizeof frame.Projection);
+	frame.ObjectCount = n;
+	frame.Prepare = timings.Prepare;
+	frame.Record = timings.Record;
+	frame.Submit = timings.Submit;
+	frame.Gpu = timings.Gpu;
+
+	if (bound.Objects.data() != _objects || n != _objectCount)
+	{
+		frame.Flags |= FrameCaptureObjects;
+		_objects = bound.Objects.data();
+		_objectCount = n;
+
+		_table.resize(n);
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			const EngineObjectData& object = bound.Objects[i];
+			auto key = object.Mesh.Indices.empty()
+					   ? std::pair<VkBuffer, VkDeviceSize>{ nullptr, 0 }
+					   : std::pair<VkBuffer, VkDeviceSize>{ object.Mesh.Indices[0].Array, object.Mesh.Indices[0].Offset };
+			uint32_t mesh = _meshes.emplace(key, _meshes.size()).first->second;
+			uint32_t pipeline = object.Pipeline ? _pipelines.emplace(object.Pipeline, _pipelines.size() + 1).first->second : 0;
+			_table[i] = FrameCaptureObject{ mesh, pipeline, object.Material, 0 };
+		}
+
+		// a new object set is written whole
+		_transforms.clear();
+	}
+
+	if (bound.Hierarchy)
+	{
+		_links.resize(n);
+		for (uint32_t i = 0; i < n; ++i)
+			_links[i] = bound.Hierarchy->Parent(i);
+
+		if (_links != _parents)
+		{
+			frame.Flags |= FrameCaptureParents;
+			_parents.swap(_links);
+		}
+	}
+
+	_deltas.clear();
+	_transforms.resize(n);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		const EngineObjectTransform& transform = bound.Transforms[i];
+		if (!(frame.Flags & FrameCaptureObjects) && !std::memcmp(&_transforms[i], &transform, sizeof transform))
+			continue;
+
+		_transforms[i] = transform;
+		_deltas.push_back(FrameCaptureDelta{ i, {}, transform });
+	}
+	frame.Deltas = _deltas.size();
+
+	bool written = Write(&frame, sizeof frame);
+	if (frame.Flags & FrameCaptureObjects)
+		written = written && Write(_table.data(), n * sizeof(FrameCaptureObject));
+	if (frame.Flags & FrameCaptureParents)
+		written = written && Write(_parents.data(), n * sizeof(uint32_t));
+	written = written && Write(_deltas.data(), _deltas.size() * sizeof(FrameCaptureDelta));
+
+	if (!written)
+	{
+		sys::log.head(sys::FAIL) << "could not write frame capture " << _path.string() << "; capture stopped" << sys::EOM;
+		Close();
+		return;
+	}
+
+	if (++_frames == _limit)
+		Close();
+}
+
+bool Phusis::Internal::FrameReplay::Open(const std::filesystem::path& path) noexcept
+{
+	_data.clear();
+	_frames.clear();
+	_meshes = 0;
+	_pipelines = 0;
+	_hierarchical = false;
+
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in.is_open())
+	{
+		sys::log.head(sys::FAIL) << "could not open frame capture " << path.string() << sys::EOM;
+		return false;
+	}
+
+	_data.resize(static_cast<size_t>(in.tellg()));
+	in.seekg(0);
+	if (!in.read(reinterpret_cast<char*>(_data.data()), _data.size()) || _data.size() < sizeof(FrameCaptureHeader))
+	{
+		sys::log.head(sys::FAIL) << "frame capture " << path.string() << " is truncated" << sys::EOM;
+		_data.clear();
+		return false;
+	}
+
+	FrameCaptureHeader header;
+	std::memcpy(&header, _data.data(), sizeof header);
+
+	// walk every frame once; sections are only read through the offsets checked here
+	const char* error = nullptr;
+	if (header.Magic != FrameCaptureMagic)
+		error = "is not a frame capture";
+	else if (header.Version != FrameCaptureVersion)
+		error = "has an unsupported version";
+
+	size_t offset = sizeof(FrameCaptureHeader);
+	while (!error && offset < _data.size() && (!header.Frames || _frames.size() < header.Frames))
+	{
+		if (_data.size() - offset < sizeof(FrameCaptureFrame))
+		{
+			error = Truncated;
+			break;
+		}
+
+		FrameCaptureFrame frame;
+		std::memcpy(&frame, _data.data() + offset, sizeof frame);
+
+		uint64_t size = sizeof(FrameCaptureFrame) + static_cast<uint64_t>(frame.Deltas) * sizeof(FrameCaptureDelta);
+		if (frame.Flags & FrameCaptureObjects)
+			size += static_cast<uint64_t>(frame.ObjectCount) * sizeof(FrameCaptureObject);
+		if (frame.Flags & FrameCaptureParents)
+			size += static_cast<uint64_t>(frame.ObjectCount) * sizeof(uint32_t);
+		if (size > _data.size() - offset)
+		{
+			error = Truncated;
+			break;
+		}
+		if (_frames.empty() && !(frame.Flags & FrameCaptureObjects))
+		{
+			error = "does not start with an object table";
+			break;
+		}
+
+		const uint8_t* section = _data.data() + offset + sizeof(FrameCaptureFrame);
+		if (frame.Flags & FrameCaptureObjects)
+		{
+			for (uint32_t i = 0; i < frame.ObjectCount; ++i)
+			{
+				FrameCaptureObject object;
+				std::memcpy(&object, section + i * sizeof object, sizeof object);
+				_meshes = std::max(_meshes, object.Mesh + 1);
+				_pipelines = std::max(_pipelines, object.Pipeline);
+			}
+			section += frame.ObjectCount * sizeof(FrameCaptureObject);
+		}
+		else if (frame.ObjectCount != Frame(_frames.size() - 1).ObjectCount)
+		{
+			error = "changes its object count without a table";
+			break;
+		}
+
+		if (frame.Flags & FrameCaptureParents)
+		{
+			for (uint32_t i = 0; !error && i < frame.ObjectCount; ++i)
+			{
+				uint32_t parent;
+				std::memcpy(&parent, section + i * sizeof parent, sizeof parent);
+				if (parent != TransformHierarchy::NoParent && parent >= frame.ObjectCount)
+					error = "has a parent out of range";
+			}
+			section += frame.ObjectCount * sizeof(uint32_t);
+			_hierarchical = true;
+		}
+
+		for (uint32_t i = 0; !error && i < frame.Deltas; ++i)
+		{
+			uint32_t index;
+			std::memcpy(&index, section + i * sizeof(FrameCaptureDelta), sizeof index);
+			if (index >= frame.ObjectCount)
+				error = "has a transform out of range";
+		}
+
+		if (!error)
+			_frames.push_back(offset);
+		offset += size;
+	}
+
+	if (!error && header.Frames && _frames.size() != header.Frames)
+		error = Truncated;
+
+	// a capture that was never closed, e.g. because the process died, may end mid-frame
+	if (error == Truncated && !header.Frames && !_frames.empty())
+	{
+		sys::log.head(sys::WARN) << "frame capture " << path.string() << " ends mid-frame; keeping the "
+								 << _frames.size() << " complete ones" << sys::EOM;
+		error = nullptr;
+	}
+
+	if (error)
+	{
+		sys::log.head(sys::FAIL) << "frame capture " << path.string() << " " << error << sys::EOM;
+		_data.clear();
+		_frames.clear();
+		return false;
+	}
+
+	sys::log.head(sys::INFO) << "frame capture " << path.string() << " loaded: " << _frames.size() << " frames, "
+							 << _meshes << " meshes" << sys::EOM;
+	return true;
+}
+
+uint32_t Phusis::Internal::FrameReplay::Count() const noexcept
+{
+	return _frames.size();
+}
+
+const Phusis::Internal::FrameCaptureFrame& Phusis::Internal::FrameReplay::Frame(uint32_t idx) const noexcept
+{
+	// frames are packed, but every section is a whole number of 4-byte words and nothing needs more
+	return *reinterpret_cast<const FrameCaptureFrame*>(_data.data() + _frames[idx]);
+}
+
+uint32_t Phusis::Internal::FrameReplay::MeshCount() const noexcept
+{
+	return _meshes;
+}
+
+uint32_t Phusis::Internal::FrameReplay::PipelineCount() const noexcept
+{
+	return _pipelines;
+}
+
+bool Phusis::Internal::FrameReplay::Hierarchical() const noexcept
+{
+	return _hierarchical;
+}
+
+void Phusis::Internal::FrameReplay::Apply(uint32_t idx, VkBoundData& bound, std::vector<EngineObjectData>& objects,
+		const std::vector<Mesh>& meshes, const std::vector<VkPipeline>& pipelines) const
+{
+	const FrameCaptureFrame& frame = Frame(idx);
+	const uint8_t* section = _data.data() + _frames[idx] + sizeof(FrameCaptureFrame);
+	uint32_t n = frame.ObjectCount;
+
+	bound.Width = frame.Width;
+	bound.Height = frame.Height;
+	std::memcpy(&bound.View, frame.View, sizeof frame.View);
+	std::memcpy(&bound.Projection, frame.Projection, sizeof frame.Projection);
+
+	if (frame.Flags & FrameCaptureObjects)
+	{
+		const auto* table = reinterpret_cast<const FrameCaptureObject*>(section);
+		objects.clear();
+		objects.reserve(n);
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			VkPipeline pipeline = table[i].Pipeline && table[i].Pipeline <= pipelines.size() ? pipelines[table[i].Pipeline - 1] : nullptr;
+			objects.emplace_back(meshes[table[i].Mesh], pipeline, table[i].Material);
+		}
+		bound.Transforms.resize(n);
+		section += n * sizeof(FrameCaptureObject);
+	}
+
+	if (frame.Flags & FrameCaptureParents)
+	{
+		const auto* parents = reinterpret_cast<const uint32_t*>(section);
+		if (bound.Hierarchy)
+		{
+			// unlinked first, so no intermediate state is a cycle
+			bound.Hierarchy->Resize(n);
+			for (uint32_t i = 0; i < n; ++i)
+				bound.Hierarchy->SetParent(i, TransformHierarchy::NoParent);
+			for (uint32_t i = 0; i < n; ++i)
+				bound.Hierarchy->SetParent(i, parents[i]);
+		}
+		section += n * sizeof(uint32_t);
+	}
+
+	const auto* deltas = reinterpret_cast<const FrameCaptureDelta*>(section);
+	for (uint32_t i = 0; i < frame.Deltas; ++i)
+	{
+		bound.Transforms[deltas[i].Index] = deltas[i].Transform;
+		if (bound.Hierarchy)
+			bound.Hierarchy->Invalidate(deltas[i].Index);
+	}
+}
@@ -0,0 +1,101 @@
+#include "phusis/internal/lodselect.hxx"
+#include "pre/simd.hxx"
+
+// closer than this, every object is at full detail
+constexpr float MinimumDistance = 1e-3f;
+
+static const glm::mat4& at(const glm::mat4* matrices, size_t stride, uint32_t i) noexcept
+{
+	return *reinterpret_cast<const glm::mat4*>(reinterpret_cast<const uint8_t*>(matrices) + i * stride);
+}
+
+static float project(const glm::mat4& m, const glm::mat4& view, float focal) noexcept
+{
+	glm::vec3 position = glm::vec3(view * m[3]);
+	float axis = std::max({ glm::dot(glm::vec3(m[0]), glm::vec3(m[0])),
+							glm::dot(glm::vec3(m[1]), glm::vec3(m[1])),
+							glm::dot(glm::vec3(m[2]), glm::vec3(m[2])) });
+
+	return focal * std::sqrt(axis) / std::max(glm::length(position), MinimumDistance);
+}
+
+void Phusis::Internal::LodScales(
+		const glm::mat4* matrices,
+		size_t stride,
+		uint32_t n,
+		const glm::mat4& view,
+		float focal,
+		float* scales) noexcept
+{
+	uint32_t i = 0;
+#if PRE_SSE
+	const __m128 f = _mm_set1_ps(focal);
+	const __m128 near = _mm_set1_ps(MinimumDistance);
+
+	for (; i + 4 <= n; i += 4)
+	{
+		const glm::mat4& m0 = at(matrices, stride, i);
+		const glm::mat4& m1 = at(matrices, stride, i + 1);
+		const glm::mat4& m2 = at(matrices, stride, i + 2);
+		const glm::mat4& m3 = at(matrices, stride, i + 3);
+
+		// column c of four objects, transposed to x/y/z/w lanes across the objects
+		auto column = [&](int c, __m128& x, __m128& y, __m128& z) {
+			__m128 a = _mm_loadu_ps(&m0[c][0]);
+			__m128 b = _mm_loadu_ps(&m1[c][0]);
+			__m128 d = _mm_loadu_ps(&m2[c][0]);
+			__m128 e = _mm_loadu_ps(&m3[c][0]);
+			_MM_TRANSPOSE4_PS(a, b, d, e);
+			x = a;
+			y = b;
+			z = d;
+		};
+
+		__m128 x, y, z;
+		__m128 axis = _mm_setzero_ps();
+		for (int c = 0; c < 3; ++c)
+		{
+			column(c, x, y, z);
+			__m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			axis = _mm_max_ps(axis, squared);
+		}
+
+		column(3, x, y, z);
+		__m128 distance = _mm_setzero_ps();
+		for (int r = 0; r < 3; ++r)
+		{
+			__m128 v = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[0][r]), x), _mm_mul_ps(_mm_set1_ps(view[1][r]), y)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[2][r]), z), _mm_set1_ps(view[3][r])));
+			distance = _mm_add_ps(distance, _mm_mul_ps(v, v));
+		}
+		distance = _mm_max_ps(_mm_sqrt_ps(distance), near);
+
+		_mm_storeu_ps(scales + i, _mm_div_ps(_mm_mul_ps(f, _mm_sqrt_ps(axis)), distance));
+	}
+#endif
+	for (; i < n; ++i)
+		scales[i] = project(at(matrices, stride, i), view, focal);
+}
+
+uint32_t Phusis::Internal::SelectLod(const Mesh& mesh, float scale, uint32_t previous, const LodPolicy& policy) noexcept
+{
+	uint32_t levels = std::min(mesh.Indices.size(), mesh.Errors.size());
+	if (levels <= 1)
+		return 0;
+
+	float coarsen = policy.Threshold * (1.f - policy.Hysteresis);
+	float refine = policy.Threshold * (1.f + policy.Hysteresis);
+
+	// errors ascend with the level, so counting the passing levels finds the coarsest one
+	uint32_t coarse = 0;
+	uint32_t fine = 0;
+	for (uint32_t k = 1; k < levels; ++k)
+	{
+		float error = mesh.Errors[k] * scale;
+		coarse += error <= coarsen;
+		fine += error <= refine;
+	}
+
+	return std::clamp(previous, coarse, fine);
+}
@@ -0,0 +1,71 @@
+#include "phusis/internal/meshletcull.hxx"
+
+Phusis::Internal::MeshletFrustum Phusis::Internal::MakeMeshletFrustum(const glm::mat4& projection, const glm::mat4& modelView) noexcept
+{
+	// Gribb / Hartmann on the object-to-clip matrix gives the planes directly in object space
+	glm::mat4 m = projection * modelView;
+	glm::vec4 row[4];
+	for (int r = 0; r < 4; ++r)
+		row[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+
+	MeshletFrustum frustum{};
+	frustum.Planes[0] = row[3] + row[0];
+	frustum.Planes[1] = row[3] - row[0];
+	frustum.Planes[2] = row[3] + row[1];
+	frustum.Planes[3] = row[3] - row[1];
+	// -w <= z is the looser near plane of the two conventions
+	frustum.Planes[4] = row[3] + row[2];
+	frustum.Planes[5] = row[3] - row[2];
+
+	for (auto& plane: frustum.Planes)
+	{
+		float length = glm::length(glm::vec3(plane));
+		if (length > 0.f)
+			plane /= length;
+	}
+
+	frustum.Camera = glm::vec3(glm::inverse(modelView)[3]);
+	return frustum;
+}
+
+static bool visible(const Phusis::Meshlet& meshlet, const Phusis::Internal::MeshletFrustum& frustum) noexcept
+{
+	glm::vec3 center(meshlet.Center[0], meshlet.Center[1], meshlet.Center[2]);
+	for (const auto& plane: frustum.Planes)
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -meshlet.Radius)
+			return false;
+
+	if (meshlet.ConeCutoff >= 1.f)
+		return true;
+
+	// the cone test of meshoptimizer's meshopt_Bounds, against a sphere instead of the apex
+	glm::vec3 axis(meshlet.ConeAxis[0], meshlet.ConeAxis[1], meshlet.ConeAxis[2]);
+	glm::vec3 view = center - frustum.Camera;
+	return glm::dot(view, axis) < meshlet.ConeCutoff * glm::length(view) + meshlet.Radius;
+}
+
+uint32_t Phusis::Internal::CullMeshlets(const Meshlet* meshlets, uint32_t n, const MeshletFrustum& frustum, MeshletRun* runs) noexcept
+{
+	uint32_t count = 0;
+	bool open = false;
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		if (!visible(meshlets[i], frustum))
+		{
+			open = false;
+			continue;
+		}
+
+		if (open && runs[count - 1].FirstIndex + runs[count - 1].IndexCount == meshlets[i].FirstIndex)
+		{
+			runs[count - 1].IndexCount += meshlets[i].IndexCount;
+			runs[count - 1].Count++;
+		}
+		else
+		{
+			runs[count++] = { meshlets[i].FirstIndex, meshlets[i].IndexCount, 1 };
+			open = true;
+		}
+	}
+	return count;
+}
@@ -0,0 +1,115 @@
+#include "phusis/internal/vkcommandpool.hxx"
+#include "sys/logger.hxx"
+#include <cassert>
+
+bool Phusis::Internal::VkCommandBufferPool::Initialize(VkDevice device, uint32_t queueIdx) noexcept
+{
+	VkCommandPoolCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	info.queueFamilyIndex = queueIdx;
+
+	VkCommandPool pool;
+	VkResult result = vkCreateCommandPool(device, &info, nullptr, &pool);
+	if (result != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create secondary command pool" << sys::EOM;
+		return false;
+	}
+
+	_device = device;
+	_pool = pool;
+	_buffers.clear();
+	_used = 0;
+#ifndef NDEBUG
+	_owner = {};
+#endif
+
+	return true;
+}
+
+void Phusis::Internal::VkCommandBufferPool::Release() noexcept
+{
+	if (_pool)
+		vkDestroyCommandPool(_device, _pool, nullptr);
+
+	_pool = nullptr;
+	_buffers.clear();
+	_used = 0;
+}
+
+void Phusis::Internal::VkCommandBufferPool::CheckAffinity() noexcept
+{
+#ifndef NDEBUG
+	// vkCommandPool is externally synchronized; one owning thread makes that hold by construction
+	if (_owner == std::thread::id{})
+		_owner = std::this_thread::get_id();
+	assert(_owner == std::this_thread::get_id() && "secondary command pool used off its owning thread");
+#endif
+}
+
+bool Phusis::Internal::VkCommandBufferPool::Reset() noexcept
+{
+	CheckAffinity();
+
+	// keep the pool's memory; buffers return to the initial state and are handed out again
+	VkResult result = vkResetCommandPool(_device, _pool, 0);
+	if (result != VK_SUCCESS)
+	{
+		sys::log.head(sys::CRIT) << "could not reset secondary command pool" << sys::EOM;
+		return false;
+	}
+
+	_used = 0;
+	return true;
+}
+
+bool Phusis::Internal::VkCommandBufferPool::Reserve(uint32_t n) noexcept
+{
+	CheckAffinity();
+
+	if (n <= _buffers.size())
+		return true;
+
+	uint32_t capacity = std::max<uint32_t>(_buffers.size(), 8);
+	while (capacity < n)
+		capacity *= 2;
+
+	VkCommandBufferAllocateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	info.commandBufferCount = capacity - _buffers.size();
+	info.commandPool = _pool;
+	info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+	size_t offset = _buffers.size();
+	_buffers.resize(capacity);
+
+	VkResult result = vkAllocateCommandBuffers(_device, &info, &_buffers[offset]);
+	if (result != VK_SUCCESS)
+	{
+		sys::log.head(sys::CRIT) << "could not grow secondary command pool to " << capacity << sys::EOM;
+		_buffers.resize(offset);
+		return false;
+	}
+
+	return true;
+}
+
+VkCommandBuffer Phusis::Internal::VkCommandBufferPool::Acquire() noexcept
+{
+	CheckAffinity();
+
+	if (_used == _buffers.size() && !Reserve(_used + 1))
+		return nullptr;
+	return _buffers[_used++];
+}
+
+uint32_t Phusis::Internal::VkCommandBufferPool::Capacity() const noexcept
+{
+	return _buffers.size();
+}
+
+uint32_t Phusis::Internal::VkCommandBufferPool::Used() const noexcept
+{
+	return _used;
+}
@@ -0,0 +1,122 @@
+#include "phusis/internal/vkdeletionqueue.hxx"
+#include "sys/logger.hxx"
+
+void Phusis::Internal::VkDeletionQueue::Initialize(VkDevice device) noexcept
+{
+	_device = device;
+	_recording = 1;
+}
+
+void Phusis::Internal::VkDeletionQueue::Advance(uint64_t frame) noexcept
+{
+	_recording = frame;
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkObjectType type, uint64_t handle, uint64_t value)
+{
+	if (!handle)
+		return;
+
+	std::lock_guard guard(_lock);
+	_pending.push_back({ value, type, handle });
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkBuffer buffer)
+{
+	Retire(VK_OBJECT_TYPE_BUFFER, reinterpret_cast<uint64_t>(buffer), _recording);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkDeviceMemory memory)
+{
+	Retire(VK_OBJECT_TYPE_DEVICE_MEMORY, reinterpret_cast<uint64_t>(memory), _recording);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkImage image)
+{
+	Retire(VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(image), _recording);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkImageView view)
+{
+	Retire(VK_OBJECT_TYPE_IMAGE_VIEW, reinterpret_cast<uint64_t>(view), _recording);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkFramebuffer framebuffer)
+{
+	Retire(VK_OBJECT_TYPE_FRAMEBUFFER, reinterpret_cast<uint64_t>(framebuffer), _recording);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkPipeline pipeline)
+{
+	Retire(VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(pipeline), _recording);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkSwapchainKHR swapchain)
+{
+	Retire(VK_OBJECT_TYPE_SWAPCHAIN_KHR, reinterpret_cast<uint64_t>(swapchain), _recording);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkBuffer buffer, uint64_t value)
+{
+	Retire(VK_OBJECT_TYPE_BUFFER, reinterpret_cast<uint64_t>(buffer), value);
+}
+
+void Phusis::Internal::VkDeletionQueue::Retire(VkDeviceMemory memory, uint64_t value)
+{
+	Retire(VK_OBJECT_TYPE_DEVICE_MEMORY, reinterpret_cast<uint64_t>(memory), value);
+}
+
+void Phusis::Internal::VkDeletionQueue::Destroy(const VkRetiredHandle& retired) noexcept
+{
+	switch (retired.Type)
+	{
+	case VK_OBJECT_TYPE_BUFFER:
+		vkDestroyBuffer(_device, reinterpret_cast<VkBuffer>(retired.Handle), nullptr);
+		break;
+	case VK_OBJECT_TYPE_DEVICE_MEMORY:
+		vkFreeMemory(_device, reinterpret_cast<VkDeviceMemory>(retired.Handle), nullptr);
+		break;
+	case VK_OBJECT_TYPE_IMAGE:
+		vkDestroyImage(_device, reinterpret_cast<VkImage>(retired.Handle), nullptr);
+		break;
+	case VK_OBJECT_TYPE_IMAGE_VIEW:
+		vkDestroyImageView(_device, reinterpret_cast<VkImageView>(retired.Handle), nullptr);
+		break;
+	case VK_OBJECT_TYPE_FRAMEBUFFER:
+		vkDestroyFramebuffer(_device, reinterpret_cast<VkFramebuffer>(retired.Handle), nullptr);
+		break;
+	case VK_OBJECT_TYPE_PIPELINE:
+		vkDestroyPipeline(_device, reinterpret_cast<VkPipeline>(retired.Handle), nullptr);
+		break;
+	case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+		vkDestroySwapchainKHR(_device, reinterpret_cast<VkSwapchainKHR>(retired.Handle), nullptr);
+		break;
+	default:
+		sys::log.head(sys::WARN) << "cannot destroy retired handle of type " << retired.Type << sys::EOM;
+		break;
+	}
+}
+
+void Phusis::Internal::VkDeletionQueue::Collect(uint64_t completed) noexcept
+{
+	std::lock_guard guard(_lock);
+	while (!_pending.empty() && _pending.front().Value <= completed)
+	{
+		Destroy(_pending.front());
+		_pending.pop_front();
+	}
+}
+
+void Phusis::Internal::VkDeletionQueue::Flush() noexcept
+{
+	std::lock_guard guard(_lock);
+	for (const auto& retired: _pending)
+		Destroy(retired);
+	_pending.clear();
+}
+
+size_t Phusis::Internal::VkDeletionQueue::Pending() const noexcept
+{
+	std::lock_guard guard(_lock);
+	return _pending.size();
+}
@@ -1,235 +1,852 @@
 #include "phusis/internal/vkstatemachine.hxx"
 #include "sys/logger.hxx"
 #include "phusis/internal/constantblock.hxx"
+#include "sys/allocation.hxx"
+#include "pre/batch.hxx"
+
+Phusis::Internal::VkStateMachine::VkStateMachine(
+		const VkRendererInheritance& inheritance,
+		uint32_t threads,
+		RecordingMode mode) noexcept
+		: _bound(nullptr),
+		  _frame(nullptr),
+		  _inheritance(inheritance),
+		  _local(),
+		  _threads(std::max<uint32_t>(threads, 1)),
+		  _workers(_threads.size()),
+		  _mode(mode)
+{
+	for (uint32_t i = 0; i < _threads.size(); ++i)
+		_threads[i].Index = i;
+}
+
+Phusis::Internal::VkStateMachine::~VkStateMachine() noexcept
+{
+	for (const auto& flight: _flights)
+		if (flight.Fence)
+			vkWaitForFences(_inheritance.Device, 1, &flight.Fence, VK_TRUE, UINT64_MAX);
+
+	for (auto& data: _threads)
+		for (auto& pool: data.Pools)
+			pool.Release();
+
+	for (const auto& flight: _flights)
+	{
+		if (flight.Buffer)
+			vkFreeCommandBuffers(_inheritance.Device, _inheritance.Pool, 1, &flight.Buffer);
+		if (flight.Fence)
+			vkDestroyFence(_inheritance.Device, flight.Fence, nullptr);
+		if (flight.Acquired)
+			vkDestroySemaphore(_inheritance.Device, flight.Acquired, nullptr);
+		if (flight.Rendered)
+			vkDestroySemaphore(_inheritance.Device, flight.Rendered, nullptr);
+		if (flight.Queries)
+			vkDestroyQueryPool(_inheritance.Device, flight.Queries, nullptr);
+	}
+}
 
 bool Phusis::Internal::VkStateMachine::PrepareSecondaryPools()
 {
 	bool failed = false;
 	for (auto& data: _threads)
+		for (auto& pool: data.Pools)
+			failed |= !pool.Initialize(_inheritance.Device, _inheritance.QueueIdx);
+
+	if (failed)
 	{
-		VkCommandPoolCreateInfo info{};
-		info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		info.queueFamilyIndex = _inheritance.QueueIdx;
+		sys::log.head(sys::CRIT) << "could not create secondary command pool" << sys::EOM;
+	}
+
+	return !failed;
+}
+
+bool Phusis::Internal::VkStateMachine::PrepareFlights()
+{
+	VkCommandBufferAllocateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	info.commandBufferCount = 1;
+	info.commandPool = _inheritance.Pool;
+	info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+	// signaled, so the first wait on each flight falls through
+	VkFenceCreateInfo fence{};
+	fence.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	VkSemaphoreCreateInfo semaphore{};
+	semaphore.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	VkQueryPoolCreateInfo queries{};
+	queries.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queries.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queries.queryCount = 2;
 
-		VkCommandPool pool;
-		VkResult result = vkCreateCommandPool(_inheritance.Device, &info, nullptr, &pool);
+	bool failed = false;
+	for (auto& flight: _flights)
+	{
+		VkResult result = vkAllocateCommandBuffers(_inheritance.Device, &info, &flight.Buffer);
 		if (result != VK_SUCCESS)
 		{
-			sys::log.head(sys::FAIL) << "could not create secondary command pool" << sys::EOM;
-			data.Pool = nullptr;
+			sys::log.head(sys::FAIL) << "could not allocate primary command-buffer" << sys::EOM;
+			flight.Buffer = nullptr;
 			failed = true;
 		}
-		else
+
+		result = vkCreateFence(_inheritance.Device, &fence, nullptr, &flight.Fence);
+		if (result != VK_SUCCESS)
+		{
+			sys::log.head(sys::FAIL) << "could not create render fence" << sys::EOM;
+			flight.Fence = nullptr;
+			failed = true;
+		}
+
+		if (vkCreateSemaphore(_inheritance.Device, &semaphore, nullptr, &flight.Acquired) != VK_SUCCESS ||
+			vkCreateSemaphore(_inheritance.Device, &semaphore, nullptr, &flight.Rendered) != VK_SUCCESS)
+		{
+			sys::log.head(sys::FAIL) << "could not create present semaphores" << sys::EOM;
+			failed = true;
+		}
+
+		// GPU time is telemetry; the frame renders without it
+		flight.Queries = nullptr;
+		if (_inheritance.TimestampPeriod > 0.f &&
+			vkCreateQueryPool(_inheritance.Device, &queries, nullptr, &flight.Queries) != VK_SUCCESS)
 		{
-			data.Pool = pool;
+			sys::log.head(sys::WARN) << "could not create timestamp queries; GPU time is not measured" << sys::EOM;
+			flight.Queries = nullptr;
 		}
 	}
 
 	if (failed)
 	{
-		sys::log.head(sys::CRIT) << "could not create secondary command pool" << sys::EOM;
+		sys::log.head(sys::CRIT) << "could not prepare frames in flight" << sys::EOM;
 	}
 
 	return !failed;
 }
 
-bool Phusis::Internal::VkStateMachine::PrepareCommandBuffers(uint32_t idx, uint32_t n)
+bool Phusis::Internal::VkStateMachine::PrepareCommandBuffers(uint32_t n)
 {
-	VkResult result;
+	VkThreadData& data = Local();
 
-	VkThreadData& data = _threads[idx];
-	if (data.Buffers.size() == n)
-		return true;
+	// batched recording needs a single secondary per thread
+	if (_mode == RecordingMode::Batched)
+		n = std::min<uint32_t>(n, 1);
 
-	result = vkResetCommandPool(_inheritance.Device, data.Pool, VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT);
-	if (result != VK_SUCCESS)
+	// only ever grows; shrinking object counts keep the buffers for later frames
+	bool result = data.Pools[_flight].Reserve(n);
+	data.Buffers.reserve(n);
+
+	if (!result)
 	{
-		sys::log.head(sys::CRIT) << "could not reset command pool on thread " << idx << sys::EOM;
-		return false;
+		sys::log.head(sys::CRIT) << "could not create buffer on thread " << data.Index << sys::EOM;
 	}
 
-	VkCommandBufferAllocateInfo info{};
-	info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	info.commandBufferCount = n;
-	info.commandPool = data.Pool;
-	info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	return result;
+}
 
-	std::vector<VkCommandBuffer> buffers{ n };
-	result = vkAllocateCommandBuffers(_inheritance.Device, &info, buffers.data());
-	if (result != VK_SUCCESS)
+void Phusis::Internal::VkStateMachine::PrepareDraws()
+{
+	const auto& objects = _bound->Objects;
+	const auto& transforms = _bound->Transforms;
+
+	// entity rows take the draw slots after the objects, chunk by chunk; disabled rows take none
+	_chunks.clear();
+	uint32_t rows = 0;
+	if (_bound->Entities)
 	{
-		sys::log.head(sys::CRIT) << "could not create buffer on thread " << idx << sys::EOM;
-		return false;
+		constexpr ComponentMask drawn = ComponentMaskOf<ObjectTransform, ObjectColor, ObjectRenderable, ObjectLod>();
+		_bound->Entities->Chunks(drawn, [this, &rows, &objects](EntityChunk& chunk)
+		{
+			if (!chunk.EnabledCount())
+				return;
+
+			_chunks.push_back(VkEntityChunk{
+					&chunk,
+					chunk.Column<ObjectTransform>(),
+					chunk.Column<ObjectColor>(),
+					chunk.Column<ObjectRenderable>(),
+					chunk.Column<ObjectLod>(),
+					static_cast<uint32_t>(objects.size()) + rows });
+			rows += chunk.EnabledCount();
+		});
 	}
 
-	return true;
-}
+	_draws.resize(objects.size() + rows);
 
-bool Phusis::Internal::VkStateMachine::DistributeBuffers(
-		int32_t update,
-		Phusis::Internal::BufferDistributionStrategy strategy)
-{
-	bool result = true;
-	switch (strategy)
+	// objects added since the last frame start at full detail
+	if (_lods.size() != objects.size())
 	{
-	case Phusis::Internal::BufferDistributionStrategy::Optimal:
+		_lods.resize(objects.size(), 0);
+		_lodScales.resize(objects.size());
+		_eyes.resize(objects.size());
+	}
+
+	// once per frame on aligned copies; every record multiplies into the view-projection
+	_view = pre::from_glm(_bound->View);
+	_viewProjection = pre::from_glm(_bound->Projection) * _view;
+
+	// pixels per unit at distance 1
+	float focal = std::abs(_bound->Projection[1][1]) * _bound->Height * .5f;
+
+	std::atomic<uint32_t> enabled = 0;
+	_workers.run([this, &objects, &transforms, &enabled, focal](uint32_t i)
 	{
-		if (update > 0)
+		uint32_t local = objects.size() / _threads.size();
+		uint32_t remain = objects.size() % _threads.size();
+		uint32_t offset = local * i + std::min(i, remain);
+		if (i < remain)
+			local++;
+
+		if (_bound->Hierarchy)
+			LodScales(_bound->Hierarchy->Worlds() + offset, sizeof(glm::mat4), local, _bound->View, focal, _lodScales.data() + offset);
+		else
+			LodScales(&transforms[offset].Rotation, sizeof(EngineObjectTransform), local, _bound->View, focal, _lodScales.data() + offset);
+
+		// the slice's view-space positions in one batch; the sort key only needs their depth
+		for (uint32_t j = offset; j < offset + local; ++j)
+			_eyes[j] = pre::from_glm(World(j)[3]);
+		pre::transform(_view, pre::span<const pre::vec4f>(_eyes.data() + offset, local), pre::span<pre::vec4f>(_eyes.data() + offset, local));
+
+		uint32_t count = 0;
+		for (uint32_t j = offset; j < offset + local; ++j)
 		{
-			// find minimal
-			size_t x = -1, xi;
-			for (size_t i = 0; i < _threads.size(); ++i)
+			const EngineObjectData& object = objects[j];
+
+			// disabled objects sort behind everything and are trimmed below
+			uint64_t key = DisabledDrawKey;
+			uint32_t lod = 0;
+			if (transforms[j].Enabled)
 			{
-				size_t loc = _threads[i].Buffers.size();
-				if (x >= loc)
-					continue;
-				x = loc;
-				xi = i;
+				lod = SelectLod(object.Mesh, _lodScales[j], _lods[j], _lodPolicy);
+				_lods[j] = lod;
+
+				// the level decides between the indexed and the mesh shader pipeline
+				key = DrawKey(object.Mesh, object.Pipeline, object.Material, lod, -_eyes[j].z);
+				count++;
 			}
-			result = PrepareCommandBuffers(xi, x + update);
+
+			_draws[j] = VkDrawItem{ key, j, lod };
 		}
-		else if (update < 0)
+
+		// chunks are split like the objects; each chunk's level state is only touched by one worker
+		local = _chunks.size() / _threads.size();
+		remain = _chunks.size() % _threads.size();
+		offset = local * i + std::min(i, remain);
+		if (i < remain)
+			local++;
+
+		PrepareEntityDraws(offset, offset + local, focal, count);
+		enabled += count;
+	});
+
+	SortDraws(_draws, _drawsScratch, _threads.size(), FrameArena());
+	_draws.resize(enabled);
+}
+
+void Phusis::Internal::VkStateMachine::PrepareEntityDraws(uint32_t begin, uint32_t end, float focal, uint32_t& count)
+{
+	std::array<float, 1u << EntityRowBits> scales;
+	std::array<pre::vec4f, 1u << EntityRowBits> eyes;
+	for (uint32_t c = begin; c < end; ++c)
+	{
+		const VkEntityChunk& chunk = _chunks[c];
+
+		// the transform column is dense, so disabled rows cost a lane each and no branch
+		LodScales(&chunk.Transforms[0].World, sizeof(ObjectTransform), chunk.Chunk->Count(), _bound->View, focal, scales.data());
+
+		uint32_t rows = chunk.Chunk->Count();
+		for (uint32_t row = 0; row < rows; ++row)
+			eyes[row] = pre::from_glm(chunk.Transforms[row].World[3]);
+		pre::transform(_view, pre::span<const pre::vec4f>(eyes.data(), rows), pre::span<pre::vec4f>(eyes.data(), rows));
+
+		uint32_t slot = chunk.First;
+		chunk.Chunk->EachEnabled([this, &chunk, &scales, &eyes, &slot, &count, c](uint32_t row)
 		{
-			// find maximal
-			size_t x = -1, xi;
-			for (size_t i = 0; i < _threads.size(); ++i)
+			const ObjectRenderable& renderable = chunk.Renderables[row];
+			ObjectLod& state = chunk.Lods[row];
+
+			uint64_t key = DisabledDrawKey;
+			uint32_t lod = 0;
+			if (renderable.Mesh)
 			{
-				size_t loc = _threads[i].Buffers.size();
-				if (x > loc)
-					continue;
-				x = loc;
-				xi = i;
+				lod = SelectLod(*renderable.Mesh, scales[row], state.Level, _lodPolicy);
+				state.Level = lod;
+
+				key = DrawKey(*renderable.Mesh, renderable.Pipeline, renderable.Material, lod, -eyes[row].z);
+				count++;
 			}
-			result = PrepareCommandBuffers(xi, x + update);
-		}
-		break;
+
+			_draws[slot++] = VkDrawItem{ key, EntityDrawBit | c << EntityRowBits | row, lod };
+		});
 	}
+}
 
-	case Phusis::Internal::BufferDistributionStrategy::Uniform:
+bool Phusis::Internal::VkStateMachine::BatchBuffer()
+{
+	// contiguous slices of the sorted list keep each worker's state changes minimal
+	std::atomic<bool> result = true;
+	_workers.run([this, &result](uint32_t i)
 	{
-		uint32_t total = _knownTargetCount + update;
-		uint32_t count = total / _threads.size();
-		for (size_t i = 0; i < _threads.size(); ++i)
+		// the flight has retired; recycle this worker's buffers and scratch on the thread that owns them
+		uint32_t local = _draws.size() / _threads.size();
+		uint32_t remain = _draws.size() % _threads.size();
+		uint32_t offset = local * i + std::min(i, remain);
+		if (i < remain)
+			local++;
+
+		VkThreadData& data = Local();
+		bool prepared = data.Pools[_flight].Reset() && PrepareCommandBuffers(local);
+		data.Arenas[_flight].reset();
+
+		// the list still names last frame's buffers, which the reset has just invalidated
+		if (!prepared)
 		{
-			uint32_t local = count;
-			if (i < total % _threads.size())
-				local++;
-			result &= PrepareCommandBuffers(i, local);
+			data.Buffers.clear();
+			data.Stats = {};
+			result = false;
+			return;
 		}
-		break;
+
+		if (!BatchBufferLocal(offset, local))
+			result = false;
+	});
+
+	_stats = {};
+	for (const auto& data: _threads)
+		_stats += data.Stats;
+
+	return result;
+}
+
+bool Phusis::Internal::VkStateMachine::BeginSecondary(VkRecordState& state)
+{
+	VkThreadData& data = Local();
+
+	VkCommandBuffer buffer = data.Pools[_flight].Acquire();
+	if (!buffer)
+	{
+		sys::log.head(sys::FAIL) << "could not acquire command-buffer on thread " << data.Index << sys::EOM;
+		return false;
 	}
 
-	default:
-		sys::log.head(sys::CRIT) << "could not distribute buffers" << sys::EOM;
-		result = false;
-		break;
+	VkCommandBufferBeginInfo begin{};
+	begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	begin.pInheritanceInfo = &_local.Inheritance;
+
+	VkResult vkr = vkBeginCommandBuffer(buffer, &begin);
+	if (vkr != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not begin command-buffer; render result may be wrong" << sys::EOM;
+		return false;
 	}
 
-	if (result)
-		_knownTargetCount += update;
+	VkViewport viewport{};
+	viewport.width = static_cast<float>(_bound->Width);
+	viewport.height = static_cast<float>(_bound->Height);
+	viewport.maxDepth = 1.f;
+	viewport.minDepth = 0.f;
+	viewport.x = 0.f;
+	viewport.y = 0.f;
 
-	return result;
+	VkRect2D scissor{};
+	scissor.offset.x = 0;
+	scissor.offset.y = 0;
+	scissor.extent.width = _bound->Width;
+	scissor.extent.height = _bound->Height;
+
+	vkCmdSetViewport(buffer, 0, 1, &viewport);
+	vkCmdSetScissor(buffer, 0, 1, &scissor);
+
+	state = {};
+	state.Buffer = buffer;
+	state.Stats = &data.Stats;
+	state.Arena = &data.Arenas[_flight];
+	state.Objects = &data.Objects;
+
+	return true;
 }
 
-bool Phusis::Internal::VkStateMachine::BatchBuffer()
+const Phusis::MeshletLevel* Phusis::Internal::VkStateMachine::Clusters(const Mesh& mesh, uint32_t lod) noexcept
 {
-	std::vector<uint32_t> indices(_threads.size());
-	for (size_t i = 0; i < indices.size(); ++i)
-		indices[i] = i;
+	const auto& clusters = mesh.Clusters;
+	return lod < clusters.size() && clusters[lod].Count ? &clusters[lod] : nullptr;
+}
 
-	bool result = true;
-	std::for_each(std::execution::par_unseq, indices.begin(), indices.end(), [this, &result](uint32_t i)
+bool Phusis::Internal::VkStateMachine::MeshTasks(const Mesh& mesh, VkPipeline pipeline, uint32_t lod) const noexcept
+{
+	// a custom pipeline is a vertex pipeline; only the default one has a mesh shader counterpart
+	const MeshletLevel* level = Clusters(mesh, lod);
+	return level && level->Address && !pipeline &&
+		   _inheritance.CmdDrawMeshTasks && _inheritance.MeshPipeline && _inheritance.MeshPipelineLayout;
+}
+
+bool Phusis::Internal::VkStateMachine::Bindless(const Mesh& mesh, VkPipeline pipeline, uint32_t lod) const noexcept
+{
+	// mesh tasks win where both apply; they already take no vertex state
+	return !pipeline && _inheritance.BindlessPipeline && _inheritance.BindlessPipelineLayout && _inheritance.Upload &&
+		   !MeshTasks(mesh, pipeline, lod);
+}
+
+VkPipeline Phusis::Internal::VkStateMachine::DrawPipeline(const Mesh& mesh, VkPipeline pipeline, uint32_t lod) const noexcept
+{
+	if (MeshTasks(mesh, pipeline, lod))
+		return _inheritance.MeshPipeline;
+	if (Bindless(mesh, pipeline, lod))
+		return _inheritance.BindlessPipeline;
+	return pipeline ? pipeline : _inheritance.Pipeline;
+}
+
+uint64_t Phusis::Internal::VkStateMachine::DrawKey(const Mesh& mesh, VkPipeline pipeline, uint32_t material, uint32_t lod, float depth) const noexcept
+{
+	// without the material in the key, objects of one mesh sort together and merge into instanced draws
+	VkPipeline drawn = DrawPipeline(mesh, pipeline, lod);
+	return MakeSortKey(drawn, drawn && drawn == _inheritance.BindlessPipeline ? 0 : material, mesh, depth);
+}
+
+void Phusis::Internal::VkStateMachine::RecordMeshTasks(VkRecordState& state, const VkObjectView& object, uint32_t lod)
+{
+	VkRecordStats& stats = *state.Stats;
+	const Mesh& mesh = *object.Mesh;
+	const MeshletLevel& level = mesh.Clusters[lod];
+
+	FlushInstances(state);
+
+	if (state.Pipeline != _inheritance.MeshPipeline)
 	{
-		uint32_t local = _bound->Objects.size() / _threads.size();
-		uint32_t remain = _bound->Objects.size() % _threads.size();
-		uint32_t offset = local * i + std::min(i, remain);
-		if (i < remain)
-			local++;
+		vkCmdBindPipeline(state.Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _inheritance.MeshPipeline);
+		state.Pipeline = _inheritance.MeshPipeline;
+		stats.PipelineBinds++;
+	}
+	else
+	{
+		stats.RedundantPipelineBinds++;
+	}
 
-		bool loc = BatchBufferLocal(i, offset, local);
-		__sync_and_and_fetch(&result, loc);
-	});
-	return result;
+	// culling happens in the task shader, so every meshlet is dispatched
+	MeshletConstantBlock blk(_viewProjection * pre::from_glm(*object.World), *object.Color, level, mesh.Dequantization);
+	vkCmdPushConstants(state.Buffer, _inheritance.MeshPipelineLayout, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, 0, sizeof(MeshletConstantBlock), &blk);
+	state.Bindless = false;
+	_inheritance.CmdDrawMeshTasks(state.Buffer, (level.Count + MeshletTaskGroup - 1) / MeshletTaskGroup, 1, 1);
+
+	stats.Draws++;
+	stats.Clusters += level.Count;
+	if (lod < mesh.Indices.size())
+		stats.Triangles += mesh.Indices[lod].Count / 3;
 }
 
-bool Phusis::Internal::VkStateMachine::BatchBufferLocal(uint32_t idx, uint32_t offset, uint32_t size)
+void Phusis::Internal::VkStateMachine::RecordObject(VkRecordState& state, const VkObjectView& object, uint32_t lod, uint32_t slot)
 {
-	bool result = true;
-	for (uint32_t i = 0; i < size; ++i)
+	VkRecordStats& stats = *state.Stats;
+	const Mesh& mesh = *object.Mesh;
+	const glm::mat4& world = *object.World;
+
+	if (MeshTasks(mesh, object.Pipeline, lod))
 	{
-		EngineObjectData object = _bound->Objects[offset + i];
-		if (!object.enabled)
-			continue;
+		RecordMeshTasks(state, object, lod);
+		return;
+	}
+
+	// object to world with the dequantization, for the bindless record and the push constants alike
+	pre::mat4f model = pre::from_glm(world) * pre::from_glm(mesh.Dequantization);
+
+	// each slot has its own record in the worker's block, streamed past the cache into the mapped ring
+	const VkObjectBlock& block = *state.Objects;
+	uint32_t row = slot - block.First;
+	bool bindless = row < block.Count && Bindless(mesh, object.Pipeline, lod);
+	uint32_t instance = bindless ? block.Base + row : 0;
+	if (bindless)
+	{
+		BindlessObject record{ pre::to_glm(model), *object.Color, object.Material, {} };
+		VkUploadRing::Stream(&block.Data[row], &record, sizeof(BindlessObject));
+	}
+
+	const MeshletLevel* level = Clusters(mesh, lod);
+
+	// cluster culling on this worker; the surviving index ranges replace the level's single draw
+	sys::arena_vector<MeshletRun> runs(sys::arena_allocator<MeshletRun>(*state.Arena));
+	bool culled = level && _clusterCulling;
+	if (culled)
+	{
+		runs.resize(level->Count);
+		runs.resize(CullMeshlets(level->Meshlets, level->Count, MakeMeshletFrustum(_bound->Projection, _bound->View * world), runs.data()));
 
-		VkCommandBuffer buffer = _threads[idx].Buffers[i];
+		uint32_t survived = 0;
+		for (const auto& run: runs)
+			survived += run.Count;
+		stats.Clusters += level->Count;
+		stats.ClustersCulled += level->Count - survived;
 
-		VkResult vkr;
+		// nothing left: no binds either
+		if (runs.empty())
+			return;
+	}
+
+	const auto& vertices = mesh.Vertices;
+	const auto& indices = mesh.Indices;
+
+	// meshes are held by value, so identity is the set of vertex buffer handles and offsets
+	bool rebind = !state.Mesh || state.Mesh->Vertices.size() != vertices.size();
+	for (size_t j = 0; !rebind && j < vertices.size(); ++j)
+		rebind = state.Mesh->Vertices[j].Array != vertices[j].Array || state.Mesh->Vertices[j].Offset != vertices[j].Offset;
+
+	const Buffer* index = lod < indices.size() ? &indices[lod] : nullptr;
+
+	// the next record of the same geometry becomes one more instance of the pending draw
+	if (bindless && !culled && index && state.InstanceCount && !rebind &&
+		state.InstanceFirst + state.InstanceCount == instance && state.InstanceIndices == index->Count &&
+		state.IndexBuffer == index->Array && state.IndexOffset == index->Offset)
+	{
+		state.InstanceCount++;
+		stats.Instances++;
+		stats.Triangles += index->Count / 3;
+		return;
+	}
+
+	FlushInstances(state);
 
-		VkCommandBufferBeginInfo begin{};
-		begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		begin.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
-		begin.pInheritanceInfo = &_local.Inheritance;
+	VkPipeline pipeline = bindless ? _inheritance.BindlessPipeline : object.Pipeline ? object.Pipeline : _inheritance.Pipeline;
+	if (state.Pipeline != pipeline)
+	{
+		vkCmdBindPipeline(state.Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		state.Pipeline = pipeline;
+		stats.PipelineBinds++;
+	}
+	else
+	{
+		stats.RedundantPipelineBinds++;
+	}
 
-		vkr = vkBeginCommandBuffer(buffer, &begin);
-		if (vkr != VK_SUCCESS)
+	if (bindless)
+	{
+		// the set and view-projection hold for the whole buffer until a push through another layout
+		if (!state.Bindless)
 		{
-			sys::log.head(sys::FAIL) << "could not begin command-buffer; render vkr may be wrong" << sys::EOM;
-			result = false;
-			continue;
+			vkCmdBindDescriptorSets(state.Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _inheritance.BindlessPipelineLayout, 0, 1, &_inheritance.BindlessSets[_flight], 0, nullptr);
+
+			BindlessConstantBlock blk(_viewProjection);
+			vkCmdPushConstants(state.Buffer, _inheritance.BindlessPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(BindlessConstantBlock), &blk);
+			state.Bindless = true;
 		}
+	}
+	else
+	{
+		ConstantBlock blk(_viewProjection * model, *object.Color);
+		vkCmdPushConstants(state.Buffer, _inheritance.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ConstantBlock), &blk);
+		state.Bindless = false;
+	}
 
-		VkViewport viewport{};
-		viewport.width = static_cast<float>(_bound->Width);
-		viewport.height = static_cast<float>(_bound->Height);
-		viewport.maxDepth = 1.f;
-		viewport.minDepth = 0.f;
-		viewport.x = 0.f;
-		viewport.y = 0.f;
+	if (rebind)
+	{
+		sys::arena_vector<VkDeviceSize> offsets(vertices.size(), sys::arena_allocator<VkDeviceSize>(*state.Arena));
+		sys::arena_vector<VkBuffer> buffers(vertices.size(), sys::arena_allocator<VkBuffer>(*state.Arena));
+		for (size_t j = 0; j < buffers.size(); ++j)
+		{
+			buffers[j] = vertices[j].Array;
+			offsets[j] = vertices[j].Offset;
+		}
 
-		VkRect2D scissor{};
-		scissor.offset.x = 0;
-		scissor.offset.y = 0;
-		scissor.extent.width = _bound->Width;
-		scissor.extent.height = _bound->Height;
+		vkCmdBindVertexBuffers(state.Buffer, 0, buffers.size(), buffers.data(), offsets.data());
+		state.Mesh = &mesh;
+		stats.VertexBinds++;
+	}
+	else
+	{
+		stats.RedundantVertexBinds++;
+	}
 
-		vkCmdSetViewport(buffer, 0, 1, &viewport);
-		vkCmdSetScissor(buffer, 0, 1, &scissor);
-		vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _inheritance.Pipeline);
+	if (!index)
+		return;
 
-		ConstantBlock blk(_bound->Projection * _bound->View * object.Rotation, object.Color);
-		vkCmdPushConstants(buffer, _inheritance.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ConstantBlock), &blk);
+	if (state.IndexBuffer != index->Array || state.IndexOffset != index->Offset)
+	{
+		vkCmdBindIndexBuffer(state.Buffer, index->Array, index->Offset, VK_INDEX_TYPE_UINT32);
+		state.IndexBuffer = index->Array;
+		state.IndexOffset = index->Offset;
+		stats.IndexBinds++;
+	}
+	else
+	{
+		stats.RedundantIndexBinds++;
+	}
 
-		std::vector<VkDeviceSize> offsets(object.Mesh.Vertices.size());
-		offsets.assign(offsets.size(), 0);
+	if (!culled)
+	{
+		stats.Triangles += index->Count / 3;
 
-		std::vector<VkBuffer> buffers(object.Mesh.Vertices.size());
-		for (size_t j = 0; j < buffers.size(); ++j)
-			buffers[j] = object.Mesh.Vertices[j].Array;
+		// held back in case the following draws share the geometry
+		if (bindless)
+		{
+			state.InstanceFirst = instance;
+			state.InstanceCount = 1;
+			state.InstanceIndices = index->Count;
+			return;
+		}
 
-		vkCmdBindVertexBuffers(buffer, 0, buffers.size(), buffers.data(), offsets.data());
+		vkCmdDrawIndexed(state.Buffer, index->Count, 1, 0, 0, instance);
+		stats.Draws++;
+		return;
+	}
 
-		for (size_t j = 0; j < buffers.size(); ++j)
+	for (const auto& run: runs)
+		stats.Triangles += run.IndexCount / 3;
+
+	// the surviving runs as commands in the upload ring, drawn by a single call
+	VkUploadAllocation commands{ nullptr, 0 };
+	if (_inheritance.Upload && runs.size() > 1 && runs.size() <= _inheritance.DrawIndirectCount)
+		commands = _inheritance.Upload->Allocate(runs.size() * sizeof(VkDrawIndexedIndirectCommand), sizeof(VkDrawIndexedIndirectCommand));
+
+	if (commands.Data)
+	{
+		auto* command = reinterpret_cast<VkDrawIndexedIndirectCommand*>(commands.Data);
+		for (size_t k = 0; k < runs.size(); ++k)
+			command[k] = VkDrawIndexedIndirectCommand{ runs[k].IndexCount, 1, runs[k].FirstIndex, 0, instance };
+
+		vkCmdDrawIndexedIndirect(state.Buffer, _inheritance.Upload->Buffer(), commands.Offset, runs.size(), sizeof(VkDrawIndexedIndirectCommand));
+		stats.Draws++;
+		return;
+	}
+
+	// a full ring or no multi-draw indirect
+	for (const auto& run: runs)
+		vkCmdDrawIndexed(state.Buffer, run.IndexCount, 1, run.FirstIndex, 0, instance);
+	stats.Draws += runs.size();
+}
+
+void Phusis::Internal::VkStateMachine::FlushInstances(VkRecordState& state)
+{
+	if (!state.InstanceCount)
+		return;
+
+	vkCmdDrawIndexed(state.Buffer, state.InstanceIndices, state.InstanceCount, 0, 0, state.InstanceFirst);
+	state.Stats->Draws++;
+	state.InstanceCount = 0;
+}
+
+bool Phusis::Internal::VkStateMachine::EndSecondary(VkRecordState& state)
+{
+	FlushInstances(state);
+
+	VkResult vkr = vkEndCommandBuffer(state.Buffer);
+	if (vkr != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not end command-buffer; render result may be wrong" << sys::EOM;
+		return false;
+	}
+
+	Local().Buffers.push_back(state.Buffer);
+	state.Buffer = nullptr;
+	return true;
+}
+
+bool Phusis::Internal::VkStateMachine::BatchBufferLocal(uint32_t offset, uint32_t size)
+{
+	Local().Buffers.clear();
+	Local().Stats = {};
+
+	// one record per slot of the slice, whichever path its draw takes; a full ring leaves the block empty
+	VkObjectBlock& objects = Local().Objects;
+	objects = VkObjectBlock{ nullptr, 0, offset, 0 };
+	if (_inheritance.Upload && _inheritance.BindlessPipeline && size)
+	{
+		VkUploadAllocation allocation = _inheritance.Upload->Allocate(size * sizeof(BindlessObject), sizeof(BindlessObject));
+		if (allocation.Data)
 		{
-			vkCmdBindIndexBuffer(buffer, buffers[j], 0, VK_INDEX_TYPE_UINT32);
-			vkCmdDrawIndexed(buffer, object.Mesh.Indices[j].Count, 1, 0, 0, 0);
+			objects.Data = reinterpret_cast<BindlessObject*>(allocation.Data);
+			objects.Base = (allocation.Offset - _inheritance.Upload->RegionOffset(_flight)) / sizeof(BindlessObject);
+			objects.Count = size;
 		}
+	}
 
-		result = vkEndCommandBuffer(buffer);
-		if (result != VK_SUCCESS)
+	bool result = true;
+	VkRecordState state{};
+	for (uint32_t i = 0; i < size; ++i)
+	{
+		const VkDrawItem& draw = _draws[offset + i];
+
+		// batched: one secondary for the whole chunk, begun lazily so empty chunks record nothing
+		if (!state.Buffer && !BeginSecondary(state))
 		{
-			sys::log.head(sys::FAIL) << "could not end command-buffer; render result may be wrong" << sys::EOM;
 			result = false;
 			continue;
 		}
+
+		RecordObject(state, View(draw.Index), draw.Lod, offset + i);
+
+		if (_mode == RecordingMode::PerObject)
+			result &= EndSecondary(state);
 	}
+
+	if (state.Buffer)
+		result &= EndSecondary(state);
+
+	Local().Stats.CommandBuffers = Local().Buffers.size();
+	Local().Stats.ArenaBytes = Local().Arenas[_flight].used();
+
+	// the records are read by the submitting thread's flush and the GPU
+	if (objects.Count)
+		VkUploadRing::StreamFence();
+
 	return result;
 }
 
+void Phusis::Internal::VkStateMachine::PrepareInheritance()
+{
+	VkCommandBufferInheritanceInfo& inherit = _local.Inheritance;
+	inherit = {};
+	inherit.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+	if (_inheritance.DynamicRendering)
+	{
+		// secondaries only see attachment formats, so they stay valid across swapchain images and resizes
+		VkCommandBufferInheritanceRenderingInfoKHR& rendering = _local.Rendering;
+		rendering = {};
+		rendering.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+		rendering.colorAttachmentCount = 1;
+		rendering.pColorAttachmentFormats = &_inheritance.ColorFormat;
+		rendering.depthAttachmentFormat = _frame->DepthView ? _inheritance.DepthFormat : VK_FORMAT_UNDEFINED;
+		rendering.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+		rendering.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		inherit.pNext = &rendering;
+	}
+	else
+	{
+		inherit.renderPass = _inheritance.RenderPass;
+		inherit.framebuffer = _frame->Framebuffer;
+	}
+}
+
+void Phusis::Internal::VkStateMachine::BeginRendering()
+{
+	VkImageMemoryBarrier2KHR barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+	barrier.srcAccessMask = VK_ACCESS_2_NONE;
+	barrier.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+	barrier.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = _frame->Image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+
+	// the depth image is shared by the frames in flight; wait out the previous frame's tests before clearing it
+	VkImageMemoryBarrier2KHR depthBarrier{};
+	depthBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	depthBarrier.srcStageMask = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+	depthBarrier.srcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depthBarrier.dstStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+	depthBarrier.dstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depthBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	depthBarrier.image = _frame->DepthImage;
+	depthBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	depthBarrier.subresourceRange.levelCount = 1;
+	depthBarrier.subresourceRange.layerCount = 1;
+
+	std::array<VkImageMemoryBarrier2KHR, 2> barriers = { barrier, depthBarrier };
+
+	VkDependencyInfoKHR dependency{};
+	dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependency.imageMemoryBarrierCount = _frame->DepthView ? 2 : 1;
+	dependency.pImageMemoryBarriers = barriers.data();
+
+	_inheritance.CmdPipelineBarrier2(_flights[_flight].Buffer, &dependency);
+
+	VkRenderingAttachmentInfoKHR color{};
+	color.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	color.imageView = _frame->View;
+	color.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	color.clearValue.color = _inheritance.ClearColor;
+
+	VkRenderingAttachmentInfoKHR depth{};
+	depth.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	depth.imageView = _frame->DepthView;
+	depth.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depth.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depth.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depth.clearValue.depthStencil = {1.f, 0};
+
+	VkRenderingInfoKHR rendering{};
+	rendering.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+	rendering.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR;
+	rendering.renderArea.offset.x = 0;
+	rendering.renderArea.offset.y = 0;
+	rendering.renderArea.extent.width = _bound->Width;
+	rendering.renderArea.extent.height = _bound->Height;
+	rendering.layerCount = 1;
+	rendering.colorAttachmentCount = 1;
+	rendering.pColorAttachments = &color;
+	rendering.pDepthAttachment = _frame->DepthView ? &depth : nullptr;
+
+	_inheritance.CmdBeginRendering(_flights[_flight].Buffer, &rendering);
+}
+
+void Phusis::Internal::VkStateMachine::EndRendering()
+{
+	_inheritance.CmdEndRendering(_flights[_flight].Buffer);
+
+	VkImageMemoryBarrier2KHR barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+	barrier.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_2_NONE;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = _frame->Image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+
+	VkDependencyInfoKHR dependency{};
+	dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependency.imageMemoryBarrierCount = 1;
+	dependency.pImageMemoryBarriers = &barrier;
+
+	_inheritance.CmdPipelineBarrier2(_flights[_flight].Buffer, &dependency);
+}
+
 bool Phusis::Internal::VkStateMachine::BeginDraw()
 {
 	VkResult result;
 
+	PrepareInheritance();
+
+	VkCommandBufferBeginInfo buffer{};
+	buffer.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+	result = vkBeginCommandBuffer(_flights[_flight].Buffer, &buffer);
+	if (result != VK_SUCCESS)
+	{
+		sys::log.head(sys::CRIT) << "could not begin command-buffer" << sys::EOM;
+		return false;
+	}
+
+	// resets are not allowed inside a render pass
+	if (VkQueryPool queries = _flights[_flight].Queries)
+	{
+		vkCmdResetQueryPool(_flights[_flight].Buffer, queries, 0, 2);
+		vkCmdWriteTimestamp(_flights[_flight].Buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queries, 0);
+	}
+
+	if (_inheritance.DynamicRendering)
+	{
+		BeginRendering();
+		return true;
+	}
+
 	VkClearValue clears[2];
 	clears[0].color = _inheritance.ClearColor;
 	clears[1].depthStencil = {1.f, 0};
@@ -245,33 +862,28 @@ bool Phusis::Internal::VkStateMachine::BeginDraw()
 	pass.pClearValues = clears;
 	pass.framebuffer = _frame->Framebuffer;
 
-	VkCommandBufferBeginInfo buffer{};
-	buffer.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-
-	VkCommandBufferInheritanceInfo inherit{};
-	inherit.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
-	inherit.renderPass = pass.renderPass;
-	inherit.framebuffer = pass.framebuffer;
-
-	result = vkBeginCommandBuffer(_inheritance.Buffer, &buffer);
-	if (result != VK_SUCCESS)
-	{
-		sys::log.head(sys::CRIT) << "could not begin command-buffer" << sys::EOM;
-		return false;
-	}
-
-	vkCmdBeginRenderPass(_inheritance.Buffer, &pass, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	vkCmdBeginRenderPass(_flights[_flight].Buffer, &pass, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
 	return true;
 }
 
-bool Phusis::Internal::VkStateMachine::EndDraw()
+bool Phusis::Internal::VkStateMachine::EndDraw(bool execute)
 {
-	for (const auto& thread : _threads)
-		vkCmdExecuteCommands(_inheritance.Buffer, thread.Buffers.size(), thread.Buffers.data());
-	vkCmdEndRenderPass(_inheritance.Buffer);
+	// workers whose slice was empty recorded nothing, and a zero count is invalid
+	if (execute)
+		for (const auto& thread : _threads)
+			if (!thread.Buffers.empty())
+				vkCmdExecuteCommands(_flights[_flight].Buffer, thread.Buffers.size(), thread.Buffers.data());
 
-	VkResult result = vkEndCommandBuffer(_inheritance.Buffer);
+	if (_inheritance.DynamicRendering)
+		EndRendering();
+	else
+		vkCmdEndRenderPass(_flights[_flight].Buffer);
+
+	if (VkQueryPool queries = _flights[_flight].Queries)
+		vkCmdWriteTimestamp(_flights[_flight].Buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queries, 1);
+
+	VkResult result = vkEndCommandBuffer(_flights[_flight].Buffer);
 	if (result != VK_SUCCESS)
 	{
 		sys::log.head(sys::CRIT) << "could not end command-buffer" << sys::EOM;
@@ -281,26 +893,93 @@ bool Phusis::Internal::VkStateMachine::EndDraw()
 	return true;
 }
 
-bool Phusis::Internal::VkStateMachine::Submit()
+bool Phusis::Internal::VkStateMachine::WaitFlight()
 {
+	VkFlightData& flight = _flights[_flight];
+
 	VkResult fence;
 	do
 	{
-		fence = vkWaitForFences(_inheritance.Device, 1, &_renderFence, VK_TRUE, 100000000);
+		fence = vkWaitForFences(_inheritance.Device, 1, &flight.Fence, VK_TRUE, 100000000);
 	} while (fence == VK_TIMEOUT);
 	if (fence != VK_SUCCESS)
 	{
-		sys::log.head(sys::CRIT) << "could not submit command-buffer" << sys::EOM;
+		sys::log.head(sys::CRIT) << "could not wait for frame in flight" << sys::EOM;
 		return false;
 	}
-	vkResetFences(_inheritance.Device, 1, &_renderFence);
+
+	// the fence has signaled, so both timestamps are available without waiting
+	uint64_t ticks[2];
+	if (flight.Queries && flight.Serial &&
+		vkGetQueryPoolResults(_inheritance.Device, flight.Queries, 0, 2, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+	{
+		uint64_t mask = _inheritance.TimestampBits >= 64 ? UINT64_MAX : (uint64_t(1) << _inheritance.TimestampBits) - 1;
+		_timings.Gpu = ((ticks[1] - ticks[0]) & mask) * static_cast<double>(_inheritance.TimestampPeriod) / 1000.;
+	}
+
+	// worker pools and arenas are recycled by their owners in BatchBuffer
+	_arenas[_flight].reset();
+
+	return true;
+}
+
+sys::arena& Phusis::Internal::VkStateMachine::FrameArena() noexcept
+{
+	return _arenas[_flight];
+}
+
+const glm::mat4& Phusis::Internal::VkStateMachine::World(uint32_t idx) const noexcept
+{
+	return _bound->Hierarchy ? _bound->Hierarchy->Worlds()[idx] : _bound->Transforms[idx].Rotation;
+}
+
+Phusis::Internal::VkObjectView Phusis::Internal::VkStateMachine::View(uint32_t index) const noexcept
+{
+	if (!(index & EntityDrawBit))
+	{
+		const EngineObjectData& object = _bound->Objects[index];
+		return VkObjectView{ &object.Mesh, object.Pipeline, &World(index), &_bound->Transforms[index].Color, object.Material };
+	}
+
+	const VkEntityChunk& chunk = _chunks[(index & ~EntityDrawBit) >> EntityRowBits];
+	uint32_t row = index & ((1u << EntityRowBits) - 1);
+	const ObjectRenderable& renderable = chunk.Renderables[row];
+	return VkObjectView{ renderable.Mesh, renderable.Pipeline, &chunk.Transforms[row].World, &chunk.Colors[row].Color, renderable.Material };
+}
+
+Phusis::Internal::VkThreadData& Phusis::Internal::VkStateMachine::Local() noexcept
+{
+	return _threads[sys::workers::current()];
+}
+
+bool Phusis::Internal::VkStateMachine::Submit()
+{
+	VkFlightData& flight = _flights[_flight];
+
+	vkResetFences(_inheritance.Device, 1, &flight.Fence);
 
 	VkSubmitInfo submit{};
 	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	submit.commandBufferCount = 1;
-	submit.pCommandBuffers = &_inheritance.Buffer;
+	submit.pCommandBuffers = &flight.Buffer;
+
+	// only frames rendered into an acquired swapchain image synchronize with presentation
+	VkPipelineStageFlags stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	if (_acquired)
+	{
+		submit.waitSemaphoreCount = 1;
+		submit.pWaitSemaphores = &flight.Acquired;
+		submit.pWaitDstStageMask = &stage;
+		submit.signalSemaphoreCount = 1;
+		submit.pSignalSemaphores = &flight.Rendered;
+	}
+
+	VkResult result = vkQueueSubmit(_inheritance.Queue, 1, &submit, flight.Fence);
+	_submitted = _flight;
+	_flight = (_flight + 1) % FramesInFlight;
+	_frameNumber++;
+	flight.Serial = _frameNumber;
 
-	VkResult result = vkQueueSubmit(_inheritance.Queue, 1, &submit, _renderFence);
 	if (result != VK_SUCCESS)
 	{
 		sys::log.head(sys::CRIT) << "could not submit command-buffer" << sys::EOM;
@@ -310,20 +989,186 @@ bool Phusis::Internal::VkStateMachine::Submit()
 	return true;
 }
 
+void Phusis::Internal::VkStateMachine::Bind(const VkBoundData* bound, const VkFrameData* frame) noexcept
+{
+	_bound = bound;
+	_frame = frame;
+}
+
+void Phusis::Internal::VkStateMachine::SetLodPolicy(const LodPolicy& policy) noexcept
+{
+	_lodPolicy = policy;
+}
+
+void Phusis::Internal::VkStateMachine::SetClusterCulling(bool enabled) noexcept
+{
+	_clusterCulling = enabled;
+}
+
+bool Phusis::Internal::VkStateMachine::WaitLatency()
+{
+	// with two frames in flight the next flight slot is the one frame N-2 was submitted on
+	VkFence fence = _flights[_flight].Fence;
+
+	VkResult result;
+	do
+	{
+		result = vkWaitForFences(_inheritance.Device, 1, &fence, VK_TRUE, 100000000);
+	} while (result == VK_TIMEOUT);
+
+	return result == VK_SUCCESS;
+}
+
+void Phusis::Internal::VkStateMachine::SampleInput(std::chrono::steady_clock::time_point time) noexcept
+{
+	_input = time;
+}
+
+VkResult Phusis::Internal::VkStateMachine::Acquire(VkSwapchainKHR swapchain, uint32_t& image)
+{
+	// the semaphore was last waited on by frame N-2's submission
+	if (!WaitLatency())
+		return VK_ERROR_DEVICE_LOST;
+
+	VkResult result = vkAcquireNextImageKHR(
+			_inheritance.Device, swapchain, UINT64_MAX, _flights[_flight].Acquired, nullptr, &image);
+	_acquired = result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+
+	return result;
+}
+
+VkResult Phusis::Internal::VkStateMachine::Present(VkSwapchainKHR swapchain, uint32_t image)
+{
+	VkPresentInfoKHR info{};
+	info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	info.waitSemaphoreCount = 1;
+	info.pWaitSemaphores = &_flights[_submitted].Rendered;
+	info.swapchainCount = 1;
+	info.pSwapchains = &swapchain;
+	info.pImageIndices = &image;
+
+	VkResult result = vkQueuePresentKHR(_inheritance.Queue, &info);
+	_acquired = false;
+
+	auto now = std::chrono::steady_clock::now();
+	_timings.Latency = _input == std::chrono::steady_clock::time_point{}
+					   ? 0
+					   : std::chrono::duration<double, std::micro>(now - _input).count();
+	_input = {};
+
+	return result;
+}
+
 void Phusis::Internal::VkStateMachine::Start()
 {
 	PrepareSecondaryPools();
+	PrepareFlights();
 }
 
-void Phusis::Internal::VkStateMachine::Update()
+bool Phusis::Internal::VkStateMachine::Update()
 {
+	using clock = std::chrono::steady_clock;
+	auto micros = [](clock::time_point from, clock::time_point to)
+	{
+		return std::chrono::duration<double, std::micro>(to - from).count();
+	};
+
 	clock_t curT = std::clock();
+	clock::time_point start = clock::now();
+
+	// the channel may link objects added since the last update
+	if (_bound->Hierarchy)
+		_bound->Hierarchy->Resize(_bound->Transforms.size());
+	if (_bound->Channel)
+		_bound->Channel->Consume(_bound->Transforms, _bound->Hierarchy);
+	if (_bound->Hierarchy)
+		_bound->Hierarchy->Update(_bound->Transforms, _workers);
+	clock::time_point consumed = clock::now();
+
+	if (!WaitFlight())
+		return false;
+	clock::time_point waited = clock::now();
+
+	// the GPU is done with everything this flight uploaded
+	if (_inheritance.Upload)
+		_inheritance.Upload->Reset(_flight);
+
+	uint64_t allocations = sys::allocations();
+
+	// entities count whether enabled or not, like objects
+	uint32_t count = _bound->Objects.size() + (_bound->Entities ? _bound->Entities->Count() : 0);
+	bool steady = count == _knownTargetCount && _frameNumber > 2 * FramesInFlight;
+	_knownTargetCount = count;
+
+	PrepareDraws();
+	clock::time_point prepared = clock::now();
 
 	BeginDraw();
-	BatchBuffer();
-	EndDraw();
-	Submit();
+	bool complete = BatchBuffer();
+	clock::time_point recorded = clock::now();
+
+	// an incomplete frame is still submitted, only cleared, so the acquired image's semaphores, the
+	// fence and the flight order stay balanced; what was recorded is never executed
+	if (!complete)
+		sys::log.head(sys::FAIL) << "frame " << _frameNumber << " recorded incompletely; submitted without draws" << sys::EOM;
+	EndDraw(complete);
+	if (_inheritance.Upload)
+		_inheritance.Upload->Flush();
+	bool submittedFrame = Submit();
+	clock::time_point submitted = clock::now();
+
+	_timings.Wait = micros(consumed, waited);
+	_timings.Prepare = micros(start, consumed) + micros(waited, prepared);
+	_timings.Record = micros(prepared, recorded);
+	_timings.Submit = micros(recorded, submitted);
+	_timings.Latency = 0;
+
+	// zero with PHUSIS_COUNT_ALLOCATIONS unset
+	allocations = sys::allocations() - allocations;
+	_stats.Allocations = allocations;
+	if (steady && allocations)
+	{
+		sys::log.head(sys::WARN) << allocations << " heap allocations in steady-state frame " << _frameNumber << sys::EOM;
+	}
 
 	_deltaT = curT - _previousT;
 	_previousT = curT;
+
+	return submittedFrame;
+}
+
+const Phusis::Internal::VkFrameTimings& Phusis::Internal::VkStateMachine::Timings() const noexcept
+{
+	return _timings;
+}
+
+uint64_t Phusis::Internal::VkStateMachine::FrameNumber() const noexcept
+{
+	return _frameNumber;
+}
+
+uint64_t Phusis::Internal::VkStateMachine::CompletedFrames() noexcept
+{
+	// the oldest flight still executing bounds what has completed; no ordering between fences is assumed
+	uint64_t completed = _frameNumber;
+	for (const auto& flight: _flights)
+	{
+		if (flight.Serial <= _completed)
+			continue;
+		if (vkGetFenceStatus(_inheritance.Device, flight.Fence) != VK_SUCCESS)
+			completed = std::min(completed, flight.Serial - 1);
+	}
+
+	_completed = std::max(_completed, completed);
+	return _completed;
+}
+
+sys::workers& Phusis::Internal::VkStateMachine::Workers() noexcept
+{
+	return _workers;
+}
+
+const Phusis::Internal::VkRecordStats& Phusis::Internal::VkStateMachine::Statistics() const noexcept
+{
+	return _stats;
 }
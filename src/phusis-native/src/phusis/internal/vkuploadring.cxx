@@ -0,0 +1,191 @@
+#include "phusis/internal/vkuploadring.hxx"
+#include "sys/logger.hxx"
+
+static uint32_t MemoryType(const VkPhysicalDeviceMemoryProperties& properties, uint32_t bits, VkMemoryPropertyFlags flags) noexcept
+{
+	for (uint32_t i = 0; i < properties.memoryTypeCount; ++i)
+		if ((bits & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags)
+			return i;
+
+	return UINT32_MAX;
+}
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+Phusis::Internal::VkUploadRing::~VkUploadRing() noexcept
+{
+	Release();
+}
+
+bool Phusis::Internal::VkUploadRing::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize region, uint32_t regions, VkBufferUsageFlags usage) noexcept
+{
+	Release();
+	_device = device;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	const VkPhysicalDeviceLimits& limits = properties.limits;
+
+	// every region start is a valid offset for any binding and a whole number of flush atoms
+	VkDeviceSize alignment = 64;
+	for (VkDeviceSize a: { limits.minStorageBufferOffsetAlignment, limits.minUniformBufferOffsetAlignment, limits.nonCoherentAtomSize })
+		alignment = std::max(alignment, a);
+
+	_region = AlignUp(region, alignment);
+	_regions = regions;
+	_atom = std::max<VkDeviceSize>(limits.nonCoherentAtomSize, 1);
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = _region * _regions;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(_device, &bufferInfo, nullptr, &_buffer) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not create upload ring buffer" << sys::EOM;
+		_buffer = nullptr;
+		return false;
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(_device, _buffer, &requirements);
+
+	VkPhysicalDeviceMemoryProperties memory;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memory);
+
+	// written once per frame and read once by the GPU: device-local where the host can see it, coherent
+	// to skip the flush, plain host-visible as the last resort
+	constexpr VkMemoryPropertyFlags visible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	constexpr VkMemoryPropertyFlags coherent = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	uint32_t type = MemoryType(memory, requirements.memoryTypeBits, coherent | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (type == UINT32_MAX)
+		type = MemoryType(memory, requirements.memoryTypeBits, coherent);
+	if (type == UINT32_MAX)
+		type = MemoryType(memory, requirements.memoryTypeBits, visible);
+	if (type == UINT32_MAX)
+	{
+		sys::log.head(sys::FAIL) << "no host-visible memory for the upload ring" << sys::EOM;
+		Release();
+		return false;
+	}
+	_coherent = memory.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	VkMemoryAllocateInfo allocate{};
+	allocate.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate.allocationSize = requirements.size;
+	allocate.memoryTypeIndex = type;
+
+	if (vkAllocateMemory(_device, &allocate, nullptr, &_memory) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not allocate upload ring memory" << sys::EOM;
+		_memory = nullptr;
+		Release();
+		return false;
+	}
+
+	void* mapped = nullptr;
+	if (vkBindBufferMemory(_device, _buffer, _memory, 0) != VK_SUCCESS ||
+		vkMapMemory(_device, _memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not map upload ring memory" << sys::EOM;
+		Release();
+		return false;
+	}
+
+	_mapped = static_cast<uint8_t*>(mapped);
+	Reset(0);
+
+	sys::log.head(sys::INFO) << "upload ring mapped: " << _regions << " x " << _region << " bytes"
+							 << (_coherent ? "" : ", flushed per frame") << sys::EOM;
+
+	return true;
+}
+
+void Phusis::Internal::VkUploadRing::Release() noexcept
+{
+	if (!_device)
+		return;
+
+	// the mapping goes with the memory
+	vkDestroyBuffer(_device, _buffer, nullptr);
+	vkFreeMemory(_device, _memory, nullptr);
+
+	_device = nullptr;
+	_buffer = nullptr;
+	_memory = nullptr;
+	_mapped = nullptr;
+	_region = 0;
+	_regions = 0;
+	_head = 0;
+}
+
+void Phusis::Internal::VkUploadRing::Reset(uint32_t flight) noexcept
+{
+	_flight = flight;
+	_head.store(0, std::memory_order_relaxed);
+}
+
+Phusis::Internal::VkUploadAllocation Phusis::Internal::VkUploadRing::Allocate(VkDeviceSize size, VkDeviceSize alignment) noexcept
+{
+	if (!_mapped)
+		return { nullptr, 0 };
+
+	// a failed allocation leaves the head alone, so smaller ones may still fit after it
+	VkDeviceSize head = _head.load(std::memory_order_relaxed);
+	VkDeviceSize offset;
+	do
+	{
+		offset = AlignUp(head, std::max<VkDeviceSize>(alignment, 1));
+		if (offset + size > _region)
+			return { nullptr, 0 };
+	} while (!_head.compare_exchange_weak(head, offset + size, std::memory_order_relaxed));
+
+	VkDeviceSize base = RegionOffset(_flight);
+	return { _mapped + base + offset, base + offset };
+}
+
+bool Phusis::Internal::VkUploadRing::Flush() noexcept
+{
+	VkDeviceSize used = Used();
+	if (_coherent || !used)
+		return true;
+
+	// regions are whole atoms, so rounding up never leaves the region
+	VkMappedMemoryRange range{};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = _memory;
+	range.offset = RegionOffset(_flight);
+	range.size = AlignUp(used, _atom);
+
+	if (vkFlushMappedMemoryRanges(_device, 1, &range) != VK_SUCCESS)
+	{
+		sys::log.head(sys::FAIL) << "could not flush upload ring; render result may be wrong" << sys::EOM;
+		return false;
+	}
+
+	return true;
+}
+
+VkBuffer Phusis::Internal::VkUploadRing::Buffer() const noexcept
+{
+	return _buffer;
+}
+
+VkDeviceSize Phusis::Internal::VkUploadRing::RegionOffset(uint32_t flight) const noexcept
+{
+	return _region * flight;
+}
+
+VkDeviceSize Phusis::Internal::VkUploadRing::RegionSize() const noexcept
+{
+	return _region;
+}
+
+VkDeviceSize Phusis::Internal::VkUploadRing::Used() const noexcept
+{
+	return _head.load(std::memory_order_relaxed);
+}
@@ -1,50 +1,199 @@
-
-#include "fw.hxx"
+#include "phusis/managed.hxx"
+#include "sys/logger.hxx"
 #include <cstring>
-#include <cxxabi.h>
 
-/// @brief Get mangled name of unmanaged function (for managed assemblies)
-/// @param ns name of namespace
-/// @param cls name of class
-/// @param fn name of function
-/// @param dst destination memory of mangled function name
-extern "C" DLLEXPORT bool __getfn(
-		const char* __restrict ns,
-		const char* __restrict cls,
-		const char* __restrict fn,
-		char* __restrict dst,
-		int32_t n);
+static Phusis::Application* ManagedCreate(int32_t mode, uint32_t validation)
+{
+	if (mode < static_cast<int32_t>(Phusis::ApplicationMode::Performant) || mode > static_cast<int32_t>(Phusis::ApplicationMode::Quality))
+	{
+		sys::log.head(sys::FAIL) << "unknown application mode " << mode << sys::EOM;
+		return nullptr;
+	}
+
+	std::vector<std::string> layers;
+	if (validation)
+		layers.emplace_back("VK_LAYER_KHRONOS_validation");
+
+	return new(std::nothrow) Phusis::Application(layers, {}, static_cast<Phusis::ApplicationMode>(mode));
+}
+
+static void ManagedDestroy(Phusis::Application* app)
+{
+	delete app;
+}
+
+static int32_t ManagedInitialize(Phusis::Application* app)
+{
+	return app->InitializeComponents();
+}
 
-bool __getfn(const char* ns, const char* cls, const char* fn, char* dst, int32_t n)
+static int32_t ManagedRun(Phusis::Application* app)
 {
-	size_t l = (ns ? strlen(ns) + 1 : 0) +
-			   (cls ? strlen(cls) + 1 : 0) +
-			   strlen(fn);
+	return app->Run();
+}
 
-	char* src = static_cast<char*>(calloc(l, sizeof(char)));
-	char* buf = static_cast<char*>(calloc(512, sizeof(char)));
+static uint32_t ManagedObjectCount(const Phusis::Application* app)
+{
+	return app->ObjectCount();
+}
+
+static Phusis::EngineObjectTransform* ManagedTransforms(Phusis::Application* app)
+{
+	return app->Transforms();
+}
 
-	int status;
+// shared shape of the batched setters: n updates through the scene channel, applied by the render thread
+// at its next frame, so they never race a frame in flight
+template<typename F>
+static void Stream(Phusis::Application* app, const uint32_t* indices, uint32_t n, F&& fill)
+{
+	Phusis::SceneChannel& channel = app->Channel();
 
-	if (ns)
+	uint32_t sent = 0;
+	while (sent < n)
 	{
-		strcat(src, ns);
-		strcat(src, "::");
+		uint32_t granted;
+		Phusis::SceneUpdate* updates = channel.Acquire(n - sent, granted);
+		if (!granted)
+		{
+			// only a frame frees slots; before Run nothing would
+			if (!app->Running())
+			{
+				sys::log.head(sys::WARN) << "scene channel full before run; " << n - sent
+										 << " managed updates dropped" << sys::EOM;
+				return;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+
+		for (uint32_t i = 0; i < granted; ++i, ++sent)
+		{
+			updates[i] = {};
+			updates[i].Index = indices ? indices[sent] : sent;
+			fill(updates[i], sent);
+		}
+		channel.Publish(granted);
 	}
-	if (cls)
+}
+
+static void ManagedSetTransforms(
+		Phusis::Application* app,
+		const uint32_t* indices,
+		const Phusis::EngineObjectTransform* src,
+		uint32_t n)
+{
+	Stream(app, indices, n, [src](Phusis::SceneUpdate& update, uint32_t i)
+	{
+		update.Fields = Phusis::SceneUpdateRotation | Phusis::SceneUpdateColor | Phusis::SceneUpdateEnabled;
+		update.Rotation = src[i].Rotation;
+		update.Color = src[i].Color;
+		update.Enabled = src[i].Enabled;
+	});
+}
+
+static void ManagedSetRotations(Phusis::Application* app, const uint32_t* indices, const glm::mat4* src, uint32_t n)
+{
+	Stream(app, indices, n, [src](Phusis::SceneUpdate& update, uint32_t i)
+	{
+		update.Fields = Phusis::SceneUpdateRotation;
+		update.Rotation = src[i];
+	});
+}
+
+static void ManagedSetEnabled(Phusis::Application* app, const uint32_t* indices, const uint32_t* src, uint32_t n)
+{
+	Stream(app, indices, n, [src](Phusis::SceneUpdate& update, uint32_t i)
+	{
+		update.Fields = Phusis::SceneUpdateEnabled;
+		update.Enabled = src[i];
+	});
+}
+
+static Phusis::SceneUpdate* ManagedAcquireUpdates(Phusis::Application* app, uint32_t n, uint32_t* granted)
+{
+	return app->Channel().Acquire(n, *granted);
+}
+
+static void ManagedPublishUpdates(Phusis::Application* app, uint32_t n)
+{
+	app->Channel().Publish(n);
+}
+
+static void ManagedSetParents(Phusis::Application* app, const uint32_t* indices, const uint32_t* src, uint32_t n)
+{
+	Stream(app, indices, n, [src](Phusis::SceneUpdate& update, uint32_t i)
+	{
+		update.Fields = Phusis::SceneUpdateParent;
+		update.Parent = src[i];
+	});
+}
+
+static void ManagedInvalidate(Phusis::Application* app, const uint32_t* indices, uint32_t n)
+{
+	Stream(app, indices, n, [](Phusis::SceneUpdate& update, uint32_t)
+	{
+		update.Fields = Phusis::SceneUpdateInvalidate;
+	});
+}
+
+static void ManagedExportMetrics(Phusis::Application* app, const char* path, double seconds)
+{
+	app->Metrics().ExportTo(path ? path : "", seconds);
+}
+
+static void ManagedCapture(Phusis::Application* app, const char* path, uint32_t frames)
+{
+	app->Capture(path ? path : "", frames);
+}
+
+static void ManagedSetCamera(Phusis::Application* app, const glm::mat4* view, const glm::mat4* projection)
+{
+	app->SetCamera(*view, *projection);
+}
+
+static uint32_t ManagedLoadMeshes(Phusis::Application* app, const char* path)
+{
+	return path ? app->LoadMeshes(path) : UINT32_MAX;
+}
+
+static uint32_t ManagedMeshCount(const Phusis::Application* app)
+{
+	return app->MeshCount();
+}
+
+static uint32_t ManagedCreateObject(Phusis::Application* app, uint32_t mesh, uint32_t material)
+{
+	if (mesh >= app->MeshCount())
 	{
-		strcat(src, cls);
-		strcat(src, "::");
+		sys::log.head(sys::WARN) << "mesh " << mesh << " not loaded" << sys::EOM;
+		return UINT32_MAX;
 	}
-	strcat(src, fn);
 
-	buf = abi::__cxa_demangle(src, buf, nullptr, &status);
-	if (static_cast<int32_t>(strlen(buf)) > n)
-		return false;
+	return app->CreateObject(app->LoadedMesh(mesh), nullptr, material);
+}
 
-	strcpy(dst, buf);
+static uint32_t ManagedDestroyObject(Phusis::Application* app, uint32_t idx)
+{
+	return app->DestroyObject(idx);
+}
 
-	free(buf);
+const Phusis::ManagedApi* phusis_get_api(uint32_t version)
+{
+#define PHUSIS_API_POINTER(name, ret, ...) &Managed##name,
+	static const Phusis::ManagedApi api = {
+			PHUSIS_API_VERSION,
+			sizeof(Phusis::ManagedApi),
+			PHUSIS_API_FUNCTIONS(PHUSIS_API_POINTER)
+	};
+#undef PHUSIS_API_POINTER
+
+	if (version != PHUSIS_API_VERSION)
+	{
+		sys::log.head(sys::CRIT) << "managed api version " << version << " requested, native serves "
+								 << PHUSIS_API_VERSION << sys::EOM;
+		return nullptr;
+	}
 
-	return true;
+	return &api;
 }
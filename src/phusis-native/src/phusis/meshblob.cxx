@@ -0,0 +1,183 @@
+#include "phusis/meshblob.hxx"
+#include "phusis/vertexformat.hxx"
+#include "sys/logger.hxx"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static bool contains(const Phusis::MeshBlobRegion& region, uint64_t size) noexcept
+{
+	return region.Offset <= size && region.Size <= size - region.Offset;
+}
+
+Phusis::MeshBlob::~MeshBlob() noexcept
+{
+	Close();
+}
+
+bool Phusis::MeshBlob::Open(const std::filesystem::path& path) noexcept
+{
+	Close();
+
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		sys::log.head(sys::FAIL) << "could not open mesh blob " << path.string() << sys::EOM;
+		return false;
+	}
+
+	struct stat info{};
+	if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(MeshBlobHeader))
+	{
+		sys::log.head(sys::FAIL) << "mesh blob " << path.string() << " is truncated" << sys::EOM;
+		close(fd);
+		return false;
+	}
+
+	size_t size = info.st_size;
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		sys::log.head(sys::FAIL) << "could not map mesh blob " << path.string() << sys::EOM;
+		return false;
+	}
+
+	_mapping = static_cast<const uint8_t*>(mapping);
+	_size = size;
+	_header = reinterpret_cast<const MeshBlobHeader*>(_mapping);
+
+	// everything below only reads the mapping; a failed check leaves nothing half-loaded
+	const char* error = nullptr;
+	if (_header->Magic != MeshBlobMagic)
+		error = "is not a mesh blob";
+	else if (_header->Version != MeshBlobVersion)
+		error = "has an unsupported version";
+	else if (_header->DataOffset % MeshBlobPage || _header->DataOffset > size || _header->DataSize > size - _header->DataOffset)
+		error = "has a bad data section";
+	else if (sizeof(MeshBlobHeader) + static_cast<uint64_t>(_header->MeshCount) * sizeof(MeshBlobEntry) > _header->DataOffset)
+		error = "has a bad directory";
+
+	_entries = reinterpret_cast<const MeshBlobEntry*>(_mapping + sizeof(MeshBlobHeader));
+	for (uint32_t i = 0; !error && i < _header->MeshCount; ++i)
+	{
+		const MeshBlobEntry& entry = _entries[i];
+		if (entry.StreamCount > MeshBlobMaxStreams || entry.LodCount > MeshBlobMaxLods)
+			error = "has a bad mesh entry";
+
+		for (uint32_t j = 0; !error && j < entry.StreamCount; ++j)
+			if (!contains(entry.Streams[j].Region, _header->DataSize))
+				error = "has a stream out of bounds";
+
+		for (uint32_t j = 0; !error && j < entry.LodCount; ++j)
+			if (!contains(entry.Lods[j].Indices, _header->DataSize) || !contains(entry.Lods[j].Meshlets, _header->DataSize) ||
+				entry.Lods[j].MeshletCount * sizeof(Meshlet) > entry.Lods[j].Meshlets.Size)
+				error = "has a level out of bounds";
+	}
+
+	if (error)
+	{
+		sys::log.head(sys::FAIL) << "mesh blob " << path.string() << " " << error << sys::EOM;
+		Close();
+		return false;
+	}
+
+	// the data section is about to be streamed to the GPU front to back
+	madvise(const_cast<uint8_t*>(_mapping) + _header->DataOffset, _header->DataSize, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+	sys::log.head(sys::INFO) << "mesh blob " << path.string() << " mapped: " << _header->MeshCount << " meshes" << sys::EOM;
+
+	return true;
+}
+
+void Phusis::MeshBlob::Close() noexcept
+{
+	if (_mapping)
+		munmap(const_cast<uint8_t*>(_mapping), _size);
+
+	_mapping = nullptr;
+	_size = 0;
+	_header = nullptr;
+	_entries = nullptr;
+}
+
+uint32_t Phusis::MeshBlob::Count() const noexcept
+{
+	return _header ? _header->MeshCount : 0;
+}
+
+const Phusis::MeshBlobEntry& Phusis::MeshBlob::Entry(uint32_t idx) const noexcept
+{
+	return _entries[idx];
+}
+
+const void* Phusis::MeshBlob::Data() const noexcept
+{
+	return _header ? _mapping + _header->DataOffset : nullptr;
+}
+
+size_t Phusis::MeshBlob::DataSize() const noexcept
+{
+	return _header ? _header->DataSize : 0;
+}
+
+const Phusis::Meshlet* Phusis::MeshBlob::Meshlets(uint32_t idx, uint32_t lod) const noexcept
+{
+	const MeshBlobLod& level = _entries[idx].Lods[lod];
+	return reinterpret_cast<const Meshlet*>(_mapping + _header->DataOffset + level.Meshlets.Offset);
+}
+
+std::vector<Phusis::Mesh> Phusis::MeshBlob::Meshes(VkBuffer buffer, VkDeviceSize base, VkDeviceAddress address) const
+{
+	std::vector<Mesh> meshes;
+	meshes.reserve(Count());
+
+	for (uint32_t i = 0; i < Count(); ++i)
+	{
+		const MeshBlobEntry& entry = _entries[i];
+
+		std::vector<Buffer> vertices;
+		const MeshBlobStream* positions = nullptr;
+		vertices.reserve(entry.StreamCount);
+		for (uint32_t j = 0; j < entry.StreamCount; ++j)
+		{
+			const MeshBlobStream& stream = entry.Streams[j];
+			vertices.emplace_back(buffer, stream.Count, static_cast<VkFormat>(stream.Format), stream.Stride, base + stream.Region.Offset);
+			if (stream.Attribute == static_cast<uint32_t>(VertexAttribute::Position))
+				positions = &stream;
+		}
+
+		std::vector<Buffer> indices;
+		std::vector<float> errors;
+		std::vector<MeshletLevel> clusters;
+		indices.reserve(entry.LodCount);
+		errors.reserve(entry.LodCount);
+		clusters.reserve(entry.LodCount);
+		for (uint32_t j = 0; j < entry.LodCount; ++j)
+		{
+			const MeshBlobLod& lod = entry.Lods[j];
+			indices.emplace_back(buffer, lod.Count, VK_FORMAT_UNDEFINED, 0, base + lod.Indices.Offset);
+			errors.push_back(lod.Error);
+
+			// offsets are relative to the data section, which stays far below 4GB
+			MeshletLevel level{ Meshlets(i, j), lod.MeshletCount, 0, 0, 0, 0 };
+			if (address && positions && lod.Meshlets.Offset <= UINT32_MAX && lod.Indices.Offset <= UINT32_MAX &&
+				positions->Region.Offset <= UINT32_MAX)
+			{
+				level.Address = address + base;
+				level.Records = static_cast<uint32_t>(lod.Meshlets.Offset);
+				level.Indices = static_cast<uint32_t>(lod.Indices.Offset);
+				level.Positions = static_cast<uint32_t>(positions->Region.Offset);
+			}
+			clusters.push_back(level);
+		}
+
+		glm::mat4 dequantization;
+		std::memcpy(&dequantization, entry.Dequantization, sizeof entry.Dequantization);
+
+		meshes.emplace_back(std::move(vertices), std::move(indices), dequantization, std::move(errors), std::move(clusters));
+	}
+
+	return meshes;
+}
@@ -0,0 +1,119 @@
+#include <fstream>
+#include "phusis/metrics.hxx"
+#include "sys/logger.hxx"
+
+// exported for every metric; p50 for the typical frame, the rest for hitches
+constexpr std::array<double, 3> Quantiles{ .5, .99, .999 };
+
+Phusis::Metric::Metric(std::string name, std::string help, double scale) noexcept:
+		_name(std::move(name)),
+		_help(std::move(help)),
+		_scale(scale)
+{
+}
+
+void Phusis::Metric::Record(uint64_t value) noexcept
+{
+	_windows[_window.load(std::memory_order_relaxed)].record(value);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+const std::string& Phusis::Metric::Name() const noexcept
+{
+	return _name;
+}
+
+Phusis::Metric& Phusis::MetricsRegistry::Register(const std::string& name, const std::string& help, double scale)
+{
+	std::lock_guard guard(_lock);
+
+	for (const auto& metric: _metrics)
+		if (metric->_name == name)
+			return *metric;
+
+	_metrics.push_back(std::make_unique<Metric>(name, help, scale));
+	return *_metrics.back();
+}
+
+void Phusis::MetricsRegistry::ExportTo(const std::filesystem::path& path, double seconds)
+{
+	std::lock_guard guard(_lock);
+
+	_path = path;
+	_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(seconds, 0.)));
+	_next = std::chrono::steady_clock::now();
+	_failed = false;
+}
+
+bool Phusis::MetricsRegistry::Export() noexcept
+{
+	std::filesystem::path path;
+	{
+		std::lock_guard guard(_lock);
+
+		auto now = std::chrono::steady_clock::now();
+		if (_path.empty() || _interval == std::chrono::steady_clock::duration::zero() || now < _next)
+			return true;
+
+		_next = now + _interval;
+		path = _path;
+	}
+
+	// the rename is atomic only within one file system, so the temporary sits next to the target
+	std::filesystem::path temporary = path;
+	temporary += ".tmp";
+
+	std::error_code error;
+	{
+		std::ofstream out(temporary, std::ios::trunc);
+		if (out)
+			Write(out);
+		if (!out)
+			error = std::make_error_code(std::errc::io_error);
+	}
+	if (!error)
+		std::filesystem::rename(temporary, path, error);
+
+	// a failing path fails every interval; say so once
+	std::lock_guard guard(_lock);
+	if (error && !_failed)
+		sys::log.head(sys::WARN) << "could not write metrics to " << path.string() << ": " << error.message() << sys::EOM;
+	else if (!error && _failed)
+		sys::log.head(sys::INFO) << "metrics written to " << path.string() << " again" << sys::EOM;
+	_failed = static_cast<bool>(error);
+
+	return !error;
+}
+
+void Phusis::MetricsRegistry::Write(std::ostream& out)
+{
+	std::lock_guard guard(_lock);
+
+	for (const auto& metric: _metrics)
+	{
+		// recorders move to the other window; the few values already in flight land in the old one
+		// and are cleared with it
+		uint32_t window = metric->_window.load(std::memory_order_relaxed);
+		metric->_window.store(window ^ 1, std::memory_order_relaxed);
+		sys::histogram& histogram = metric->_windows[window];
+
+		const std::string& name = metric->_name;
+		out << "# HELP " << name << ' ' << metric->_help << '\n';
+		out << "# TYPE " << name << " summary\n";
+
+		for (double q: Quantiles)
+		{
+			out << name << "{quantile=\"" << q << "\"} ";
+			if (histogram.count())
+				out << histogram.quantile(q) * metric->_scale << '\n';
+			else
+				out << "NaN\n";
+		}
+
+		out << name << "_sum " << metric->_sum.load(std::memory_order_relaxed) * metric->_scale << '\n';
+		out << name << "_count " << metric->_count.load(std::memory_order_relaxed) << '\n';
+
+		histogram.clear();
+	}
+}
@@ -0,0 +1,55 @@
+#include "phusis/scenechannel.hxx"
+#include "sys/logger.hxx"
+
+Phusis::SceneChannel::SceneChannel(uint32_t capacityLog2) noexcept
+		: _ring(capacityLog2)
+{
+}
+
+Phusis::SceneUpdate* Phusis::SceneChannel::Acquire(uint32_t n, uint32_t& granted) noexcept
+{
+	return _ring.acquire(n, granted);
+}
+
+void Phusis::SceneChannel::Publish(uint32_t n) noexcept
+{
+	_ring.publish(n);
+}
+
+uint32_t Phusis::SceneChannel::Consume(std::vector<EngineObjectTransform>& transforms, TransformHierarchy* hierarchy) noexcept
+{
+	uint32_t invalid = 0;
+	uint64_t drained = _ring.drain([&transforms, hierarchy, &invalid](const SceneUpdate& update)
+	{
+		if (update.Index >= transforms.size())
+		{
+			invalid++;
+			return;
+		}
+
+		EngineObjectTransform& dst = transforms[update.Index];
+		if (update.Fields & SceneUpdateRotation)
+			dst.Rotation = update.Rotation;
+		if (update.Fields & SceneUpdateColor)
+			dst.Color = update.Color;
+		if (update.Fields & SceneUpdateEnabled)
+			dst.Enabled = update.Enabled;
+
+		if (!hierarchy)
+			return;
+		if (update.Fields & SceneUpdateParent)
+			hierarchy->SetParent(update.Index, update.Parent);
+		if (update.Fields & (SceneUpdateRotation | SceneUpdateInvalidate))
+			hierarchy->Invalidate(update.Index);
+	});
+
+	if (invalid)
+		sys::log.head(sys::WARN) << invalid << " scene updates addressed missing objects" << sys::EOM;
+
+	return static_cast<uint32_t>(drained) - invalid;
+}
+
+uint32_t Phusis::SceneChannel::Capacity() const noexcept
+{
+	return static_cast<uint32_t>(_ring.capacity());
+}
@@ -0,0 +1,232 @@
+#include "phusis/transformhierarchy.hxx"
+#include "sys/logger.hxx"
+#include "pre/glm.hxx"
+
+// levels smaller than this are not worth waking the workers for
+constexpr uint32_t ParallelLevel = 4096;
+
+void Phusis::TransformHierarchy::Sort()
+{
+	uint32_t n = _parents.size();
+
+	// depth of every node, walking each unresolved chain once
+	_depths.assign(n, NoParent);
+	std::vector<uint32_t> chain;
+	uint32_t levels = 0;
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		chain.clear();
+		uint32_t j = i;
+		while (j != NoParent && _depths[j] == NoParent)
+		{
+			chain.push_back(j);
+			j = _parents[j];
+		}
+
+		uint32_t depth = j == NoParent ? 0 : _depths[j] + 1;
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+			_depths[*it] = depth++;
+		levels = std::max(levels, depth);
+	}
+
+	// counting sort by depth; stable, so siblings keep their object order
+	_levels.assign(levels + 1, 0);
+	for (uint32_t i = 0; i < n; ++i)
+		_levels[_depths[i] + 1]++;
+	for (uint32_t k = 1; k < _levels.size(); ++k)
+		_levels[k] += _levels[k - 1];
+
+	_order.resize(n);
+	_orderParents.resize(n);
+	std::vector<uint32_t> cursor(_levels.begin(), _levels.end() - 1);
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		uint32_t pos = cursor[_depths[i]]++;
+		_order[pos] = i;
+		_orderParents[pos] = _parents[i];
+	}
+
+	_dirty.assign(n, 1);
+	_marked.assign(levels, 1);
+	_stale = false;
+}
+
+uint32_t Phusis::TransformHierarchy::UpdateRange(const EngineObjectTransform* locals, uint32_t begin, uint32_t end) noexcept
+{
+	uint32_t updated = 0;
+	for (uint32_t pos = begin; pos < end; ++pos)
+	{
+		uint32_t idx = _order[pos];
+		uint32_t parent = _orderParents[pos];
+
+		// the parent's flag was settled by the level above
+		bool inherited = parent != NoParent && _dirty[parent];
+		if (!_dirty[idx] && !inherited)
+			continue;
+
+		_dirty[idx] = 1;
+		// the product runs on aligned pre copies; glm storage only promises 4 bytes
+		pre::mat4f local = pre::from_glm(locals[idx].Rotation);
+		_worlds[idx] = pre::to_glm(parent == NoParent ? local : pre::from_glm(_worlds[parent]) * local);
+		updated++;
+	}
+	return updated;
+}
+
+void Phusis::TransformHierarchy::Resize(uint32_t n)
+{
+	if (n == _parents.size())
+		return;
+
+	// links into the removed tail are dropped
+	for (uint32_t i = 0; i < std::min<uint32_t>(n, _parents.size()); ++i)
+		if (_parents[i] != NoParent && _parents[i] >= n)
+			_parents[i] = NoParent;
+
+	_parents.resize(n, NoParent);
+	_worlds.resize(n, glm::mat4(1.f));
+	_stale = true;
+}
+
+void Phusis::TransformHierarchy::Erase(uint32_t idx) noexcept
+{
+	// objects past the tracked count are picked up by the next Resize
+	if (idx >= _parents.size())
+		return;
+
+	_parents.erase(_parents.begin() + idx);
+	_worlds.erase(_worlds.begin() + idx);
+	for (uint32_t& parent: _parents)
+	{
+		if (parent == idx)
+			parent = NoParent;
+		else if (parent != NoParent && parent > idx)
+			parent--;
+	}
+	_stale = true;
+}
+
+bool Phusis::TransformHierarchy::SetParent(uint32_t child, uint32_t parent) noexcept
+{
+	uint32_t n = _parents.size();
+	if (child >= n || (parent != NoParent && parent >= n))
+	{
+		sys::log.head(sys::WARN) << "parent link " << child << " -> " << parent << " out of range" << sys::EOM;
+		return false;
+	}
+
+	if (_parents[child] == parent)
+		return true;
+
+	for (uint32_t p = parent; p != NoParent; p = _parents[p])
+	{
+		if (p == child)
+		{
+			sys::log.head(sys::WARN) << "parent link " << child << " -> " << parent << " would form a cycle" << sys::EOM;
+			return false;
+		}
+	}
+
+	_parents[child] = parent;
+	_stale = true;
+	return true;
+}
+
+void Phusis::TransformHierarchy::Invalidate(uint32_t idx) noexcept
+{
+	// a stale hierarchy recomputes everything anyway
+	if (_stale || idx >= _dirty.size() || _dirty[idx])
+		return;
+
+	_dirty[idx] = 1;
+	_marked[_depths[idx]]++;
+}
+
+void Phusis::TransformHierarchy::InvalidateAll() noexcept
+{
+	_stale = true;
+}
+
+void Phusis::TransformHierarchy::Update(const std::vector<EngineObjectTransform>& locals, sys::workers& workers)
+{
+	Resize(locals.size());
+	if (_stale)
+		Sort();
+
+	_updated = 0;
+
+	// flags of a level are cleared once the level below has read them
+	auto clear = [this](uint32_t k) {
+		for (uint32_t pos = _levels[k]; pos < _levels[k + 1]; ++pos)
+			_dirty[_order[pos]] = 0;
+	};
+
+	// a level is visited when it has marked nodes or the level above changed
+	bool above = false;
+	for (uint32_t k = 0; k < Depth(); ++k)
+	{
+		uint32_t begin = _levels[k];
+		uint32_t end = _levels[k + 1];
+
+		if (!_marked[k] && !above)
+			continue;
+
+		uint32_t updated = 0;
+		if (end - begin < ParallelLevel || workers.size() <= 1)
+		{
+			updated = UpdateRange(locals.data(), begin, end);
+		}
+		else
+		{
+			std::atomic<uint32_t> total = 0;
+			workers.run([this, &locals, &total, &workers, begin, end](uint32_t i)
+			{
+				uint32_t size = end - begin;
+				uint32_t local = size / workers.size();
+				uint32_t remain = size % workers.size();
+				uint32_t offset = begin + local * i + std::min(i, remain);
+				if (i < remain)
+					local++;
+
+				total += UpdateRange(locals.data(), offset, offset + local);
+			});
+			updated = total;
+		}
+
+		// nothing above changed means nothing here inherited a flag, so the level above is clean already
+		if (above)
+			clear(k - 1);
+
+		_marked[k] = 0;
+		_updated += updated;
+		above = updated != 0;
+	}
+
+	if (above)
+		clear(Depth() - 1);
+}
+
+uint32_t Phusis::TransformHierarchy::Parent(uint32_t idx) const noexcept
+{
+	return idx < _parents.size() ? _parents[idx] : NoParent;
+}
+
+const glm::mat4* Phusis::TransformHierarchy::Worlds() const noexcept
+{
+	return _worlds.data();
+}
+
+uint32_t Phusis::TransformHierarchy::Count() const noexcept
+{
+	return _parents.size();
+}
+
+uint32_t Phusis::TransformHierarchy::Depth() const noexcept
+{
+	return _levels.empty() ? 0 : _levels.size() - 1;
+}
+
+uint32_t Phusis::TransformHierarchy::Updated() const noexcept
+{
+	return _updated;
+}
@@ -0,0 +1,51 @@
+#include "phusis/vertexformat.hxx"
+
+static std::vector<Phusis::VertexStreamFormat> streams(const Phusis::Mesh& mesh) noexcept
+{
+	std::vector<Phusis::VertexStreamFormat> result(mesh.Vertices.size());
+	for (size_t i = 0; i < result.size(); ++i)
+		result[i] = { mesh.Vertices[i].Format, mesh.Vertices[i].Stride };
+	return result;
+}
+
+glm::mat4 Phusis::DequantizationMatrix(const pre::vec3f& min, const pre::vec3f& max) noexcept
+{
+	glm::mat4 result(1.f);
+	result[0][0] = max.x - min.x;
+	result[1][1] = max.y - min.y;
+	result[2][2] = max.z - min.z;
+	result[3] = glm::vec4(min.x, min.y, min.z, 1.f);
+	return result;
+}
+
+Phusis::VertexInputDescription::VertexInputDescription(const Mesh& mesh) noexcept
+		: VertexInputDescription(streams(mesh))
+{
+}
+
+Phusis::VertexInputDescription::VertexInputDescription(const std::vector<VertexStreamFormat>& streams) noexcept
+		: _bindings(streams.size()), _attributes(streams.size()), _info()
+{
+	for (uint32_t i = 0; i < streams.size(); ++i)
+	{
+		_bindings[i].binding = i;
+		_bindings[i].stride = streams[i].Stride;
+		_bindings[i].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		_attributes[i].location = i;
+		_attributes[i].binding = i;
+		_attributes[i].format = streams[i].Format;
+		_attributes[i].offset = 0;
+	}
+
+	_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	_info.vertexBindingDescriptionCount = _bindings.size();
+	_info.pVertexBindingDescriptions = _bindings.data();
+	_info.vertexAttributeDescriptionCount = _attributes.size();
+	_info.pVertexAttributeDescriptions = _attributes.data();
+}
+
+const VkPipelineVertexInputStateCreateInfo& Phusis::VertexInputDescription::Info() const noexcept
+{
+	return _info;
+}
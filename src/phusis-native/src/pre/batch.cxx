@@ -0,0 +1,89 @@
+#include "pre/batch.hxx"
+
+#if PRE_DISPATCH
+#include <immintrin.h>
+
+// two vectors per iteration; in-lane permutes broadcast each vector's components
+PRE_TARGET("avx")
+static size_t transform_avx(const pre::mat4f& lhs, const pre::vec4f* src, pre::vec4f* dst, size_t n) noexcept
+{
+	__m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs.cols[0].x));
+	__m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs.cols[1].x));
+	__m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs.cols[2].x));
+	__m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs.cols[3].x));
+
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2)
+	{
+		__m256 v = _mm256_loadu_ps(&src[i].x);
+		__m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm256_add_ps(r, _mm256_mul_ps(c3, _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm256_storeu_ps(&dst[i].x, r);
+	}
+	return i;
+}
+#endif
+
+void pre::transform(const mat4f& lhs, span<const mat4f> src, span<mat4f> dst) noexcept
+{
+	size_t n = std::min(src.size(), dst.size());
+	for (size_t i = 0; i < n; ++i)
+		dst[i] = pre::simd::mul(lhs, src[i]);
+}
+
+void pre::transform(const mat4f& lhs, span<const vec4f> src, span<vec4f> dst) noexcept
+{
+	size_t n = std::min(src.size(), dst.size());
+	size_t i = 0;
+
+#if PRE_DISPATCH
+	static const bool avx = PRE_SUPPORTS("avx");
+	if (avx)
+		i = transform_avx(lhs, src.data(), dst.data(), n);
+#endif
+
+#if PRE_SSE
+	// keep lhs in registers across the whole batch
+	__m128 c0 = _mm_load_ps(&lhs.cols[0].x);
+	__m128 c1 = _mm_load_ps(&lhs.cols[1].x);
+	__m128 c2 = _mm_load_ps(&lhs.cols[2].x);
+	__m128 c3 = _mm_load_ps(&lhs.cols[3].x);
+
+	for (; i < n; ++i)
+	{
+		__m128 v = _mm_load_ps(&src[i].x);
+		__m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_store_ps(&dst[i].x, r);
+	}
+#elif PRE_NEON
+	float32x4_t c0 = vld1q_f32(&lhs.cols[0].x);
+	float32x4_t c1 = vld1q_f32(&lhs.cols[1].x);
+	float32x4_t c2 = vld1q_f32(&lhs.cols[2].x);
+	float32x4_t c3 = vld1q_f32(&lhs.cols[3].x);
+
+	for (; i < n; ++i)
+	{
+		float32x4_t v = vld1q_f32(&src[i].x);
+		float32x4_t r = vmulq_n_f32(c0, vgetq_lane_f32(v, 0));
+		r = vmlaq_n_f32(r, c1, vgetq_lane_f32(v, 1));
+		r = vmlaq_n_f32(r, c2, vgetq_lane_f32(v, 2));
+		r = vmlaq_n_f32(r, c3, vgetq_lane_f32(v, 3));
+		vst1q_f32(&dst[i].x, r);
+	}
+#else
+	for (; i < n; ++i)
+		dst[i] = pre::simd::mul(lhs, src[i]);
+#endif
+}
+
+void pre::transform(span<const mat4f> lhs, span<const mat4f> rhs, span<mat4f> dst) noexcept
+{
+	size_t n = std::min({ lhs.size(), rhs.size(), dst.size() });
+	for (size_t i = 0; i < n; ++i)
+		dst[i] = pre::simd::mul(lhs[i], rhs[i]);
+}
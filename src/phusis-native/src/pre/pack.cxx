@@ -0,0 +1,221 @@
+#include "pre/pack.hxx"
+#include "pre/simd.hxx"
+#include <cstring>
+
+#if PRE_SSE
+#include <emmintrin.h>
+#endif
+#if defined(__F16C__) || PRE_DISPATCH
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(pre::vec2f) == 2 * sizeof(float));
+static_assert(sizeof(pre::vec3f) == 3 * sizeof(float));
+
+void pre::bounds(span<const vec3f> src, vec3f& min, vec3f& max) noexcept
+{
+	if (src.size() == 0)
+	{
+		min = max = vec3f(0);
+		return;
+	}
+
+	min = max = src[0];
+	for (const vec3f& v : src)
+	{
+		min = vec3f(std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z));
+		max = vec3f(std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z));
+	}
+}
+
+void pre::pack_unorm16(span<const vec3f> src, const vec3f& min, const vec3f& max, span<uint16_t> dst) noexcept
+{
+	size_t n = std::min(src.size(), dst.size() / 4);
+
+	// flat axes collapse to 0; dequantization scales them back by 0 anyway
+	vec3f extent = max - min;
+	vec3f scale(
+			extent.x > 0 ? 65535.f / extent.x : 0,
+			extent.y > 0 ? 65535.f / extent.y : 0,
+			extent.z > 0 ? 65535.f / extent.z : 0);
+
+#if PRE_SSE
+	__m128 lo = _mm_set_ps(0, min.z, min.y, min.x);
+	__m128 mul = _mm_set_ps(0, scale.z, scale.y, scale.x);
+	__m128 zero = _mm_setzero_ps();
+	__m128 top = _mm_set1_ps(65535.f);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		__m128 v = _mm_set_ps(0, src[i].z, src[i].y, src[i].x);
+		v = _mm_mul_ps(_mm_sub_ps(v, lo), mul);
+		v = _mm_min_ps(_mm_max_ps(v, zero), top);
+
+		alignas(16) int32_t q[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(q), _mm_cvtps_epi32(v));
+		for (size_t c = 0; c < 4; ++c)
+			dst[i * 4 + c] = static_cast<uint16_t>(q[c]);
+	}
+#else
+	for (size_t i = 0; i < n; ++i)
+	{
+		vec3f v = (src[i] - min) * scale;
+		for (size_t c = 0; c < 3; ++c)
+			dst[i * 4 + c] = static_cast<uint16_t>(std::lround(std::clamp(v[c], 0.f, 65535.f)));
+		dst[i * 4 + 3] = 0;
+	}
+#endif
+}
+
+static void octahedral(const pre::vec3f& n, int16_t* out) noexcept
+{
+	float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+	float inv = l1 > 0 ? 1.f / l1 : 0;
+	float x = n.x * inv;
+	float y = n.y * inv;
+
+	// fold the lower hemisphere over the diagonals
+	if (n.z < 0)
+	{
+		float fx = (1 - std::abs(y)) * std::copysign(1.f, x);
+		float fy = (1 - std::abs(x)) * std::copysign(1.f, y);
+		x = fx;
+		y = fy;
+	}
+
+	out[0] = static_cast<int16_t>(std::lround(std::clamp(x, -1.f, 1.f) * 32767.f));
+	out[1] = static_cast<int16_t>(std::lround(std::clamp(y, -1.f, 1.f) * 32767.f));
+}
+
+void pre::pack_octahedral(span<const vec3f> src, span<int16_t> dst) noexcept
+{
+	size_t n = std::min(src.size(), dst.size() / 2);
+	size_t i = 0;
+
+#if PRE_SSE
+	// four normals per iteration, transposed to one register per axis
+	const __m128 sign = _mm_set1_ps(-0.f);
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 unit = _mm_set1_ps(32767.f);
+
+	for (; i + 4 <= n; i += 4)
+	{
+		const vec3f* p = &src[i];
+		__m128 x = _mm_set_ps(p[3].x, p[2].x, p[1].x, p[0].x);
+		__m128 y = _mm_set_ps(p[3].y, p[2].y, p[1].y, p[0].y);
+		__m128 z = _mm_set_ps(p[3].z, p[2].z, p[1].z, p[0].z);
+
+		__m128 ax = _mm_andnot_ps(sign, x);
+		__m128 ay = _mm_andnot_ps(sign, y);
+		__m128 az = _mm_andnot_ps(sign, z);
+		__m128 l1 = _mm_add_ps(_mm_add_ps(ax, ay), az);
+		__m128 inv = _mm_and_ps(_mm_cmpgt_ps(l1, zero), _mm_div_ps(one, l1));
+
+		x = _mm_mul_ps(x, inv);
+		y = _mm_mul_ps(y, inv);
+		ax = _mm_andnot_ps(sign, x);
+		ay = _mm_andnot_ps(sign, y);
+
+		__m128 fx = _mm_or_ps(_mm_sub_ps(one, ay), _mm_and_ps(sign, x));
+		__m128 fy = _mm_or_ps(_mm_sub_ps(one, ax), _mm_and_ps(sign, y));
+		__m128 lower = _mm_cmplt_ps(z, zero);
+		x = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, x));
+		y = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, y));
+
+		x = _mm_min_ps(_mm_max_ps(x, _mm_sub_ps(zero, one)), one);
+		y = _mm_min_ps(_mm_max_ps(y, _mm_sub_ps(zero, one)), one);
+		__m128i qx = _mm_cvtps_epi32(_mm_mul_ps(x, unit));
+		__m128i qy = _mm_cvtps_epi32(_mm_mul_ps(y, unit));
+
+		// interleave x/y and saturate to 16 bits
+		__m128i xy = _mm_packs_epi32(_mm_unpacklo_epi32(qx, qy), _mm_unpackhi_epi32(qx, qy));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i * 2]), xy);
+	}
+#endif
+
+	for (; i < n; ++i)
+		octahedral(src[i], &dst[i * 2]);
+}
+
+uint16_t pre::to_half(float f) noexcept
+{
+	uint32_t x;
+	std::memcpy(&x, &f, sizeof(x));
+
+	uint32_t sign = (x >> 16) & 0x8000;
+	uint32_t abs = x & 0x7fffffff;
+
+	// inf / nan (quiet)
+	if (abs >= 0x7f800000)
+		return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+	// rounds past the largest finite half
+	if (abs >= 0x477ff000)
+		return sign | 0x7c00;
+
+	// half subnormals
+	if (abs < 0x38800000)
+	{
+		if (abs < 0x33000000)
+			return sign;
+
+		uint32_t shift = 126 - (abs >> 23);
+		uint32_t m = (abs & 0x7fffff) | 0x800000;
+		uint32_t r = m >> shift;
+		uint32_t rem = m & ((1u << shift) - 1);
+		uint32_t half = 1u << (shift - 1);
+		r += rem > half || (rem == half && (r & 1));
+		return sign | r;
+	}
+
+	uint32_t r = (abs - 0x38000000) >> 13;
+	uint32_t rem = abs & 0x1fff;
+	r += rem > 0x1000 || (rem == 0x1000 && (r & 1));
+	return sign | r;
+}
+
+#if defined(__F16C__) || PRE_DISPATCH
+#if !defined(__F16C__)
+PRE_TARGET("f16c")
+#endif
+static size_t pack_half_f16c(const float* src, uint16_t* dst, size_t n) noexcept
+{
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+	}
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i h = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), h);
+	}
+	return i;
+}
+#endif
+
+void pre::pack_half(span<const float> src, span<uint16_t> dst) noexcept
+{
+	size_t n = std::min(src.size(), dst.size());
+	size_t i = 0;
+
+#if defined(__F16C__)
+	i = pack_half_f16c(src.data(), dst.data(), n);
+#elif PRE_DISPATCH
+	static const bool f16c = PRE_SUPPORTS("f16c");
+	if (f16c)
+		i = pack_half_f16c(src.data(), dst.data(), n);
+#elif PRE_NEON && defined(__aarch64__)
+	for (; i + 4 <= n; i += 4)
+		vst1_u16(&dst[i], vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(&src[i]))));
+#endif
+
+	for (; i < n; ++i)
+		dst[i] = to_half(src[i]);
+}
+
+void pre::pack_half(span<const vec2f> src, span<uint16_t> dst) noexcept
+{
+	pack_half(span<const float>(&src.data()->x, src.size() * 2), dst);
+}
@@ -0,0 +1,72 @@
+#include "pre/mat4.hxx"
+
+#if PRE_SSE
+
+static inline __m128 column(const pre::mat4f& a, const pre::vec4f& v) noexcept
+{
+	__m128 r = _mm_mul_ps(_mm_load_ps(&a.cols[0].x), _mm_set1_ps(v.x));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&a.cols[1].x), _mm_set1_ps(v.y)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&a.cols[2].x), _mm_set1_ps(v.z)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&a.cols[3].x), _mm_set1_ps(v.w)));
+	return r;
+}
+
+pre::mat4f pre::simd::mul(const mat4f& a, const mat4f& b) noexcept
+{
+	pre::mat4f r;
+	for (size_t i = 0; i < 4; ++i)
+		_mm_store_ps(&r.cols[i].x, column(a, b.cols[i]));
+	return r;
+}
+
+pre::vec4f pre::simd::mul(const mat4f& a, const vec4f& v) noexcept
+{
+	pre::vec4f r;
+	_mm_store_ps(&r.x, column(a, v));
+	return r;
+}
+
+#elif PRE_NEON
+
+static inline float32x4_t column(const pre::mat4f& a, const pre::vec4f& v) noexcept
+{
+	float32x4_t r = vmulq_n_f32(vld1q_f32(&a.cols[0].x), v.x);
+	r = vmlaq_n_f32(r, vld1q_f32(&a.cols[1].x), v.y);
+	r = vmlaq_n_f32(r, vld1q_f32(&a.cols[2].x), v.z);
+	r = vmlaq_n_f32(r, vld1q_f32(&a.cols[3].x), v.w);
+	return r;
+}
+
+pre::mat4f pre::simd::mul(const mat4f& a, const mat4f& b) noexcept
+{
+	pre::mat4f r;
+	for (size_t i = 0; i < 4; ++i)
+		vst1q_f32(&r.cols[i].x, column(a, b.cols[i]));
+	return r;
+}
+
+pre::vec4f pre::simd::mul(const mat4f& a, const vec4f& v) noexcept
+{
+	pre::vec4f r;
+	vst1q_f32(&r.x, column(a, v));
+	return r;
+}
+
+#else
+
+static inline pre::vec4f column(const pre::mat4f& a, const pre::vec4f& v) noexcept
+{
+	return a.cols[0] * v.x + a.cols[1] * v.y + a.cols[2] * v.z + a.cols[3] * v.w;
+}
+
+pre::mat4f pre::simd::mul(const mat4f& a, const mat4f& b) noexcept
+{
+	return pre::mat4f(column(a, b.cols[0]), column(a, b.cols[1]), column(a, b.cols[2]), column(a, b.cols[3]));
+}
+
+pre::vec4f pre::simd::mul(const mat4f& a, const vec4f& v) noexcept
+{
+	return column(a, v);
+}
+
+#endif
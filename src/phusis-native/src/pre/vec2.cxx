@@ -1,3 +1,18 @@
 #include "pre/vec2.hxx"
+#include "pre/vec3.hxx"
+#include "pre/vec4.hxx"
+#include "pre/mat3.hxx"
+#include "pre/mat4.hxx"
+#include "pre/quat.hxx"
 
+// compile-time checks of the constexpr paths
+static_assert(pre::vec2i(1, 2) + pre::vec2i(3, 4) == pre::vec2i(4, 6));
+static_assert(pre::cross(pre::vec3f(1, 0, 0), pre::vec3f(0, 1, 0)) == pre::vec3f(0, 0, 1));
+static_assert(pre::mat4f::translation(pre::vec3f(1, 2, 3)) * pre::vec4f(0, 0, 0, 1) == pre::vec4f(1, 2, 3, 1));
+static_assert(pre::mat4f::identity() * pre::mat4f::scale(pre::vec3f(2)) == pre::mat4f::scale(pre::vec3f(2)));
+static_assert(pre::quatf().to_mat4() == pre::mat4f::identity());
 
+static_assert(sizeof(pre::vec4f) == 16 && alignof(pre::vec4f) == 16);
+static_assert(sizeof(pre::mat4f) == 64 && alignof(pre::mat4f) == 16);
+static_assert(sizeof(pre::mat3f) == 36);
+static_assert(sizeof(pre::quatf) == 16);
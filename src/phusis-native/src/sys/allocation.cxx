@@ -0,0 +1,115 @@
+#include "sys/allocation.hxx"
+#include <new>
+#include <cstdlib>
+
+#ifdef PHUSIS_COUNT_ALLOCATIONS
+
+static std::atomic<uint64_t> _allocations{0};
+
+void* operator new(size_t size)
+{
+	_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return ::operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	_allocations.fetch_add(1, std::memory_order_relaxed);
+	return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+	return ::operator new(size, tag);
+}
+
+// over-aligned types, e.g. the 16-aligned pre vectors; aligned_alloc wants the size as a multiple of the alignment
+static void* aligned(size_t size, std::align_val_t alignment) noexcept
+{
+	_allocations.fetch_add(1, std::memory_order_relaxed);
+	auto align = static_cast<size_t>(alignment);
+	return std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* p = aligned(size, alignment))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return ::operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return aligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return aligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+	free(p);
+}
+
+uint64_t sys::allocations() noexcept
+{
+	return _allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+uint64_t sys::allocations() noexcept
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include "sys/arena.hxx"
+#include <new>
+
+static constexpr size_t MinimumBlock = 16 * 1024;
+static constexpr size_t HeaderSize = (sizeof(void*) * 2 + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+sys::arena::arena(arena&& other) noexcept
+		: _head(other._head), _used(other._used), _total(other._total), _bytes(other._bytes)
+{
+	other._head = nullptr;
+	other._used = other._total = other._bytes = 0;
+}
+
+sys::arena::~arena() noexcept
+{
+	release(_head);
+}
+
+sys::arena::block* sys::arena::acquire(size_t size) noexcept
+{
+	// through operator new, so allocation counting sees arena growth as well
+	void* p = ::operator new(HeaderSize + size, std::nothrow);
+	if (!p)
+		return nullptr;
+
+	auto* b = static_cast<block*>(p);
+	b->next = nullptr;
+	b->size = size;
+	return b;
+}
+
+void sys::arena::release(block* b) noexcept
+{
+	while (b)
+	{
+		block* next = b->next;
+		::operator delete(b);
+		b = next;
+	}
+}
+
+void* sys::arena::allocate(size_t size, size_t align) noexcept
+{
+	if (_head)
+	{
+		// payloads are only malloc-aligned, so larger alignments are taken from the address itself
+		uintptr_t payload = reinterpret_cast<uintptr_t>(_head) + HeaderSize;
+		size_t offset = ((payload + _used + align - 1) & ~(align - 1)) - payload;
+		if (offset + size <= _head->size)
+		{
+			_used = offset + size;
+			_bytes += size;
+			return reinterpret_cast<void*>(payload + offset);
+		}
+	}
+
+	size_t capacity = std::max(MinimumBlock, _head ? _head->size * 2 : 0);
+	while (capacity < size + align)
+		capacity *= 2;
+
+	block* b = acquire(capacity);
+	if (!b)
+		return nullptr;
+
+	b->next = _head;
+	_head = b;
+	_total += capacity;
+	_used = 0;
+
+	return allocate(size, align);
+}
+
+void sys::arena::reset() noexcept
+{
+	// fold overflow blocks into one so the next cycle fits without growing
+	if (_head && _head->next)
+	{
+		size_t total = _total;
+		release(_head);
+		_head = acquire(total);
+		_total = _head ? total : 0;
+	}
+
+	_used = 0;
+	_bytes = 0;
+}
+
+size_t sys::arena::used() const noexcept
+{
+	return _bytes;
+}
+
+size_t sys::arena::capacity() const noexcept
+{
+	return _total;
+}
@@ -0,0 +1,63 @@
+#include "sys/histogram.hxx"
+
+void sys::histogram::record(uint64_t value) noexcept
+{
+	_buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void sys::histogram::clear() noexcept
+{
+	for (auto& bucket: _buckets)
+		bucket.store(0, std::memory_order_relaxed);
+	_count.store(0, std::memory_order_relaxed);
+}
+
+uint64_t sys::histogram::count() const noexcept
+{
+	return _count.load(std::memory_order_relaxed);
+}
+
+uint64_t sys::histogram::quantile(double q) const noexcept
+{
+	// buckets and count are updated apart, so the walk trusts only the buckets it sums
+	uint64_t total = 0;
+	for (const auto& bucket: _buckets)
+		total += bucket.load(std::memory_order_relaxed);
+	if (!total)
+		return 0;
+
+	auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0., 1.) * total));
+	rank = std::max<uint64_t>(rank, 1);
+
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < bucket_count; ++i)
+	{
+		seen += _buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank)
+			return upper(i);
+	}
+	return UINT64_MAX;
+}
+
+uint32_t sys::histogram::index(uint64_t value) noexcept
+{
+	if (value < sub_count)
+		return value;
+
+	// the top sub_bits + 1 bits pick the bucket; the leading one picks the group
+	uint32_t msb = 63 - __builtin_clzll(value);
+	uint32_t shift = msb - sub_bits;
+	return (shift + 1) * sub_count + static_cast<uint32_t>(value >> shift) - sub_count;
+}
+
+uint64_t sys::histogram::upper(uint32_t idx) noexcept
+{
+	uint32_t group = idx / sub_count;
+	uint64_t sub = idx % sub_count;
+	if (!group)
+		return sub;
+
+	uint32_t shift = group - 1;
+	return ((sub_count + sub + 1) << shift) - 1;
+}
@@ -1,6 +1,7 @@
 #include "sys/logger.hxx"
 
 static sys::spinlock _lock;
+static std::ostream* _out = &std::cout;
 
 sys::loggerctx sys::logger::__head(loggerctrl ctrl, const char* file, int32_t line)
 {
@@ -44,6 +45,13 @@ sys::loggerctx sys::logger::__head(loggerctrl ctrl, const char* file, int32_t li
 	return ctx;
 }
 
+void sys::logger::redirect(std::ostream& out) noexcept
+{
+	_lock.lock();
+	_out = &out;
+	_lock.unlock();
+}
+
 sys::loggerctx::loggerctx() noexcept : _disposed(false), _buffer()
 {
 
@@ -53,7 +61,7 @@ void sys::loggerctx::flush() noexcept
 {
 	_buffer << "\033[0m";
 	_lock.lock();
-	std::cout << _buffer.str();
+	*_out << _buffer.str();
 	_lock.unlock();
 	_buffer.str(std::string());
 }
@@ -0,0 +1,34 @@
+#include "sys/pacer.hxx"
+
+void sys::pacer::limit(double hz) noexcept
+{
+	using namespace std::chrono;
+
+	_interval = hz > 0 ? duration_cast<steady_clock::duration>(duration<double>(1. / hz)) : steady_clock::duration::zero();
+	_next = {};
+}
+
+void sys::pacer::wait() noexcept
+{
+	using namespace std::chrono;
+
+	if (_interval == steady_clock::duration::zero())
+		return;
+
+	steady_clock::time_point now = steady_clock::now();
+
+	// first frame, or more than a frame behind: start a new cadence from now
+	if (_next == steady_clock::time_point{} || now - _next > _interval)
+	{
+		_next = now + _interval;
+		return;
+	}
+
+	constexpr steady_clock::duration slack = milliseconds(1);
+	if (_next - now > slack)
+		std::this_thread::sleep_until(_next - slack);
+	while (steady_clock::now() < _next)
+		std::this_thread::yield();
+
+	_next += _interval;
+}
@@ -0,0 +1,94 @@
+#include "sys/workers.hxx"
+#include "pre/simd.hxx"
+
+static thread_local uint32_t worker = sys::workers::npos;
+
+// tell the core this is a spin-wait; without a hint instruction, give the time slice away instead
+static inline void relax() noexcept
+{
+#if PRE_SSE
+	_mm_pause();
+#elif (defined(__aarch64__) || defined(__arm__)) && (defined(__GNUC__) || defined(__clang__))
+	__asm__ volatile("yield");
+#else
+	std::this_thread::yield();
+#endif
+}
+
+sys::workers::workers(uint32_t count)
+{
+	_spin = count < std::thread::hardware_concurrency() ? 4096 : 0;
+
+	_threads.reserve(count);
+	for (uint32_t i = 0; i < count; ++i)
+		_threads.emplace_back(&workers::loop, this, i);
+}
+
+sys::workers::~workers() noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+		_generation.fetch_add(1, std::memory_order_release);
+	}
+	_wake.notify_all();
+
+	for (auto& thread: _threads)
+		thread.join();
+}
+
+void sys::workers::loop(uint32_t index) noexcept
+{
+	worker = index;
+
+	uint64_t seen = 0;
+	while (true)
+	{
+		// frames dispatch back to back; spin briefly before parking so the next one starts warm
+		for (uint32_t spin = 0; spin < _spin && _generation.load(std::memory_order_acquire) == seen; ++spin)
+			relax();
+
+		task fn;
+		void* context;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [&] { return _generation.load(std::memory_order_relaxed) != seen; });
+			if (_stop)
+				return;
+
+			seen = _generation.load(std::memory_order_relaxed);
+			fn = _task;
+			context = _context;
+		}
+
+		fn(context, index);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (--_remaining == 0)
+			_done.notify_one();
+	}
+}
+
+void sys::workers::dispatch(task fn, void* context) noexcept
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_task = fn;
+	_context = context;
+	_remaining = _threads.size();
+	_generation.fetch_add(1, std::memory_order_release);
+	lock.unlock();
+	_wake.notify_all();
+
+	lock.lock();
+	_done.wait(lock, [&] { return _remaining == 0; });
+}
+
+uint32_t sys::workers::size() const noexcept
+{
+	return _threads.size();
+}
+
+uint32_t sys::workers::current() noexcept
+{
+	return worker;
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+# Measures what each build option buys on the headless frame benchmarks: builds phusis-bench once per
+# variant, runs the Frame benchmarks and prints every variant's median time per benchmark against the
+# baseline, which has all options off. Needs Google Benchmark and a Vulkan device; benchmarks the device
+# cannot run are left out.
+#
+#   tools/compare-builds.sh [build root] [extra phusis-bench arguments...]
+#
+# PHUSIS_COMPARE_REPETITIONS sets the repetitions per benchmark (default 5), PHUSIS_COMPARE_MARCH the -march
+# variant (default x86-64-v3). PGO trains on the very benchmarks it is then measured on, so its figure is an
+# upper bound.
+set -euo pipefail
+
+src="$(cd "$(dirname "$0")/.." && pwd)"
+root="$(realpath -m "${1:-${TMPDIR:-/tmp}/phusis-variants}")"
+shift || true
+extra=("$@")
+reps="${PHUSIS_COMPARE_REPETITIONS:-5}"
+jobs="$(nproc)"
+
+# name, cmake options on top of the baseline
+configure()
+{
+	local name="$1"
+	shift
+	cmake -S "$src" -B "$root/$name" -DCMAKE_BUILD_TYPE=Release \
+		-DPHUSIS_LTO=OFF -DPHUSIS_ARCH_DISPATCH=OFF -DPHUSIS_MARCH= -DPHUSIS_PGO= "$@" > /dev/null
+}
+
+build()
+{
+	cmake --build "$root/$1" --target "${2:-phusis-bench}" -j"$jobs" > /dev/null
+}
+
+# median of the repetitions as: benchmark time unit
+measure()
+{
+	"$root/$1/phusis-bench" --benchmark_filter=Frame --benchmark_repetitions="$reps" \
+			--benchmark_report_aggregates_only=true --benchmark_format=csv "${extra[@]}" 2> /dev/null |
+		awk -F, '$1 ~ /_median"$/ && $3 > 0 { gsub(/"/, "", $1); sub(/_median$/, "", $1); print $1, $3, $5 }' > "$root/$1.txt"
+}
+
+mkdir -p "$root"
+
+echo "building baseline" >&2
+configure baseline
+build baseline
+measure baseline
+
+variants=(dispatch lto march)
+options=("-DPHUSIS_ARCH_DISPATCH=ON" "-DPHUSIS_LTO=ON" "-DPHUSIS_MARCH=${PHUSIS_COMPARE_MARCH:-x86-64-v3}")
+for i in "${!variants[@]}"; do
+	echo "building ${variants[i]}" >&2
+	configure "${variants[i]}" "${options[i]}"
+	build "${variants[i]}"
+	measure "${variants[i]}"
+done
+
+# train, merge clang's raw profiles, then rebuild the same tree against them
+echo "building pgo" >&2
+configure pgo -DPHUSIS_PGO=generate
+build pgo phusis-pgo-train
+if compgen -G "$root/pgo/pgo/*.profraw" > /dev/null; then
+	llvm-profdata merge -o "$root/pgo/pgo/default.profdata" "$root"/pgo/pgo/*.profraw
+fi
+configure pgo -DPHUSIS_PGO=use
+build pgo
+measure pgo
+variants+=(pgo)
+
+# negative is faster than the baseline
+for name in "${variants[@]}"; do
+	echo "== $name"
+	awk 'NR == FNR { base[$1] = $2; next }
+		($1 in base) { printf "%-72s %10.3f %-3s %+7.1f%%\n", $1, $2, $3, 100 * ($2 - base[$1]) / base[$1] }' \
+		"$root/baseline.txt" "$root/$name.txt"
+done
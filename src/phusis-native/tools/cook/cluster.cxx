@@ -0,0 +1,205 @@
+#include "cluster.hxx"
+#include <cmath>
+#include <unordered_map>
+
+template<typename It>
+static void sphere(It begin, It end, const std::vector<pre::vec3f>& positions, pre::vec3f& center, float& radius) noexcept
+{
+	center = pre::vec3f(0);
+	radius = 0.f;
+	if (begin == end)
+		return;
+
+	pre::vec3f min = positions[*begin], max = min;
+	for (It it = begin; it != end; ++it)
+	{
+		const pre::vec3f& p = positions[*it];
+		min = pre::vec3f(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+		max = pre::vec3f(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+	}
+
+	center = (min + max) * .5f;
+	for (It it = begin; it != end; ++it)
+	{
+		pre::vec3f d = positions[*it] - center;
+		radius = std::max(radius, pre::dot(d, d));
+	}
+	radius = std::sqrt(radius);
+}
+
+void Phusis::Cook::BoundingSphere(const std::vector<uint32_t>& indices, const std::vector<pre::vec3f>& positions, pre::vec3f& center, float& radius) noexcept
+{
+	sphere(indices.begin(), indices.end(), positions, center, radius);
+}
+
+static Phusis::Meshlet meshlet(
+		const std::vector<uint32_t>& indices,
+		uint32_t first,
+		uint32_t count,
+		const std::vector<uint32_t>& unique,
+		const std::vector<pre::vec3f>& positions) noexcept
+{
+	Phusis::Meshlet result{};
+	result.FirstIndex = first;
+	result.IndexCount = count;
+
+	pre::vec3f center;
+	sphere(unique.begin(), unique.end(), positions, center, result.Radius);
+	result.Center[0] = center.x;
+	result.Center[1] = center.y;
+	result.Center[2] = center.z;
+
+	std::vector<pre::vec3f> normals;
+	normals.reserve(count / 3);
+	pre::vec3f axis(0);
+	for (uint32_t i = first; i < first + count; i += 3)
+	{
+		const pre::vec3f& a = positions[indices[i]];
+		pre::vec3f n = pre::cross(positions[indices[i + 1]] - a, positions[indices[i + 2]] - a);
+		if (pre::dot(n, n) == 0.f)
+			continue;
+		n = pre::normalize(n);
+		normals.push_back(n);
+		axis += n;
+	}
+
+	// cutoff 1 never culls
+	result.ConeCutoff = 1.f;
+	if (normals.empty() || pre::dot(axis, axis) == 0.f)
+		return result;
+
+	axis = pre::normalize(axis);
+	float spread = 1.f;
+	for (const auto& n: normals)
+		spread = std::min(spread, pre::dot(axis, n));
+
+	result.ConeAxis[0] = axis.x;
+	result.ConeAxis[1] = axis.y;
+	result.ConeAxis[2] = axis.z;
+	// every normal lies within acos(spread) of the axis, so any view direction within
+	// 90deg - acos(spread) of it sees only back faces: cos of that is sin(acos(spread))
+	if (spread > 0.f)
+		result.ConeCutoff = std::sqrt(1.f - spread * spread);
+	return result;
+}
+
+std::vector<Phusis::Meshlet> Phusis::Cook::BuildMeshlets(const std::vector<uint32_t>& indices, const std::vector<pre::vec3f>& positions)
+{
+	std::vector<Meshlet> result;
+
+	// vertex -> meshlet it was last added to, so membership tests are O(1) without clearing
+	constexpr uint32_t none = ~0u;
+	std::vector<uint32_t> owner(positions.size(), none);
+	std::vector<uint32_t> unique;
+	unique.reserve(MeshletMaxVertices);
+
+	uint32_t first = 0;
+	uint32_t id = 0;
+	for (uint32_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		uint32_t fresh = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+			fresh += owner[indices[i + k]] != id;
+		// a triangle repeating one vertex twice counts it twice; harmless, it only closes early
+		if (unique.size() + fresh > MeshletMaxVertices || (i - first) / 3 + 1 > MeshletMaxTriangles)
+		{
+			result.push_back(meshlet(indices, first, i - first, unique, positions));
+			unique.clear();
+			first = i;
+			id++;
+		}
+
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			uint32_t v = indices[i + k];
+			if (owner[v] != id)
+			{
+				owner[v] = id;
+				unique.push_back(v);
+			}
+		}
+	}
+
+	if (!unique.empty())
+		result.push_back(meshlet(indices, first, static_cast<uint32_t>(indices.size() / 3 * 3) - first, unique, positions));
+	return result;
+}
+
+Phusis::Cook::SimplifiedLod Phusis::Cook::Simplify(const std::vector<uint32_t>& indices, const std::vector<pre::vec3f>& positions, uint32_t resolution)
+{
+	SimplifiedLod result{ {}, 0.f };
+	if (indices.empty())
+		return result;
+
+	pre::vec3f center;
+	float radius;
+	BoundingSphere(indices, positions, center, radius);
+
+	// cubic cells over the bounding box of the sphere, so thin meshes are not stretched per axis
+	float cell = std::max(2.f * radius / static_cast<float>(std::max(resolution, 1u)), std::numeric_limits<float>::min());
+	pre::vec3f origin = center - pre::vec3f(radius);
+
+	auto key = [&](const pre::vec3f& p) {
+		auto axis = [&](float v) {
+			return static_cast<uint64_t>(std::clamp(static_cast<int64_t>(v / cell), int64_t(0), int64_t(0x1FFFFF)));
+		};
+		pre::vec3f local = p - origin;
+		return axis(local.x) | axis(local.y) << 21 | axis(local.z) << 42;
+	};
+
+	struct cell_data
+	{
+		pre::vec3f sum;
+		uint32_t count;
+		uint32_t representative;
+		float distance;
+	};
+
+	constexpr uint32_t none = ~0u;
+	std::vector<uint64_t> keys(positions.size(), 0);
+	std::vector<bool> used(positions.size(), false);
+	std::unordered_map<uint64_t, cell_data> cells;
+	for (uint32_t index: indices)
+	{
+		if (used[index])
+			continue;
+		used[index] = true;
+		keys[index] = key(positions[index]);
+		auto [it, inserted] = cells.try_emplace(keys[index], cell_data{ pre::vec3f(0), 0, none, 0.f });
+		it->second.sum += positions[index];
+		it->second.count++;
+	}
+
+	for (uint32_t v = 0; v < positions.size(); ++v)
+	{
+		if (!used[v])
+			continue;
+		cell_data& c = cells[keys[v]];
+		pre::vec3f d = positions[v] - c.sum / static_cast<float>(c.count);
+		float distance = pre::dot(d, d);
+		if (c.representative == none || distance < c.distance)
+		{
+			c.representative = v;
+			c.distance = distance;
+		}
+	}
+
+	std::vector<uint32_t> collapse(positions.size(), none);
+	for (uint32_t v = 0; v < positions.size(); ++v)
+	{
+		if (!used[v])
+			continue;
+		collapse[v] = cells[keys[v]].representative;
+		result.Error = std::max(result.Error, pre::length(positions[v] - positions[collapse[v]]));
+	}
+
+	result.Indices.reserve(indices.size());
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		uint32_t a = collapse[indices[i]], b = collapse[indices[i + 1]], c = collapse[indices[i + 2]];
+		if (a == b || b == c || a == c)
+			continue;
+		result.Indices.insert(result.Indices.end(), { a, b, c });
+	}
+	return result;
+}
@@ -0,0 +1,30 @@
+#ifndef PHUSIS_COOK_CLUSTER_HXX
+#define PHUSIS_COOK_CLUSTER_HXX
+
+#include "fw.hxx"
+#include "phusis/meshblob.hxx"
+#include "pre/vec3.hxx"
+
+namespace Phusis::Cook
+{
+	/// @brief Cuts indices, in order, into meshlets of at most MeshletMaxVertices unique vertices and
+	/// MeshletMaxTriangles triangles, with bounding sphere and normal cone
+	std::vector<Meshlet> BuildMeshlets(const std::vector<uint32_t>& indices, const std::vector<pre::vec3f>& positions);
+
+	struct SimplifiedLod
+	{
+		std::vector<uint32_t> Indices;
+		// largest distance a vertex moved, in object space
+		float Error;
+	};
+
+	/// @brief Vertex clustering on a grid of resolution cells per axis: every cell collapses onto its
+	/// vertex closest to the cell's mean, degenerate triangles are dropped. Vertices are shared with
+	/// the source so attributes stay exact.
+	SimplifiedLod Simplify(const std::vector<uint32_t>& indices, const std::vector<pre::vec3f>& positions, uint32_t resolution);
+
+	/// @brief Bounding sphere of the referenced vertices, centred on their bounds
+	void BoundingSphere(const std::vector<uint32_t>& indices, const std::vector<pre::vec3f>& positions, pre::vec3f& center, float& radius) noexcept;
+}
+
+#endif //PHUSIS_COOK_CLUSTER_HXX
@@ -0,0 +1,167 @@
+#include "fw.hxx"
+#include "cluster.hxx"
+#include "optimize.hxx"
+#include "pre/pack.hxx"
+#include "source.hxx"
+#include "sys/logger.hxx"
+#include "writer.hxx"
+#include <cmath>
+#include <cstring>
+
+struct options
+{
+	std::vector<std::filesystem::path> Inputs;
+	std::filesystem::path Output;
+	Phusis::VertexEncoding Encoding = Phusis::VertexEncoding::Compressed;
+	uint32_t Lods = 4;
+	bool Overdraw = true;
+};
+
+static bool parse(int argc, char** argv, options& opts)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--full")
+			opts.Encoding = Phusis::VertexEncoding::Full;
+		else if (arg == "--no-overdraw")
+			opts.Overdraw = false;
+		else if (arg == "--lods" && i + 1 < argc)
+			opts.Lods = std::clamp<uint32_t>(std::strtoul(argv[++i], nullptr, 10), 1, Phusis::MeshBlobMaxLods);
+		else if (arg == "-o" && i + 1 < argc)
+			opts.Output = argv[++i];
+		else if (!arg.empty() && arg[0] == '-')
+			return false;
+		else
+			opts.Inputs.emplace_back(arg);
+	}
+	return !opts.Inputs.empty() && !opts.Output.empty();
+}
+
+template<typename T>
+static Phusis::Cook::CookedStream stream(Phusis::VertexAttribute attribute, Phusis::VertexEncoding encoding, const std::vector<T>& src)
+{
+	return { attribute, Phusis::StreamFormat(attribute, encoding), static_cast<uint32_t>(src.size()), {} };
+}
+
+static void encode(Phusis::Cook::SourceMesh& src, Phusis::VertexEncoding encoding, Phusis::Cook::CookedMesh& dst)
+{
+	using Phusis::VertexAttribute;
+	size_t n = src.Positions.size();
+
+	pre::vec3f min, max;
+	pre::bounds(src.Positions, min, max);
+
+	pre::mat4f dequantization = pre::mat4f::identity();
+	auto positions = stream(VertexAttribute::Position, encoding, src.Positions);
+	auto normals = stream(VertexAttribute::Normal, encoding, src.Normals);
+	auto texcoords = stream(VertexAttribute::TexCoord, encoding, src.TexCoords);
+	positions.Bytes.resize(n * positions.Format.Stride);
+	normals.Bytes.resize(n * normals.Format.Stride);
+	texcoords.Bytes.resize(src.TexCoords.size() * texcoords.Format.Stride);
+
+	if (encoding == Phusis::VertexEncoding::Full)
+	{
+		std::memcpy(positions.Bytes.data(), src.Positions.data(), positions.Bytes.size());
+		std::memcpy(normals.Bytes.data(), src.Normals.data(), normals.Bytes.size());
+		if (!src.TexCoords.empty())
+			std::memcpy(texcoords.Bytes.data(), src.TexCoords.data(), texcoords.Bytes.size());
+	}
+	else
+	{
+		dequantization = pre::dequantization(min, max);
+		pre::pack_unorm16(src.Positions, min, max, pre::span<uint16_t>(reinterpret_cast<uint16_t*>(positions.Bytes.data()), n * 4));
+		pre::pack_octahedral(src.Normals, pre::span<int16_t>(reinterpret_cast<int16_t*>(normals.Bytes.data()), n * 2));
+		if (!src.TexCoords.empty())
+			pre::pack_half(pre::span<const pre::vec2f>(src.TexCoords), pre::span<uint16_t>(reinterpret_cast<uint16_t*>(texcoords.Bytes.data()), n * 2));
+	}
+
+	std::memcpy(dst.Dequantization, &dequantization, sizeof(dst.Dequantization));
+	dst.Streams.push_back(std::move(positions));
+	dst.Streams.push_back(std::move(normals));
+	if (!src.TexCoords.empty())
+		dst.Streams.push_back(std::move(texcoords));
+}
+
+static Phusis::Cook::CookedMesh cook(Phusis::Cook::SourceMesh& src, const options& opts)
+{
+	using namespace Phusis::Cook;
+
+	CookedMesh result{};
+	result.Name = src.Name;
+	size_t vertices = src.Positions.size();
+
+	float before = CacheMissRatio(src.Indices, vertices);
+	std::vector<uint32_t> indices = src.Indices;
+	std::vector<uint32_t> hard = OptimizeVertexCache(indices, vertices);
+	if (opts.Overdraw)
+		OptimizeOverdraw(indices, hard, src.Positions);
+	float after = CacheMissRatio(indices, vertices);
+
+	result.Lods.push_back({ std::move(indices), 0.f, {} });
+
+	// a closed surface covers about pi * r^2 cells of an r^3 grid, so this lands near the source
+	// density and every halving of the grid roughly quarters the triangles
+	float resolution = std::sqrt(static_cast<float>(vertices) / 3.14159265f) * .5f;
+	while (result.Lods.size() < opts.Lods && resolution >= 2.f)
+	{
+		const CookedLod& previous = result.Lods.back();
+		SimplifiedLod lod = Simplify(previous.Indices, src.Positions, static_cast<uint32_t>(resolution));
+		resolution *= .5f;
+		// too little gained to be worth a level, or nothing left to draw
+		if (lod.Indices.empty() || lod.Indices.size() * 10 > previous.Indices.size() * 8)
+			continue;
+
+		OptimizeVertexCache(lod.Indices, vertices);
+		result.Lods.push_back({ std::move(lod.Indices), std::max(lod.Error, previous.Error), {} });
+	}
+
+	// levels reuse level 0's vertices, so level 0's first-use order serves all of them
+	std::vector<uint32_t> remap = FetchRemap(result.Lods[0].Indices, vertices);
+	Remap(src.Positions, remap);
+	Remap(src.Normals, remap);
+	Remap(src.TexCoords, remap);
+	for (auto& lod: result.Lods)
+	{
+		RemapIndices(lod.Indices, remap);
+		lod.Meshlets = BuildMeshlets(lod.Indices, src.Positions);
+	}
+
+	pre::vec3f center;
+	BoundingSphere(result.Lods[0].Indices, src.Positions, center, result.Radius);
+	result.Center[0] = center.x;
+	result.Center[1] = center.y;
+	result.Center[2] = center.z;
+
+	encode(src, opts.Encoding, result);
+
+	// triangles / meshlets per level
+	std::stringstream levels;
+	for (const auto& lod: result.Lods)
+		levels << " " << lod.Indices.size() / 3 << "/" << lod.Meshlets.size();
+	sys::log.head(sys::INFO) << result.Name << ": " << static_cast<uint64_t>(vertices) << " vertices, acmr " << before << " -> " << after
+							 << ", levels" << levels.str() << sys::EOM;
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	options opts;
+	if (!parse(argc, argv, opts))
+	{
+		std::cerr << "usage: phusis-cook [--full] [--lods N] [--no-overdraw] -o out.phmb input.obj..." << '\n';
+		return 2;
+	}
+
+	std::vector<Phusis::Cook::CookedMesh> meshes;
+	for (const auto& input: opts.Inputs)
+	{
+		std::vector<Phusis::Cook::SourceMesh> sources;
+		if (!Phusis::Cook::LoadObj(input, sources))
+			return 1;
+		for (auto& src: sources)
+			meshes.push_back(cook(src, opts));
+	}
+
+	return Phusis::Cook::WriteBlob(opts.Output, meshes) ? 0 : 1;
+}
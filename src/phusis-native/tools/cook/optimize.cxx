@@ -0,0 +1,313 @@
+#include "optimize.hxx"
+#include <cmath>
+
+// Forsyth, "Linear-Speed Vertex Cache Optimisation"
+static constexpr uint32_t CacheSize = 32;
+static constexpr float CacheDecay = 1.5f;
+static constexpr float LastTriangleScore = .75f;
+static constexpr float ValenceScale = 2.f;
+static constexpr float ValenceDecay = .5f;
+
+static float score(int32_t position, uint32_t remaining) noexcept
+{
+	if (remaining == 0)
+		return -1.f;
+
+	float result = 0.f;
+	if (position >= 0)
+	{
+		// the last triangle's vertices score flat so its neighbours do not win by a margin
+		if (position < 3)
+			result = LastTriangleScore;
+		else
+			result = std::pow(1.f - static_cast<float>(position - 3) / (CacheSize - 3), CacheDecay);
+	}
+
+	return result + ValenceScale * std::pow(static_cast<float>(remaining), -ValenceDecay);
+}
+
+std::vector<uint32_t> Phusis::Cook::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertices)
+{
+	size_t triangles = indices.size() / 3;
+	std::vector<uint32_t> runs;
+	if (triangles == 0)
+		return runs;
+
+	// vertex -> adjacent triangles, compacted
+	std::vector<uint32_t> offsets(vertices + 1, 0);
+	for (uint32_t index: indices)
+		offsets[index + 1]++;
+	for (size_t v = 0; v < vertices; ++v)
+		offsets[v + 1] += offsets[v];
+
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> remaining(vertices, 0);
+	for (size_t i = 0; i < indices.size(); ++i)
+		adjacency[offsets[indices[i]] + remaining[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+	std::vector<int32_t> position(vertices, -1);
+	std::vector<float> vertexScore(vertices);
+	for (size_t v = 0; v < vertices; ++v)
+		vertexScore[v] = score(-1, remaining[v]);
+
+	std::vector<float> triangleScore(triangles);
+	std::vector<bool> emitted(triangles, false);
+	for (size_t t = 0; t < triangles; ++t)
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	// the extra slots hold vertices pushed out by the newest triangle until their scores drop
+	std::vector<uint32_t> cache, next;
+	cache.reserve(CacheSize + 3);
+	next.reserve(CacheSize + 3);
+
+	size_t cursor = 0;
+	int64_t best = -1;
+	while (result.size() < indices.size())
+	{
+		if (best < 0)
+		{
+			// cold start: the linear scan keeps the total cost linear
+			while (emitted[cursor])
+				cursor++;
+			best = static_cast<int64_t>(cursor);
+			for (size_t t = cursor; t < triangles; ++t)
+				if (!emitted[t] && triangleScore[t] > triangleScore[best])
+					best = static_cast<int64_t>(t);
+			runs.push_back(static_cast<uint32_t>(result.size() / 3));
+		}
+
+		const uint32_t* tri = &indices[best * 3];
+		emitted[best] = true;
+		result.insert(result.end(), tri, tri + 3);
+
+		next.clear();
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			uint32_t v = tri[k];
+			next.push_back(v);
+
+			// drop the triangle from the vertex's live adjacency
+			uint32_t* begin = &adjacency[offsets[v]];
+			uint32_t* end = begin + remaining[v];
+			*std::find(begin, end, static_cast<uint32_t>(best)) = end[-1];
+			remaining[v]--;
+		}
+		for (uint32_t v: cache)
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				next.push_back(v);
+
+		for (uint32_t v: cache)
+			position[v] = -1;
+		for (size_t i = 0; i < next.size(); ++i)
+			position[next[i]] = i < CacheSize ? static_cast<int32_t>(i) : -1;
+
+		// rescore everything that was or is in the cache and pick the best neighbour
+		best = -1;
+		float top = -1.f;
+		for (uint32_t v: next)
+		{
+			vertexScore[v] = score(position[v], remaining[v]);
+			for (uint32_t i = 0; i < remaining[v]; ++i)
+			{
+				uint32_t t = adjacency[offsets[v] + i];
+				triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if (triangleScore[t] > top)
+				{
+					top = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+
+		if (next.size() > CacheSize)
+			next.resize(CacheSize);
+		std::swap(cache, next);
+	}
+
+	indices = std::move(result);
+	return runs;
+}
+
+// FIFO cache simulation that can be reset in O(1) by moving the miss counter past the cache size
+class fifo
+{
+private:
+	std::vector<uint64_t> _loaded;
+	uint64_t _misses = 0;
+	uint32_t _size;
+
+public:
+	fifo(size_t vertices, uint32_t size) : _loaded(vertices, 0), _size(size)
+	{
+	}
+
+	uint32_t touch(const uint32_t* tri) noexcept
+	{
+		uint32_t result = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			if (_loaded[tri[k]] == 0 || _misses - _loaded[tri[k]] >= _size)
+			{
+				_loaded[tri[k]] = ++_misses;
+				result++;
+			}
+		}
+		return result;
+	}
+
+	void reset() noexcept
+	{
+		_misses += _size;
+	}
+};
+
+// Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw": a run is cut
+// wherever the cache, restarted cold, has already caught up with the run's own miss ratio
+static std::vector<uint32_t> soft(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& runs, size_t vertices, float threshold)
+{
+	constexpr uint32_t cache = 16;
+	size_t triangles = indices.size() / 3;
+
+	std::vector<uint32_t> result;
+	fifo sim(vertices, cache);
+	for (size_t r = 0; r < runs.size(); ++r)
+	{
+		uint32_t first = runs[r];
+		uint32_t last = r + 1 < runs.size() ? runs[r + 1] : static_cast<uint32_t>(triangles);
+
+		sim.reset();
+		uint32_t misses = 0;
+		for (uint32_t t = first; t < last; ++t)
+			misses += sim.touch(&indices[t * 3]);
+		float limit = threshold * static_cast<float>(misses) / static_cast<float>(last - first);
+
+		sim.reset();
+		result.push_back(first);
+		uint32_t start = first;
+		misses = 0;
+		for (uint32_t t = first; t < last; ++t)
+		{
+			misses += sim.touch(&indices[t * 3]);
+			if (t + 1 < last && static_cast<float>(misses) <= limit * static_cast<float>(t + 1 - start))
+			{
+				result.push_back(t + 1);
+				start = t + 1;
+				misses = 0;
+				sim.reset();
+			}
+		}
+	}
+	return result;
+}
+
+void Phusis::Cook::OptimizeOverdraw(
+		std::vector<uint32_t>& indices,
+		const std::vector<uint32_t>& hard,
+		const std::vector<pre::vec3f>& positions,
+		float threshold)
+{
+	size_t triangles = indices.size() / 3;
+	if (triangles == 0)
+		return;
+
+	std::vector<uint32_t> runs = soft(indices, hard, positions.size(), threshold);
+	if (runs.size() < 2)
+		return;
+
+	struct cluster
+	{
+		uint32_t first, count;
+		float sort;
+	};
+
+	auto normal = [&](size_t t) {
+		const pre::vec3f& a = positions[indices[t * 3]];
+		return pre::cross(positions[indices[t * 3 + 1]] - a, positions[indices[t * 3 + 2]] - a);
+	};
+	auto centroid = [&](size_t t) {
+		return (positions[indices[t * 3]] + positions[indices[t * 3 + 1]] + positions[indices[t * 3 + 2]]) / 3.f;
+	};
+
+	// area-weighted mesh centroid
+	pre::vec3f center(0);
+	float total = 0.f;
+	for (size_t t = 0; t < triangles; ++t)
+	{
+		float area = pre::length(normal(t));
+		center += centroid(t) * area;
+		total += area;
+	}
+	if (total > 0.f)
+		center = center / total;
+
+	std::vector<cluster> clusters(runs.size());
+	for (size_t c = 0; c < runs.size(); ++c)
+	{
+		uint32_t first = runs[c];
+		uint32_t last = c + 1 < runs.size() ? runs[c + 1] : static_cast<uint32_t>(triangles);
+
+		pre::vec3f n(0), p(0);
+		float area = 0.f;
+		for (uint32_t t = first; t < last; ++t)
+		{
+			pre::vec3f face = normal(t);
+			float a = pre::length(face);
+			n += face;
+			p += centroid(t) * a;
+			area += a;
+		}
+
+		// clusters facing away from the centre are the ones that occlude the rest
+		float sort = 0.f;
+		if (area > 0.f && pre::dot(n, n) > 0.f)
+			sort = pre::dot(p / area - center, pre::normalize(n));
+		clusters[c] = { first, last - first, sort };
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const cluster& a, const cluster& b) {
+		return a.sort > b.sort;
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (const cluster& c: clusters)
+		result.insert(result.end(), indices.begin() + c.first * 3, indices.begin() + (c.first + c.count) * 3);
+	indices = std::move(result);
+}
+
+std::vector<uint32_t> Phusis::Cook::FetchRemap(const std::vector<uint32_t>& indices, size_t vertices)
+{
+	constexpr uint32_t unused = ~0u;
+	std::vector<uint32_t> remap(vertices, unused);
+
+	uint32_t next = 0;
+	for (uint32_t index: indices)
+		if (remap[index] == unused)
+			remap[index] = next++;
+	for (auto& v: remap)
+		if (v == unused)
+			v = next++;
+	return remap;
+}
+
+void Phusis::Cook::RemapIndices(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap) noexcept
+{
+	for (auto& index: indices)
+		index = remap[index];
+}
+
+float Phusis::Cook::CacheMissRatio(const std::vector<uint32_t>& indices, size_t vertices, uint32_t cache)
+{
+	size_t triangles = indices.size() / 3;
+	if (triangles == 0)
+		return 0.f;
+
+	fifo sim(vertices, cache);
+	uint64_t misses = 0;
+	for (size_t t = 0; t < triangles; ++t)
+		misses += sim.touch(&indices[t * 3]);
+	return static_cast<float>(misses) / static_cast<float>(triangles);
+}
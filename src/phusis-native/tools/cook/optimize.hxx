@@ -0,0 +1,41 @@
+#ifndef PHUSIS_COOK_OPTIMIZE_HXX
+#define PHUSIS_COOK_OPTIMIZE_HXX
+
+#include "fw.hxx"
+#include "pre/vec3.hxx"
+
+namespace Phusis::Cook
+{
+	/// @brief Reorders triangles for the post-transform cache (Forsyth); returns the first triangle
+	/// of every run that started with a cold cache, the only places the order can be cut freely
+	std::vector<uint32_t> OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertices);
+
+	/// @brief Cuts the hard runs further where that costs at most threshold in cache misses, then sorts
+	/// the pieces so outward-facing ones come first; the order inside a piece is kept
+	void OptimizeOverdraw(
+			std::vector<uint32_t>& indices,
+			const std::vector<uint32_t>& hard,
+			const std::vector<pre::vec3f>& positions,
+			float threshold = 1.05f);
+
+	/// @brief Vertex order of first use in indices, old index -> new index; unused vertices go last
+	std::vector<uint32_t> FetchRemap(const std::vector<uint32_t>& indices, size_t vertices);
+
+	template<typename T>
+	void Remap(std::vector<T>& attributes, const std::vector<uint32_t>& remap)
+	{
+		if (attributes.empty())
+			return;
+		std::vector<T> result(attributes.size());
+		for (size_t i = 0; i < attributes.size(); ++i)
+			result[remap[i]] = attributes[i];
+		attributes = std::move(result);
+	}
+
+	void RemapIndices(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap) noexcept;
+
+	/// @brief Average transformed vertices per triangle for a FIFO cache of the given size
+	float CacheMissRatio(const std::vector<uint32_t>& indices, size_t vertices, uint32_t cache = 16);
+}
+
+#endif //PHUSIS_COOK_OPTIMIZE_HXX
@@ -0,0 +1,181 @@
+#include "source.hxx"
+#include "sys/logger.hxx"
+#include <fstream>
+#include <unordered_map>
+
+struct corner
+{
+	int32_t v, t, n;
+
+	bool operator==(const corner& other) const noexcept
+	{
+		return v == other.v && t == other.t && n == other.n;
+	}
+};
+
+struct corner_hash
+{
+	size_t operator()(const corner& c) const noexcept
+	{
+		return (static_cast<size_t>(c.v) * 73856093u) ^ (static_cast<size_t>(c.t) * 19349663u) ^ (static_cast<size_t>(c.n) * 83492791u);
+	}
+};
+
+class builder
+{
+private:
+	std::unordered_map<corner, uint32_t, corner_hash> _welded{};
+	bool _normals = true;
+
+public:
+	Phusis::Cook::SourceMesh Mesh{};
+
+	void add(const corner& c,
+			const std::vector<pre::vec3f>& v,
+			const std::vector<pre::vec2f>& t,
+			const std::vector<pre::vec3f>& n)
+	{
+		auto [it, inserted] = _welded.try_emplace(c, static_cast<uint32_t>(Mesh.Positions.size()));
+		if (inserted)
+		{
+			Mesh.Positions.push_back(v[c.v]);
+			Mesh.Normals.push_back(c.n >= 0 ? n[c.n] : pre::vec3f(0));
+			if (c.t >= 0)
+			{
+				Mesh.TexCoords.resize(Mesh.Positions.size(), pre::vec2f(0));
+				Mesh.TexCoords.back() = t[c.t];
+			}
+			_normals &= c.n >= 0;
+		}
+		Mesh.Indices.push_back(it->second);
+	}
+
+	void finish()
+	{
+		if (!Mesh.TexCoords.empty())
+			Mesh.TexCoords.resize(Mesh.Positions.size(), pre::vec2f(0));
+		if (_normals)
+			return;
+
+		// welded vertices share the sum of their faces' unnormalized normals
+		std::fill(Mesh.Normals.begin(), Mesh.Normals.end(), pre::vec3f(0));
+		for (size_t i = 0; i + 2 < Mesh.Indices.size(); i += 3)
+		{
+			uint32_t a = Mesh.Indices[i], b = Mesh.Indices[i + 1], c = Mesh.Indices[i + 2];
+			pre::vec3f face = pre::cross(Mesh.Positions[b] - Mesh.Positions[a], Mesh.Positions[c] - Mesh.Positions[a]);
+			Mesh.Normals[a] += face;
+			Mesh.Normals[b] += face;
+			Mesh.Normals[c] += face;
+		}
+		for (auto& normal: Mesh.Normals)
+			normal = pre::dot(normal, normal) > 0 ? pre::normalize(normal) : pre::vec3f(0, 0, 1);
+	}
+};
+
+// OBJ indices are 1-based, negative ones count back from the latest element
+static int32_t resolve(long index, size_t count) noexcept
+{
+	if (index > 0 && static_cast<size_t>(index) <= count)
+		return static_cast<int32_t>(index - 1);
+	if (index < 0 && static_cast<size_t>(-index) <= count)
+		return static_cast<int32_t>(count + index);
+	return -1;
+}
+
+bool Phusis::Cook::LoadObj(const std::filesystem::path& path, std::vector<SourceMesh>& meshes)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		sys::log.head(sys::FAIL) << "could not open " << path.string() << sys::EOM;
+		return false;
+	}
+
+	std::vector<pre::vec3f> positions;
+	std::vector<pre::vec3f> normals;
+	std::vector<pre::vec2f> texcoords;
+
+	builder current;
+	current.Mesh.Name = path.stem().string();
+
+	auto flush = [&](const std::string& next) {
+		if (!current.Mesh.Indices.empty())
+		{
+			current.finish();
+			meshes.push_back(std::move(current.Mesh));
+		}
+		current = builder();
+		current.Mesh.Name = next;
+	};
+
+	std::string line;
+	std::vector<corner> polygon;
+	size_t number = 0;
+	while (std::getline(file, line))
+	{
+		number++;
+		std::istringstream in(line);
+		std::string tag;
+		in >> tag;
+
+		if (tag == "v")
+		{
+			pre::vec3f p(0);
+			in >> p.x >> p.y >> p.z;
+			positions.push_back(p);
+		}
+		else if (tag == "vn")
+		{
+			pre::vec3f n(0);
+			in >> n.x >> n.y >> n.z;
+			normals.push_back(n);
+		}
+		else if (tag == "vt")
+		{
+			pre::vec2f t(0);
+			in >> t.x >> t.y;
+			texcoords.push_back(t);
+		}
+		else if (tag == "o" || tag == "g")
+		{
+			std::string name;
+			std::getline(in >> std::ws, name);
+			flush(name.empty() ? path.stem().string() : name);
+		}
+		else if (tag == "f")
+		{
+			polygon.clear();
+			std::string token;
+			while (in >> token)
+			{
+				// v, v/t, v//n or v/t/n
+				long v = 0, t = 0, n = 0;
+				size_t first = token.find('/');
+				size_t second = first == std::string::npos ? std::string::npos : token.find('/', first + 1);
+				v = std::strtol(token.c_str(), nullptr, 10);
+				if (first != std::string::npos && first + 1 != second)
+					t = std::strtol(token.c_str() + first + 1, nullptr, 10);
+				if (second != std::string::npos)
+					n = std::strtol(token.c_str() + second + 1, nullptr, 10);
+
+				corner c{ resolve(v, positions.size()), t ? resolve(t, texcoords.size()) : -1, n ? resolve(n, normals.size()) : -1 };
+				if (c.v < 0)
+				{
+					sys::log.head(sys::FAIL) << path.string() << ":" << number << ": bad vertex index" << sys::EOM;
+					return false;
+				}
+				polygon.push_back(c);
+			}
+
+			for (size_t i = 2; i < polygon.size(); ++i)
+			{
+				current.add(polygon[0], positions, texcoords, normals);
+				current.add(polygon[i - 1], positions, texcoords, normals);
+				current.add(polygon[i], positions, texcoords, normals);
+			}
+		}
+	}
+
+	flush({});
+	return true;
+}
@@ -0,0 +1,28 @@
+#ifndef PHUSIS_COOK_SOURCE_HXX
+#define PHUSIS_COOK_SOURCE_HXX
+
+#include "fw.hxx"
+#include "pre/vec2.hxx"
+#include "pre/vec3.hxx"
+
+namespace Phusis::Cook
+{
+	/// @brief Indexed triangle list with one attribute set per unique vertex
+	struct SourceMesh
+	{
+		std::string Name;
+
+		std::vector<pre::vec3f> Positions;
+		std::vector<pre::vec3f> Normals;
+		// empty when the source has none
+		std::vector<pre::vec2f> TexCoords;
+
+		std::vector<uint32_t> Indices;
+	};
+
+	/// @brief Wavefront OBJ; every o / g starts a mesh, polygons are fan-triangulated,
+	/// v/vt/vn triplets are welded, missing normals are area-weighted face normals
+	bool LoadObj(const std::filesystem::path& path, std::vector<SourceMesh>& meshes);
+}
+
+#endif //PHUSIS_COOK_SOURCE_HXX
@@ -0,0 +1,94 @@
+#include "writer.hxx"
+#include "sys/logger.hxx"
+#include <cstring>
+#include <fstream>
+
+static uint64_t align(uint64_t value, uint64_t alignment) noexcept
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static Phusis::MeshBlobRegion append(std::vector<uint8_t>& data, const void* src, size_t size)
+{
+	Phusis::MeshBlobRegion region{ align(data.size(), Phusis::MeshBlobAlignment), size };
+	data.resize(region.Offset + size, 0);
+	if (size)
+		std::memcpy(data.data() + region.Offset, src, size);
+	return region;
+}
+
+bool Phusis::Cook::WriteBlob(const std::filesystem::path& path, const std::vector<CookedMesh>& meshes)
+{
+	std::vector<MeshBlobEntry> entries(meshes.size());
+	std::vector<uint8_t> data;
+
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const CookedMesh& mesh = meshes[i];
+		MeshBlobEntry& entry = entries[i];
+		std::memset(&entry, 0, sizeof(entry));
+
+		if (mesh.Streams.size() > MeshBlobMaxStreams || mesh.Lods.size() > MeshBlobMaxLods)
+		{
+			sys::log.head(sys::FAIL) << "mesh " << mesh.Name << " has too many streams or levels" << sys::EOM;
+			return false;
+		}
+
+		std::strncpy(entry.Name, mesh.Name.c_str(), sizeof(entry.Name) - 1);
+		entry.StreamCount = static_cast<uint32_t>(mesh.Streams.size());
+		entry.LodCount = static_cast<uint32_t>(mesh.Lods.size());
+
+		for (size_t j = 0; j < mesh.Streams.size(); ++j)
+		{
+			const CookedStream& stream = mesh.Streams[j];
+			entry.Streams[j].Region = append(data, stream.Bytes.data(), stream.Bytes.size());
+			entry.Streams[j].Format = stream.Format.Format;
+			entry.Streams[j].Stride = stream.Format.Stride;
+			entry.Streams[j].Count = stream.Count;
+			entry.Streams[j].Attribute = static_cast<uint32_t>(stream.Attribute);
+		}
+
+		for (size_t j = 0; j < mesh.Lods.size(); ++j)
+		{
+			const CookedLod& lod = mesh.Lods[j];
+			entry.Lods[j].Indices = append(data, lod.Indices.data(), lod.Indices.size() * sizeof(uint32_t));
+			entry.Lods[j].Count = static_cast<uint32_t>(lod.Indices.size());
+			entry.Lods[j].Error = lod.Error;
+			entry.Lods[j].Meshlets = append(data, lod.Meshlets.data(), lod.Meshlets.size() * sizeof(Meshlet));
+			entry.Lods[j].MeshletCount = static_cast<uint32_t>(lod.Meshlets.size());
+		}
+
+		std::memcpy(entry.Dequantization, mesh.Dequantization, sizeof(entry.Dequantization));
+		std::memcpy(entry.Center, mesh.Center, sizeof(entry.Center));
+		entry.Radius = mesh.Radius;
+	}
+
+	MeshBlobHeader header{};
+	header.Magic = MeshBlobMagic;
+	header.Version = MeshBlobVersion;
+	header.MeshCount = static_cast<uint32_t>(meshes.size());
+	header.DataOffset = align(sizeof(MeshBlobHeader) + entries.size() * sizeof(MeshBlobEntry), MeshBlobPage);
+	header.DataSize = align(data.size(), MeshBlobPage);
+	data.resize(header.DataSize, 0);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		sys::log.head(sys::FAIL) << "could not create " << path.string() << sys::EOM;
+		return false;
+	}
+
+	std::vector<uint8_t> directory(header.DataOffset, 0);
+	std::memcpy(directory.data(), &header, sizeof(header));
+	if (!entries.empty())
+		std::memcpy(directory.data() + sizeof(header), entries.data(), entries.size() * sizeof(MeshBlobEntry));
+
+	file.write(reinterpret_cast<const char*>(directory.data()), static_cast<std::streamsize>(directory.size()));
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	if (!file)
+	{
+		sys::log.head(sys::FAIL) << "could not write " << path.string() << sys::EOM;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,39 @@
+#ifndef PHUSIS_COOK_WRITER_HXX
+#define PHUSIS_COOK_WRITER_HXX
+
+#include "fw.hxx"
+#include "phusis/meshblob.hxx"
+#include "phusis/vertexformat.hxx"
+
+namespace Phusis::Cook
+{
+	struct CookedStream
+	{
+		VertexAttribute Attribute;
+		VertexStreamFormat Format;
+		uint32_t Count;
+		std::vector<uint8_t> Bytes;
+	};
+
+	struct CookedLod
+	{
+		std::vector<uint32_t> Indices;
+		float Error;
+		std::vector<Meshlet> Meshlets;
+	};
+
+	struct CookedMesh
+	{
+		std::string Name;
+		std::vector<CookedStream> Streams;
+		std::vector<CookedLod> Lods;
+		float Dequantization[16];
+		float Center[3];
+		float Radius;
+	};
+
+	/// @brief Lays the meshes out as a MeshBlob and writes it in one pass
+	bool WriteBlob(const std::filesystem::path& path, const std::vector<CookedMesh>& meshes);
+}
+
+#endif //PHUSIS_COOK_WRITER_HXX
@@ -0,0 +1,146 @@
+#include "fw.hxx"
+#include "headless.hxx"
+#include "phusis/internal/framecapture.hxx"
+#include "phusis/transformhierarchy.hxx"
+#include "sys/logger.hxx"
+
+/*
+ * replays a frame capture (Application::Capture) on the benchmarks' headless device as fast as it goes;
+ * one CSV row per frame on stdout, the summary and every log line on stderr. captured_* columns are the
+ * field frame's own numbers. gpu_us belongs to the frame FramesInFlight rows earlier, as
+ * VkFrameTimings::Gpu does.
+ */
+
+using Phusis::Bench::HeadlessDevice;
+using Phusis::Internal::FrameCaptureFrame;
+using Phusis::Internal::RecordingMode;
+using Phusis::Internal::VkBoundData;
+using Phusis::Internal::VkFrameTimings;
+using Phusis::Internal::VkStateMachine;
+
+struct options
+{
+	std::filesystem::path Input;
+	uint32_t Repeat = 1;
+	uint32_t Threads = 0;
+	RecordingMode Mode = RecordingMode::Batched;
+};
+
+static bool parse(int argc, char** argv, options& opts)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--repeat" && i + 1 < argc)
+			opts.Repeat = std::max<uint32_t>(std::strtoul(argv[++i], nullptr, 10), 1);
+		else if (arg == "--threads" && i + 1 < argc)
+			opts.Threads = std::strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--per-object")
+			opts.Mode = RecordingMode::PerObject;
+		else if (!arg.empty() && arg[0] == '-')
+			return false;
+		else if (opts.Input.empty())
+			opts.Input = arg;
+		else
+			return false;
+	}
+	return !opts.Input.empty();
+}
+
+static double percentile(std::vector<double> values, double q)
+{
+	if (values.empty())
+		return 0.;
+
+	size_t rank = std::min<size_t>(static_cast<size_t>(std::ceil(q * values.size())), values.size()) - (q > 0.);
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	return values[rank];
+}
+
+int main(int argc, char** argv)
+{
+	// stdout carries nothing but the CSV
+	sys::log.redirect(std::cerr);
+
+	options opts;
+	if (!parse(argc, argv, opts))
+	{
+		std::cerr << "usage: phusis-replay [--repeat N] [--threads N] [--per-object] capture.phcp" << '\n';
+		return 2;
+	}
+
+	Phusis::Internal::FrameReplay replay;
+	if (!replay.Open(opts.Input))
+		return 1;
+	if (!replay.Count())
+	{
+		sys::log.head(sys::FAIL) << "capture " << opts.Input.string() << " holds no frames" << sys::EOM;
+		return 1;
+	}
+
+	HeadlessDevice device;
+	if (!device.Valid())
+		return 1;
+
+	// one stand-in per captured mesh; captured pipelines all fall back to the headless default
+	std::vector<Phusis::Mesh> meshes = device.CreateMeshes(std::max(replay.MeshCount(), 1u));
+	if (meshes.size() < replay.MeshCount())
+		return 1;
+
+	std::vector<Phusis::EngineObjectData> objects;
+	std::vector<Phusis::EngineObjectTransform> transforms;
+	Phusis::TransformHierarchy hierarchy;
+	VkBoundData bound{
+			HeadlessDevice::Width, HeadlessDevice::Height,
+			glm::mat4(1.f), glm::mat4(1.f),
+			objects, transforms, nullptr, replay.Hierarchical() ? &hierarchy : nullptr, nullptr };
+	auto frame = device.Frame();
+
+	uint32_t threads = opts.Threads ? opts.Threads : std::thread::hardware_concurrency();
+	std::vector<double> cpu;
+	cpu.reserve(replay.Count() * opts.Repeat);
+	bool failed = false;
+
+	{
+		VkStateMachine machine(device.Inheritance(), threads, opts.Mode);
+		machine.Bind(&bound, &frame);
+		machine.Start();
+
+		std::cout << "pass,frame,objects,deltas,draws,prepare_us,record_us,submit_us,gpu_us,"
+					 "captured_prepare_us,captured_record_us,captured_gpu_us" << '\n';
+
+		for (uint32_t pass = 0; pass < opts.Repeat && !failed; ++pass)
+		{
+			for (uint32_t i = 0; i < replay.Count(); ++i)
+			{
+				replay.Apply(i, bound, objects, meshes, {});
+				// the camera is replayed as captured, into the headless target's fixed size
+				bound.Width = HeadlessDevice::Width;
+				bound.Height = HeadlessDevice::Height;
+
+				if (!machine.Update())
+				{
+					sys::log.head(sys::CRIT) << "device lost replaying frame " << i << sys::EOM;
+					failed = true;
+					break;
+				}
+
+				const FrameCaptureFrame& captured = replay.Frame(i);
+				const VkFrameTimings& timings = machine.Timings();
+				std::cout << pass << ',' << i << ',' << captured.ObjectCount << ',' << captured.Deltas << ','
+						  << machine.Statistics().Draws << ',' << timings.Prepare << ',' << timings.Record << ','
+						  << timings.Submit << ',' << timings.Gpu << ',' << captured.Prepare << ','
+						  << captured.Record << ',' << captured.Gpu << '\n';
+
+				cpu.push_back(timings.Prepare + timings.Record + timings.Submit);
+			}
+		}
+
+		sys::log.head(sys::INFO) << cpu.size() << " frames on " << device.Name << ", prepare + record + submit: p50 "
+								 << percentile(cpu, .5) << " us, p99 " << percentile(cpu, .99) << " us, max "
+								 << percentile(cpu, 1.) << " us" << sys::EOM;
+	}
+
+	device.ReleaseMeshes();
+	return failed ? 1 : 0;
+}